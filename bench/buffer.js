@@ -0,0 +1,163 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark Buffer creation, reads, writes and string conversion
+
+var bench = require("Bench.js");
+
+var SIZE = 64;
+var buf = new Buffer(SIZE);
+for (var i = 0; i < SIZE; i++) {
+    buf.writeUInt8(i, i);
+}
+
+bench.addSync("buffer.create", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        new Buffer(SIZE);
+    }
+});
+
+bench.addSync("buffer.read_uint8", 20000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.readUInt8(i & (SIZE - 1));
+    }
+});
+
+bench.addSync("buffer.write_uint8", 20000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.writeUInt8(i & 0xff, i & (SIZE - 1));
+    }
+});
+
+bench.addSync("buffer.read_uint32be", 20000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.readUInt32BE(i & (SIZE - 4));
+    }
+});
+
+bench.addSync("buffer.write_uint32le", 20000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.writeUInt32LE(i, i & (SIZE - 4));
+    }
+});
+
+bench.addSync("buffer.read_int16le_x16", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        for (var j = 0; j < 32; j += 2) {
+            buf.readInt16LE(j);
+        }
+    }
+});
+
+bench.addSync("buffer.read_int16_array_x16", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.readInt16Array(0, 16, "LE");
+    }
+});
+
+var samples = [];
+for (var i = 0; i < 16; i++) {
+    samples.push(i * 1000 - 8000);
+}
+
+bench.addSync("buffer.write_int16_array_x16", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.writeInt16Array(samples, 0, "LE");
+    }
+});
+
+bench.addSync("buffer.read_float_array_x8", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.readFloatArray(0, 8, "LE");
+    }
+});
+
+var frame = new Buffer(256);
+for (var i = 0; i < 256; i++) {
+    frame.writeUInt8(i & 0x7f, i);
+}
+frame.writeUInt8(0xc0, 250);
+var frameCopy = new Buffer(256);
+frame.copy(frameCopy);
+
+bench.addSync("buffer.concat_4x64", 2000, function (count) {
+    var list = [buf, buf, buf, buf];
+    for (var i = 0; i < count; i++) {
+        Buffer.concat(list);
+    }
+});
+
+bench.addSync("buffer.copy_256", 5000, function (count) {
+    for (var i = 0; i < count; i++) {
+        frame.copy(frameCopy);
+    }
+});
+
+bench.addSync("buffer.fill_256", 5000, function (count) {
+    for (var i = 0; i < count; i++) {
+        frameCopy.fill(i & 0xff);
+    }
+});
+
+bench.addSync("buffer.equals_256", 5000, function (count) {
+    frame.copy(frameCopy);
+    for (var i = 0; i < count; i++) {
+        frame.equals(frameCopy);
+    }
+});
+
+bench.addSync("buffer.index_of_byte_256", 5000, function (count) {
+    for (var i = 0; i < count; i++) {
+        frame.indexOf(0xc0);
+    }
+});
+
+bench.addSync("buffer.to_string_hex", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.toString("hex");
+    }
+});
+
+var big = new Buffer(1024);
+for (var i = 0; i < 1024; i++) {
+    big.writeUInt8((i * 7) & 0x7f, i);
+}
+var bigHex = big.toString("hex");
+var bigBase64 = big.toString("base64");
+
+bench.addSync("buffer.to_string_hex_1k", 500, function (count) {
+    for (var i = 0; i < count; i++) {
+        big.toString("hex");
+    }
+});
+
+bench.addSync("buffer.to_string_base64_1k", 500, function (count) {
+    for (var i = 0; i < count; i++) {
+        big.toString("base64");
+    }
+});
+
+bench.addSync("buffer.to_string_utf8_1k", 500, function (count) {
+    for (var i = 0; i < count; i++) {
+        big.toString("utf8");
+    }
+});
+
+bench.addSync("buffer.from_hex_1k", 500, function (count) {
+    for (var i = 0; i < count; i++) {
+        new Buffer(bigHex, "hex");
+    }
+});
+
+bench.addSync("buffer.from_base64_1k", 500, function (count) {
+    for (var i = 0; i < count; i++) {
+        new Buffer(bigBase64, "base64");
+    }
+});
+
+bench.addSync("buffer.write_string", 5000, function (count) {
+    for (var i = 0; i < count; i++) {
+        buf.write("The quick brown fox", i & 31);
+    }
+});
+
+bench.run();
@@ -0,0 +1,48 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark zjs_signal_callback throughput, with one signal in flight and with
+// many signals queued in the callback ring buffer at once
+
+var bench = require("Bench.js");
+var EventEmitter = require("events");
+
+function chains(width) {
+    return function (count, done) {
+        var delivered = 0;
+
+        // alternate between two emitters so that no event is emitted again
+        // while it is still being dispatched
+        function chain() {
+            var ping = new EventEmitter();
+            var pong = new EventEmitter();
+            ping.on("signal", function () {
+                if (++delivered == count) {
+                    done();
+                } else if (delivered < count - width + 1) {
+                    pong.emit("signal");
+                }
+            });
+            pong.on("signal", function () {
+                if (++delivered == count) {
+                    done();
+                } else if (delivered < count - width + 1) {
+                    ping.emit("signal");
+                }
+            });
+            return ping;
+        }
+
+        var starts = [];
+        for (var i = 0; i < width; i++) {
+            starts[i] = chain();
+        }
+        for (var i = 0; i < width; i++) {
+            starts[i].emit("signal");
+        }
+    };
+}
+
+bench.add("callbacks.signal", 4000, chains(1));
+bench.add("callbacks.signal_x16", 4000, chains(16));
+
+bench.run();
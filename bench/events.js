@@ -0,0 +1,57 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark EventEmitter emit() with a varying number of listeners
+
+var bench = require("Bench.js");
+var EventEmitter = require("events");
+
+function noop() {}
+
+function emitter(listeners) {
+    return function (count, done) {
+        var ping = new EventEmitter();
+        var pong = new EventEmitter();
+        var emitted = 0;
+
+        ping.setMaxListeners(listeners);
+        pong.setMaxListeners(listeners);
+        for (var i = 1; i < listeners; i++) {
+            ping.on("data", noop);
+            pong.on("data", noop);
+        }
+
+        // alternate between two emitters so that no event is emitted again
+        // while it is still being dispatched
+        ping.on("data", function (value) {
+            if (++emitted == count) {
+                done();
+            } else {
+                pong.emit("data", emitted);
+            }
+        });
+        pong.on("data", function (value) {
+            if (++emitted == count) {
+                done();
+            } else {
+                ping.emit("data", emitted);
+            }
+        });
+
+        ping.emit("data", 0);
+    };
+}
+
+bench.add("events.emit_1", 2000, emitter(1));
+bench.add("events.emit_4", 2000, emitter(4));
+bench.add("events.emit_10", 2000, emitter(10));
+
+// add and remove a listener without ever emitting
+bench.addSync("events.listener_churn", 2000, function (count) {
+    var churn = new EventEmitter();
+    for (var i = 0; i < count; i++) {
+        churn.on("data", noop);
+        churn.removeListener("data", noop);
+    }
+});
+
+bench.run();
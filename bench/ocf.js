@@ -0,0 +1,75 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark OCF property encode/decode with a client and server in the same
+// process, each retrieve encodes the properties on the server side and decodes
+// them again on the client side; requires a network interface with multicast
+
+var bench = require("Bench.js");
+var ocf = require("ocf");
+var server = ocf.server;
+var client = ocf.client;
+
+var properties = {
+    state: true,
+    power: 10,
+    level: 0.5,
+    name: "benchmark"
+};
+
+function run(resource) {
+    bench.add("ocf.retrieve", 200, function (count, done) {
+        var retrieved = 0;
+        function next() {
+            client.retrieve(resource.deviceId, { observable: false })
+                .then(function () {
+                    if (++retrieved == count) {
+                        done();
+                    } else {
+                        next();
+                    }
+                });
+        }
+        next();
+    });
+
+    bench.add("ocf.update", 200, function (count, done) {
+        var updated = 0;
+        function next() {
+            resource.properties.power = updated;
+            client.update(resource).then(function () {
+                if (++updated == count) {
+                    done();
+                } else {
+                    next();
+                }
+            });
+        }
+        next();
+    });
+
+    bench.run();
+}
+
+server.register({
+    resourcePath: "/a/bench",
+    resourceTypes: ["core.bench"],
+    interfaces: ["/oic/if/rw"],
+    discoverable: true,
+    observable: false,
+    properties: properties
+}).then(function (resource) {
+    server.on("retrieve", function (request, observe) {
+        request.respond(properties);
+    });
+    server.on("update", function (request) {
+        request.respond(properties);
+    });
+
+    var found = false;
+    client.findResources({ resourceType: "core.bench" }, function (resource) {
+        if (!found) {
+            found = true;
+            run(resource);
+        }
+    });
+});
@@ -0,0 +1,43 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark promise creation and resolution through the native promise API
+
+var bench = require("Bench.js");
+var test = require("test_promise");
+
+function resolver(fulfill) {
+    return function (count, done) {
+        var WIDTH = 8;
+        var settled = 0;
+        var started = 0;
+
+        function start() {
+            started++;
+            var p = test.create_promise();
+            p.then(onsettled).catch(onsettled);
+            if (fulfill) {
+                test.fulfill(p);
+            } else {
+                test.reject(p);
+            }
+        }
+
+        function onsettled() {
+            settled++;
+            if (settled == count) {
+                done();
+            } else if (started < count) {
+                start();
+            }
+        }
+
+        for (var i = 0; i < WIDTH; i++) {
+            start();
+        }
+    };
+}
+
+bench.add("promise.fulfill", 2000, resolver(true));
+bench.add("promise.reject", 2000, resolver(false));
+
+bench.run();
@@ -0,0 +1,52 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// UART receive benchmark for jslinux, driven by scripts/uartbench, which
+// writes newline-delimited frames into the pty behind the uart module and
+// then a "#" frame to end the run. Prints "uart <name> <value>" lines with
+// what was received.
+
+var performance = require("performance");
+var board = require("uart");
+
+board.init({ port: "tty0" }).then(function (uart) {
+    var frames = 0;
+    var bytes = 0;
+    var errors = 0;
+    var lost = 0;
+    var first = 0;
+    var last = 0;
+
+    uart.setFramer({ type: "delimiter", delimiter: "\n", maxLength: 1024 });
+
+    uart.on("frame", function (frame) {
+        if (frame.length == 1 && frame.readUInt8(0) == 0x23) {
+            var ms = last - first;
+            console.log("uart frames " + frames);
+            console.log("uart bytes " + bytes);
+            console.log("uart errors " + errors);
+            console.log("uart overrun " + lost);
+            console.log("uart ms " + (ms | 0));
+            console.log("bench done");
+            return;
+        }
+        last = performance.now();
+        if (!frames) {
+            first = last;
+        }
+        frames++;
+        // count the delimiter too, to compare with the bytes written
+        bytes += frame.length + 1;
+    });
+
+    uart.on("frameerror", function (reason) {
+        errors++;
+    });
+
+    uart.on("overrun", function (count, total) {
+        lost = total;
+    });
+
+    console.log("uart ready");
+}).catch(function (error) {
+    console.log("uart init failed: " + error.message);
+});
@@ -0,0 +1,51 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Benchmark setTimeout/setInterval churn
+
+var bench = require("Bench.js");
+
+function noop() {}
+
+// batches of zero-delay timeouts, each batch scheduled when the last one fires
+bench.add("timers.timeout", 2000, function (count, done) {
+    var BATCH = 50;
+    var fired = 0;
+
+    function schedule() {
+        for (var i = 0; i < BATCH; i++) {
+            setTimeout(ontimeout, 0);
+        }
+    }
+
+    function ontimeout() {
+        fired++;
+        if (fired == count) {
+            done();
+        } else if (fired % BATCH == 0) {
+            schedule();
+        }
+    }
+
+    schedule();
+});
+
+// a single zero-delay interval, which fires once per pass of the main loop
+bench.add("timers.interval", 1000, function (count, done) {
+    var fired = 0;
+    var timer = setInterval(function () {
+        fired++;
+        if (fired == count) {
+            clearInterval(timer);
+            done();
+        }
+    }, 0);
+});
+
+// create and clear intervals without ever letting them fire
+bench.addSync("timers.churn", 2000, function (count) {
+    for (var i = 0; i < count; i++) {
+        clearInterval(setInterval(noop, 1000));
+    }
+});
+
+bench.run();
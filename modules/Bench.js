@@ -0,0 +1,57 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// JavaScript library for the benchmarks in bench/, results are printed as
+// "bench <name> <ops per second>" lines that scripts/runbench collects
+
+function Bench() {
+    var performance = require("performance");
+    var queue = [];
+    var next = 0;
+
+    // API object
+    var bench = {};
+
+    bench.report = function (name, ops, ms) {
+        // avoid Math, which may be disabled in the JerryScript profile
+        var rate = (ms > 0) ? (ops * 1000 / ms) | 0 : 0;
+        console.log("bench " + name + " " + rate);
+    }
+
+    // queue a benchmark; func is called with the iteration count and a done
+    // function, which must be called once all the iterations have completed
+    bench.add = function (name, iterations, func) {
+        queue[queue.length] = {
+            name: name,
+            iterations: iterations,
+            func: func
+        };
+    }
+
+    // queue a benchmark that completes synchronously
+    bench.addSync = function (name, iterations, func) {
+        bench.add(name, iterations, function (count, done) {
+            func(count);
+            done();
+        });
+    }
+
+    // run the queued benchmarks one after another
+    bench.run = function () {
+        if (next >= queue.length) {
+            console.log("bench done");
+            return;
+        }
+
+        var item = queue[next++];
+        var start = performance.now();
+        item.func(item.iterations, function () {
+            bench.report(item.name, item.iterations, performance.now() - start);
+            // start the next benchmark from a fresh pass of the main loop
+            setTimeout(bench.run, 0);
+        });
+    }
+
+    return bench;
+};
+
+module.exports.Bench = new Bench();
@@ -117,6 +117,12 @@ if check_for_require events || check_config_file ZJS_EVENTS; then
     echo "export ZJS_EVENTS=y" >> zjs.conf.tmp
 fi
 
+if check_for_require watchdog; then
+    >&2 echo Using module: Watchdog
+    MODULES+=" -DBUILD_MODULE_EVENTS"
+    echo "export ZJS_EVENTS=y" >> zjs.conf.tmp
+fi
+
 if check_for_require ocf || check_config_file ZJS_OCF; then
     >&2 echo Using module: OCF
     MODULES+=" -DBUILD_MODULE_OCF"
@@ -288,6 +294,13 @@ if check_for_require arduino101_pins || check_config_file ZJS_ARDUINO101_PINS; t
     echo "export ZJS_ARDUINO101_PINS=y" >> zjs.conf.tmp
 fi
 
+if check_for_require test_buffer; then
+    >&2 echo Using module: Test Buffer
+    MODULES+=" -DBUILD_MODULE_TEST_BUFFER -DBUILD_MODULE_BUFFER"
+    echo "export ZJS_TEST_BUFFER=y" >> zjs.conf.tmp
+    echo "export ZJS_BUFFER=y" >> zjs.conf.tmp
+fi
+
 interval=$(grep "setInterval\|setTimeout\|setImmediate" $SCRIPT)
 if [ $? -eq 0 ] || check_config_file ZJS_TIMERS; then
     MODULES+=" -DBUILD_MODULE_TIMER"
@@ -20,6 +20,9 @@
 #include "shell-state.h"
 
 #include "ihex-handler.h"
+#ifdef BUILD_MODULE_BUFFER
+#include "../zjs_buffer.h"
+#endif
 
 static const char comms_default_prompt[] = ANSI_FG_YELLOW "acm> " ANSI_FG_RESTORE;
 static const char *comms_prompt = NULL;
@@ -531,6 +534,9 @@ void ashell_print_status()
     printk("Shell Status\n");
 
     malloc_stats();
+#ifdef BUILD_MODULE_BUFFER
+    zjs_buffer_print_stats();
+#endif
 
     if (shell_line != NULL) {
         printk("Line [%s]\n", shell_line);
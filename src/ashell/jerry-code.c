@@ -125,6 +125,7 @@ void restore_zjs_api() {
 #endif
 #endif
     jerry_init(JERRY_INIT_EMPTY);
+    zjs_init_prop_names();
     zjs_timers_init();
 #ifdef BUILD_MODULE_CONSOLE
     zjs_console_init();
@@ -152,6 +153,7 @@ void javascript_stop()
     zjs_modules_cleanup();
     zjs_remove_all_callbacks();
     zjs_ipm_free_callbacks();
+    zjs_cleanup_prop_names();
     jerry_cleanup();
 
     restore_zjs_api();
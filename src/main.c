@@ -16,6 +16,10 @@
 
 // Platform agnostic modules/headers
 #include "zjs_callbacks.h"
+#include "zjs_console.h"
+#ifdef ZJS_LINUX_BUILD
+#include "zjs_binlog.h"
+#endif
 #include "zjs_error.h"
 #include "zjs_modules.h"
 #ifdef BUILD_MODULE_SENSOR
@@ -33,6 +37,18 @@
 #endif
 #ifdef ZJS_LINUX_BUILD
 #include "zjs_unit_tests.h"
+#ifdef BUILD_MODULE_UART
+#include "zjs_linux_uart.h"
+#endif
+#endif
+#ifdef ZJS_PROFILE_NATIVE
+#include "zjs_profile.h"
+#endif
+#ifdef ZJS_RECORD
+#include "zjs_record.h"
+#endif
+#ifdef ZJS_WATCHDOG
+#include "zjs_watchdog.h"
 #endif
 #ifdef CONFIG_BOARD_ARDUINO_101
 #include "zjs_ipm.h"
@@ -84,20 +100,105 @@ static jerry_value_t stop_js_handler(const jerry_value_t function_obj,
     zjs_ipm_free_callbacks();
     #endif
     zjs_modules_cleanup();
+    zjs_cleanup_prop_names();
     jerry_cleanup();
     return ZJS_UNDEFINED;
 }
 
+#ifdef ZJS_PROFILE_NATIVE
+// native printProfile handler
+static jerry_value_t native_print_profile_handler(const jerry_value_t function_obj,
+                                                  const jerry_value_t this,
+                                                  const jerry_value_t argv[],
+                                                  const jerry_length_t argc)
+{
+    // args: [top count[, reset]]
+    uint32_t top = 0;
+    if (argc >= 1) {
+        if (!jerry_value_is_number(argv[0]))
+            return zjs_error("printProfile: invalid count argument");
+        top = (uint32_t)jerry_get_number_value(argv[0]);
+    }
+
+    zjs_profile_report(top);
+    if (argc >= 2 && jerry_value_is_boolean(argv[1]) &&
+        jerry_get_boolean_value(argv[1])) {
+        zjs_profile_reset();
+    }
+    return ZJS_UNDEFINED;
+}
+#endif
+
+#ifdef ZJS_RECORD
+// native dumpRecording handler
+static jerry_value_t native_dump_recording_handler(const jerry_value_t function_obj,
+                                                   const jerry_value_t this,
+                                                   const jerry_value_t argv[],
+                                                   const jerry_length_t argc)
+{
+    zjs_record_dump();
+    return ZJS_UNDEFINED;
+}
+#endif
+
 #ifdef ZJS_LINUX_BUILD
 // enabled if --noexit is passed to jslinux
 static uint8_t no_exit = 0;
 // if > 0, jslinux will exit after this many milliseconds
 static uint32_t exit_after = 0;
 static struct timespec exit_timer;
+// microseconds to sleep after each pass of the main loop, set with --sleep
+static uint32_t loop_sleep = 1;
+// if set with --sleep-idle, only sleep after a pass that serviced nothing
+static uint8_t sleep_idle = 0;
+#ifdef ZJS_PROFILE_NATIVE
+// number of native functions reported on exit, set with --profile-top
+static uint32_t profile_top = 10;
+#endif
+#ifdef ZJS_WATCHDOG
+// if > 0, report when one callback blocks the loop this many milliseconds
+static uint32_t watchdog_hang = 0;
+#endif
+#ifdef ZJS_RECORD
+// files given with --record and --replay
+static char *record_file = NULL;
+static char *replay_file = NULL;
+// multiplier for the replay pace, 0 for no delays, set with --replay-speed
+static uint32_t replay_speed = 1;
+#endif
+
+// heap size JerryScript was built with, passed in by Makefile.linux
+#ifndef ZJS_JERRY_HEAP_KB
+#define ZJS_JERRY_HEAP_KB       16
+#endif
+
+#define MIN_CALLBACK_BUF_SIZE   16
+#define MAX_CALLBACK_BUF_SIZE   (1024 * 1024)
+
+static bool get_uint_arg(int argc, char *argv[], int i, uint32_t *num)
+{
+    // requires: argv[i] is an option that takes a numeric value
+    //  effects: parses argv[i + 1] as an unsigned decimal number into *num;
+    //             returns false if it is missing or malformed
+    if (i == argc - 1) {
+        ERR_PRINT("no value given after '%s'\n", argv[i]);
+        return false;
+    }
+    char *end;
+    *num = strtoul(argv[i + 1], &end, 10);
+    if (*argv[i + 1] == '\0' || *end != '\0') {
+        ERR_PRINT("invalid value '%s' given after '%s'\n", argv[i + 1],
+                  argv[i]);
+        return false;
+    }
+    return true;
+}
 
 uint8_t process_cmd_line(int argc, char *argv[])
 {
     int i;
+    uint32_t cb_buf_size = 0;
+    uint32_t cb_iterations = 0;
     for (i = 0; i < argc; ++i) {
         if (!strncmp(argv[i], "--unittest", 10)) {
             // run unit tests
@@ -106,6 +207,135 @@ uint8_t process_cmd_line(int argc, char *argv[])
         else if (!strncmp(argv[i], "--noexit", 8)) {
             no_exit = 1;
         }
+        else if (!strcmp(argv[i], "--heap")) {
+            // the JerryScript heap is a static array sized at build time, so
+            //   just make sure the binary matches what the caller expects
+            uint32_t heap;
+            if (!get_uint_arg(argc, argv, i++, &heap)) {
+                return 0;
+            }
+            if (heap != ZJS_JERRY_HEAP_KB) {
+                ERR_PRINT("jslinux was built with a %uKB heap, rebuild with "
+                          "HEAP=%u\n", ZJS_JERRY_HEAP_KB, heap);
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "--cb-buf")) {
+            if (!get_uint_arg(argc, argv, i++, &cb_buf_size)) {
+                return 0;
+            }
+            if (cb_buf_size < MIN_CALLBACK_BUF_SIZE ||
+                cb_buf_size > MAX_CALLBACK_BUF_SIZE ||
+                (cb_buf_size & (cb_buf_size - 1))) {
+                ERR_PRINT("callback buffer size must be a power of 2 from "
+                          "%u to %u\n", MIN_CALLBACK_BUF_SIZE,
+                          MAX_CALLBACK_BUF_SIZE);
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "--cb-iter")) {
+            if (!get_uint_arg(argc, argv, i++, &cb_iterations)) {
+                return 0;
+            }
+            if (cb_iterations == 0 || cb_iterations > UINT16_MAX) {
+                ERR_PRINT("callback iterations must be from 1 to %u\n",
+                          UINT16_MAX);
+                return 0;
+            }
+        }
+        else if (!strcmp(argv[i], "--sleep-idle")) {
+            sleep_idle = 1;
+        }
+        else if (!strcmp(argv[i], "--sleep")) {
+            if (!get_uint_arg(argc, argv, i++, &loop_sleep)) {
+                return 0;
+            }
+        }
+#ifdef ZJS_PROFILE_NATIVE
+        else if (!strcmp(argv[i], "--profile-top")) {
+            if (!get_uint_arg(argc, argv, i++, &profile_top)) {
+                return 0;
+            }
+        }
+#endif
+#ifdef ZJS_WATCHDOG
+        else if (!strcmp(argv[i], "--stall-budget")) {
+            uint32_t budget;
+            if (!get_uint_arg(argc, argv, i++, &budget)) {
+                return 0;
+            }
+            zjs_watchdog_set_budget(budget);
+        }
+        else if (!strcmp(argv[i], "--watchdog-hang")) {
+            if (!get_uint_arg(argc, argv, i++, &watchdog_hang)) {
+                return 0;
+            }
+        }
+#endif
+        else if (!strcmp(argv[i], "--decode-log")) {
+            // decode output captured from a CONSOLE_BINARY=on build and exit
+            if (i == argc - 1) {
+                ERR_PRINT("no file given after '--decode-log'\n");
+                return 0;
+            }
+            const char *path = argv[++i];
+            FILE *in = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+            if (!in) {
+                ERR_PRINT("could not open %s\n", path);
+                return 0;
+            }
+            uint32_t errors = zjs_binlog_decode(in, stdout);
+            if (errors) {
+                fprintf(stderr, "%u records could not be decoded\n", errors);
+            }
+            exit(errors ? 1 : 0);
+        }
+#ifdef BUILD_MODULE_UART
+        else if (!strcmp(argv[i], "--uart-pty")) {
+            // link the pty backing the uart module here for a test harness
+            if (i == argc - 1) {
+                ERR_PRINT("no path given after '--uart-pty'\n");
+                return 0;
+            }
+            zjs_linux_uart_set_link(argv[++i]);
+        }
+#endif
+#if defined(BUILD_MODULE_CONSOLE) && defined(ZJS_CONSOLE_BUFFER)
+        else if (!strcmp(argv[i], "--console-overflow")) {
+            const char *policy = i < argc - 1 ? argv[++i] : "";
+            if (!strcmp(policy, "drop")) {
+                zjs_console_set_overflow(ZJS_CONSOLE_DROP);
+            } else if (!strcmp(policy, "count")) {
+                zjs_console_set_overflow(ZJS_CONSOLE_COUNT);
+            } else if (!strcmp(policy, "block")) {
+                zjs_console_set_overflow(ZJS_CONSOLE_BLOCK);
+            } else {
+                ERR_PRINT("'--console-overflow' takes drop, count or block\n");
+                return 0;
+            }
+        }
+#endif
+#ifdef ZJS_RECORD
+        else if (!strcmp(argv[i], "--record")) {
+            if (i == argc - 1) {
+                ERR_PRINT("no file given after '--record'\n");
+                return 0;
+            }
+            record_file = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--replay")) {
+            if (i == argc - 1) {
+                ERR_PRINT("no file given after '--replay'\n");
+                return 0;
+            }
+            replay_file = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--replay-speed")) {
+            if (!get_uint_arg(argc, argv, i++, &replay_speed)) {
+                return 0;
+            }
+        }
+#endif
         else if (!strncmp(argv[i], "-t", 2)) {
             if (i == argc - 1) {
                 // no time argument, return error
@@ -120,6 +350,7 @@ uint8_t process_cmd_line(int argc, char *argv[])
             }
         }
     }
+    zjs_set_callback_limits(cb_buf_size, (uint16_t)cb_iterations);
     return 1;
 }
 #endif
@@ -146,9 +377,23 @@ int main(int argc, char *argv[])
 #ifdef DUMP_MEM_STATS
     zjs_print_pools();
 #endif
+#endif
+
+#ifdef ZJS_LINUX_BUILD
+    // options that size the runtime must be applied before it starts up
+    if (argc > 1 && process_cmd_line(argc - 1, argv + 1) == 0) {
+        ERR_PRINT("command line options error\n");
+        goto error;
+    }
+#ifdef ZJS_WATCHDOG
+    if (watchdog_hang && zjs_watchdog_start_monitor(watchdog_hang)) {
+        goto error;
+    }
+#endif
 #endif
 
     jerry_init(JERRY_INIT_EMPTY);
+    zjs_init_prop_names();
 
     zjs_init_callbacks();
 
@@ -175,10 +420,6 @@ int main(int argc, char *argv[])
 #ifndef ZJS_SNAPSHOT_BUILD
 #ifdef ZJS_LINUX_BUILD
     if (argc > 1) {
-        if (process_cmd_line(argc - 1, argv + 1) == 0) {
-            ERR_PRINT("command line options error\n");
-            goto error;
-        }
         if (zjs_read_script(argv[1], &script, &len)) {
             ERR_PRINT("could not read script file %s\n", argv[1]);
             return -1;
@@ -201,6 +442,14 @@ int main(int argc, char *argv[])
     zjs_obj_add_function(global_obj, native_eval_handler, "eval");
     zjs_obj_add_function(global_obj, native_print_handler, "print");
     zjs_obj_add_function(global_obj, stop_js_handler, "stopJS");
+#ifdef ZJS_PROFILE_NATIVE
+    zjs_obj_add_function(global_obj, native_print_profile_handler,
+                         "printProfile");
+#endif
+#ifdef ZJS_RECORD
+    zjs_obj_add_function(global_obj, native_dump_recording_handler,
+                         "dumpRecording");
+#endif
 #ifndef ZJS_SNAPSHOT_BUILD
     code_eval = jerry_parse((jerry_char_t *)script, len, false);
     if (jerry_value_has_error_flag(code_eval)) {
@@ -225,6 +474,7 @@ int main(int argc, char *argv[])
 #endif
 
     if (jerry_value_has_error_flag(result)) {
+        zjs_console_flush();
         ERR_PRINT("Error running javascript\n");
         zjs_print_error_message(result);
         goto error;
@@ -242,6 +492,16 @@ int main(int argc, char *argv[])
     uint8_t last_serviced = 1;
 #endif
 
+#ifdef ZJS_RECORD
+    // inputs start once the script has registered its callbacks
+    zjs_record_start();
+#ifdef ZJS_LINUX_BUILD
+    if (replay_file && zjs_record_replay(replay_file, replay_speed)) {
+        goto error;
+    }
+#endif
+#endif
+
     while (1) {
         uint8_t serviced = 0;
 
@@ -254,9 +514,16 @@ int main(int argc, char *argv[])
         if (zjs_service_routines()) {
             serviced = 1;
         }
+#ifdef ZJS_LINUX_BUILD
+        // --sleep 0 busy waits, --sleep-idle skips the sleep while busy
+        if (loop_sleep && !(sleep_idle && serviced)) {
+            zjs_sleep(loop_sleep);
+        }
+#else
         // not sure if this is okay, but it seems better to sleep than
         //   busy wait
         zjs_sleep(1);
+#endif
 #ifdef ZJS_LINUX_BUILD
         if (!no_exit) {
             // if the last and current loop had no pending "events" (timers or
@@ -284,7 +551,19 @@ int main(int argc, char *argv[])
     }
 
 error:
+    zjs_console_flush();
 #ifdef ZJS_LINUX_BUILD
+#ifdef ZJS_PROFILE_NATIVE
+    zjs_profile_report(profile_top);
+#endif
+#ifdef ZJS_WATCHDOG
+    zjs_watchdog_dump();
+#endif
+#ifdef ZJS_RECORD
+    if (record_file) {
+        zjs_record_save(record_file);
+    }
+#endif
     return 1;
 #else
     return;
@@ -0,0 +1,259 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifdef ZJS_LINUX_BUILD
+
+#include <string.h>
+
+// ZJS includes
+#include "zjs_binlog.h"
+#include "zjs_util.h"
+
+// longest record kept; a LOG record of short values is far smaller
+#define MAX_RECORD_SIZE     4096
+
+typedef struct decoder {
+    const uint8_t *ptr;
+    const uint8_t *end;
+    FILE *out;
+    char *atoms[ZJS_BINLOG_ATOMS];
+} decoder_t;
+
+static bool read_varint(decoder_t *dec, uint64_t *num)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (dec->ptr == dec->end) {
+            return false;
+        }
+        uint8_t byte = *dec->ptr++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *num = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_bytes(decoder_t *dec, void *dst, uint64_t len)
+{
+    if (len > dec->end - dec->ptr) {
+        return false;
+    }
+    memcpy(dst, dec->ptr, len);
+    dec->ptr += len;
+    return true;
+}
+
+static void print_string(decoder_t *dec, const char *str, uint64_t len,
+                         bool quotes)
+{
+    fprintf(dec->out, quotes ? "\"%.*s\"" : "%.*s", (int)len, str);
+}
+
+static bool decode_value(decoder_t *dec, bool quotes, bool nested)
+{
+    // effects: decodes one value and prints it as print_value in zjs_console.c
+    //            would have; strings are quoted if quotes is true; returns
+    //            false if the record is malformed
+    if (dec->ptr == dec->end) {
+        return false;
+    }
+    uint8_t tag = *dec->ptr++;
+    uint64_t num, len;
+    switch (tag) {
+    case ZJS_BINLOG_UNDEFINED:
+        fprintf(dec->out, "undefined");
+        return true;
+    case ZJS_BINLOG_NULL:
+        fprintf(dec->out, "null");
+        return true;
+    case ZJS_BINLOG_FALSE:
+        fprintf(dec->out, "false");
+        return true;
+    case ZJS_BINLOG_TRUE:
+        fprintf(dec->out, "true");
+        return true;
+    case ZJS_BINLOG_FUNCTION:
+        fprintf(dec->out, "[Function]");
+        return true;
+    case ZJS_BINLOG_OBJECT:
+        fprintf(dec->out, "[Object]");
+        return true;
+    case ZJS_BINLOG_INT:
+        if (!read_varint(dec, &num)) {
+            return false;
+        }
+        // undo the zigzag encoding
+        fprintf(dec->out, "%lld", (long long)((num >> 1) ^ -(num & 1)));
+        return true;
+    case ZJS_BINLOG_FLOAT: {
+        float f;
+        if (!read_bytes(dec, &f, sizeof(f))) {
+            return false;
+        }
+        fprintf(dec->out, "%f", f);
+        return true;
+    }
+    case ZJS_BINLOG_DOUBLE: {
+        double d;
+        if (!read_bytes(dec, &d, sizeof(d))) {
+            return false;
+        }
+        fprintf(dec->out, "%f", d);
+        return true;
+    }
+    case ZJS_BINLOG_STRING:
+        if (!read_varint(dec, &len) || len > dec->end - dec->ptr) {
+            return false;
+        }
+        print_string(dec, (const char *)dec->ptr, len, quotes);
+        dec->ptr += len;
+        return true;
+    case ZJS_BINLOG_STRING_LONG:
+        if (!read_varint(dec, &len)) {
+            return false;
+        }
+        fprintf(dec->out, "[String - length %llu]", (unsigned long long)len);
+        return true;
+    case ZJS_BINLOG_ATOM_DEF:
+        if (!read_varint(dec, &num) || num >= ZJS_BINLOG_ATOMS ||
+            !read_varint(dec, &len) || len > ZJS_BINLOG_ATOM_SIZE ||
+            len > dec->end - dec->ptr) {
+            return false;
+        }
+        zjs_free(dec->atoms[num]);
+        dec->atoms[num] = zjs_malloc(len + 1);
+        if (!dec->atoms[num]) {
+            return false;
+        }
+        memcpy(dec->atoms[num], dec->ptr, len);
+        dec->atoms[num][len] = '\0';
+        print_string(dec, dec->atoms[num], len, quotes);
+        dec->ptr += len;
+        return true;
+    case ZJS_BINLOG_ATOM:
+        if (!read_varint(dec, &num) || num >= ZJS_BINLOG_ATOMS ||
+            !dec->atoms[num]) {
+            return false;
+        }
+        print_string(dec, dec->atoms[num], strlen(dec->atoms[num]), quotes);
+        return true;
+    case ZJS_BINLOG_ARRAY:
+        if (nested || !read_varint(dec, &len)) {
+            return false;
+        }
+        fprintf(dec->out, "[");
+        for (uint64_t i = 0; i < len; i++) {
+            if (i) {
+                fprintf(dec->out, ", ");
+            }
+            if (!decode_value(dec, true, true)) {
+                return false;
+            }
+        }
+        fprintf(dec->out, "]");
+        return true;
+    case ZJS_BINLOG_ARRAY_LONG:
+        if (!read_varint(dec, &len)) {
+            return false;
+        }
+        fprintf(dec->out, "[Array - length %llu]", (unsigned long long)len);
+        return true;
+    }
+    return false;
+}
+
+static bool decode_record(decoder_t *dec)
+{
+    if (dec->ptr == dec->end) {
+        return false;
+    }
+    uint8_t type = *dec->ptr++;
+    if (type == ZJS_BINLOG_RESET) {
+        if (dec->ptr == dec->end || *dec->ptr != ZJS_BINLOG_VERSION) {
+            return false;
+        }
+        for (int i = 0; i < ZJS_BINLOG_ATOMS; i++) {
+            zjs_free(dec->atoms[i]);
+            dec->atoms[i] = NULL;
+        }
+        return true;
+    }
+    if (type == ZJS_BINLOG_LOG) {
+        for (int i = 0; dec->ptr < dec->end; i++) {
+            if (i) {
+                fprintf(dec->out, " ");
+            }
+            if (!decode_value(dec, false, false)) {
+                fprintf(dec->out, "\n");
+                return false;
+            }
+        }
+        fprintf(dec->out, "\n");
+        return true;
+    }
+    return false;
+}
+
+uint32_t zjs_binlog_decode(FILE *in, FILE *out)
+{
+    static uint8_t record[MAX_RECORD_SIZE];
+    decoder_t dec;
+    memset(&dec, 0, sizeof(dec));
+    dec.out = out;
+
+    uint32_t errors = 0;
+    uint32_t len = 0;
+    bool in_record = false;
+    bool escaped = false;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        if (c == ZJS_BINLOG_START) {
+            // a START inside a record means its END was lost
+            errors += in_record;
+            in_record = true;
+            escaped = false;
+            len = 0;
+        } else if (!in_record) {
+            // text around the records, or a stray END
+            if (c != ZJS_BINLOG_END) {
+                fputc(c, out);
+            }
+        } else if (c == ZJS_BINLOG_END) {
+            in_record = false;
+            dec.ptr = record;
+            dec.end = record + len;
+            if (len > MAX_RECORD_SIZE || escaped || !decode_record(&dec)) {
+                fprintf(out, "[binlog: bad record]\n");
+                errors++;
+            }
+        } else if (c == ZJS_BINLOG_ESC) {
+            escaped = true;
+        } else if (c == '\n' || c == '\r') {
+            // added by the console; the device escapes its own
+            continue;
+        } else {
+            if (escaped) {
+                c ^= ZJS_BINLOG_ESC_XOR;
+                escaped = false;
+            }
+            // keep counting past the end so the record is reported as bad
+            if (len < MAX_RECORD_SIZE) {
+                record[len] = c;
+            }
+            len++;
+        }
+    }
+    if (in_record) {
+        errors++;
+    }
+
+    for (int i = 0; i < ZJS_BINLOG_ATOMS; i++) {
+        zjs_free(dec.atoms[i]);
+    }
+    fflush(out);
+    return errors;
+}
+
+#endif  // ZJS_LINUX_BUILD
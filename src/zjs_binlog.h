@@ -0,0 +1,97 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_binlog_h__
+#define __zjs_binlog_h__
+
+// Binary console log, written by console.log when built with
+//   CONSOLE_BINARY=on. The device sends argument values instead of text and
+//   jslinux --decode-log turns them back into the lines console.log would
+//   have printed.
+//
+// Records are framed so they can share the serial console with plain text:
+//   START, record bytes, END. START and END are bytes that never occur in
+//   UTF-8 text; inside a record they, ESC, NUL, LF and CR are sent as ESC
+//   followed by the byte XOR ZJS_BINLOG_ESC_XOR. Escaping LF and CR keeps
+//   records intact through consoles that add a CR to each LF, as the Zephyr
+//   UART console does; the decoder skips raw CR and LF inside a record.
+//
+// Record types:
+//   RESET:  uint8 version; forget all atoms
+//   LOG:    a value for each console.log argument
+//
+// Values start with a one byte tag. Integers are LEB128 varints, signed ones
+//   zigzag encoded first, and floats are little-endian IEEE:
+//   UNDEFINED, NULL, FALSE, TRUE, FUNCTION, OBJECT:  no payload
+//   INT:          signed varint
+//   FLOAT:        float32, for numbers it represents exactly
+//   DOUBLE:       float64
+//   STRING:       varint length, bytes
+//   STRING_LONG:  varint length of a string too long to print
+//   ATOM_DEF:     varint id, varint length, bytes; also defines atom id
+//   ATOM:         varint id of a string defined earlier
+//   ARRAY:        varint length, that many values (printed quoted)
+//   ARRAY_LONG:   varint length of a nested array, printed as a summary
+//
+// Short strings are sent once as atoms and then by id, so a repeated label
+//   costs two bytes. Atoms are only defined in LOG records, and the device
+//   sends RESET after it loses track of what the host has seen, e.g. when a
+//   record was dropped.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ZJS_BINLOG_VERSION      1
+
+#define ZJS_BINLOG_START        0xc0
+#define ZJS_BINLOG_END          0xc1
+#define ZJS_BINLOG_ESC          0xf5
+#define ZJS_BINLOG_ESC_XOR      0x20
+
+// bytes sent escaped inside a record
+#define ZJS_BINLOG_ESCAPED(byte)                                        \
+    ((byte) == 0 || (byte) == '\n' || (byte) == '\r' ||                 \
+     (byte) == ZJS_BINLOG_START || (byte) == ZJS_BINLOG_END ||          \
+     (byte) == ZJS_BINLOG_ESC)
+
+// record types
+#define ZJS_BINLOG_RESET        0x01
+#define ZJS_BINLOG_LOG          0x02
+
+// value tags
+#define ZJS_BINLOG_UNDEFINED    0x01
+#define ZJS_BINLOG_NULL         0x02
+#define ZJS_BINLOG_FALSE        0x03
+#define ZJS_BINLOG_TRUE         0x04
+#define ZJS_BINLOG_FUNCTION     0x05
+#define ZJS_BINLOG_OBJECT       0x06
+#define ZJS_BINLOG_INT          0x07
+#define ZJS_BINLOG_FLOAT        0x08
+#define ZJS_BINLOG_DOUBLE       0x09
+#define ZJS_BINLOG_STRING       0x0a
+#define ZJS_BINLOG_STRING_LONG  0x0b
+#define ZJS_BINLOG_ATOM_DEF     0x0c
+#define ZJS_BINLOG_ATOM         0x0d
+#define ZJS_BINLOG_ARRAY        0x0e
+#define ZJS_BINLOG_ARRAY_LONG   0x0f
+
+// atoms the device may define, and the longest string it makes an atom
+#ifndef ZJS_BINLOG_ATOMS
+#define ZJS_BINLOG_ATOMS        32
+#endif
+#ifndef ZJS_BINLOG_ATOM_SIZE
+#define ZJS_BINLOG_ATOM_SIZE    16
+#endif
+
+#ifdef ZJS_LINUX_BUILD
+/**
+ * Decode a captured console stream, passing plain text through and printing
+ *   each LOG record as the line console.log would have printed.
+ *
+ * @param in   Captured output
+ * @param out  Where to write the text
+ * @return Number of records that could not be decoded
+ */
+uint32_t zjs_binlog_decode(FILE *in, FILE *out);
+#endif
+
+#endif  // __zjs_binlog_h__
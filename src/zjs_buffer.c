@@ -10,38 +10,137 @@
 // ZJS includes
 #include "zjs_util.h"
 #include "zjs_buffer.h"
+#include "zjs_codec.h"
 
 static jerry_value_t zjs_buffer_prototype;
 
 
-// TODO: Call sites could be replaced with get_object_native_handle directly
 zjs_buffer_t *zjs_buffer_find(const jerry_value_t obj)
 {
-    // requires: obj should be the JS object associated with a buffer, created
-    //             in zjs_buffer
-    //  effects: looks up obj in our list of known buffer objects and returns
-    //             the associated list item struct, or NULL if not found
-    uintptr_t handle;
-    if (jerry_get_object_native_handle(obj, &handle)) {
-        return (zjs_buffer_t *)handle;
+    return (zjs_buffer_t *)zjs_unwrap(obj, ZJS_CLASS_BUFFER);
+}
+
+// element types for typed access, the low bits are the size in bytes
+#define TYPE_SIZE(type)     ((type) & 0x0f)
+#define TYPE_SIGNED         0x10
+#define TYPE_FLOAT          0x20
+
+#define TYPE_UINT8          1
+#define TYPE_INT8           (1 | TYPE_SIGNED)
+#define TYPE_UINT16         2
+#define TYPE_INT16          (2 | TYPE_SIGNED)
+#define TYPE_UINT32         4
+#define TYPE_INT32          (4 | TYPE_SIGNED)
+#define TYPE_FLOAT32        (4 | TYPE_FLOAT)
+#define TYPE_FLOAT64        (8 | TYPE_FLOAT)
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define HOST_BIG_ENDIAN     true
+#else
+#define HOST_BIG_ENDIAN     false
+#endif
+
+static double zjs_buffer_get_value(const uint8_t *src, uint8_t type,
+                                   bool big_endian)
+{
+    // requires: src has TYPE_SIZE(type) bytes to read, at any alignment
+    //  effects: loads one element with a single word load, swapping the bytes
+    //             if big_endian doesn't match the host, and returns its value
+    bool swap = big_endian != HOST_BIG_ENDIAN;
+    switch (TYPE_SIZE(type)) {
+    case 1:
+        return (type & TYPE_SIGNED) ? (int8_t)*src : *src;
+    case 2: {
+        uint16_t word;
+        memcpy(&word, src, 2);
+        if (swap)
+            word = __builtin_bswap16(word);
+        return (type & TYPE_SIGNED) ? (int16_t)word : word;
+    }
+    case 4: {
+        uint32_t word;
+        memcpy(&word, src, 4);
+        if (swap)
+            word = __builtin_bswap32(word);
+        if (type & TYPE_FLOAT) {
+            float f;
+            memcpy(&f, &word, 4);
+            return f;
+        }
+        return (type & TYPE_SIGNED) ? (int32_t)word : word;
+    }
+    default: {
+        uint64_t word;
+        memcpy(&word, src, 8);
+        if (swap)
+            word = __builtin_bswap64(word);
+        double d;
+        memcpy(&d, &word, 8);
+        return d;
+    }
+    }
+}
+
+static void zjs_buffer_put_value(uint8_t *dst, uint8_t type, bool big_endian,
+                                 double value)
+{
+    // requires: dst has room for TYPE_SIZE(type) bytes, at any alignment
+    //  effects: stores value as one element with a single word store; integers
+    //             are truncated and wrapped to the element size, and NaN or
+    //             infinity stored as an integer becomes 0
+    bool swap = big_endian != HOST_BIG_ENDIAN;
+    uint32_t bits = 0;
+    if (!(type & TYPE_FLOAT) && value > -9.2e18 && value < 9.2e18) {
+        bits = (uint32_t)(int64_t)value;
+    }
+
+    switch (TYPE_SIZE(type)) {
+    case 1:
+        *dst = (uint8_t)bits;
+        break;
+    case 2: {
+        uint16_t word = (uint16_t)bits;
+        if (swap)
+            word = __builtin_bswap16(word);
+        memcpy(dst, &word, 2);
+        break;
+    }
+    case 4: {
+        uint32_t word = bits;
+        if (type & TYPE_FLOAT) {
+            float f = (float)value;
+            memcpy(&word, &f, 4);
+        }
+        if (swap)
+            word = __builtin_bswap32(word);
+        memcpy(dst, &word, 4);
+        break;
+    }
+    default: {
+        uint64_t word;
+        memcpy(&word, &value, 8);
+        if (swap)
+            word = __builtin_bswap64(word);
+        memcpy(dst, &word, 8);
+        break;
+    }
     }
-    return NULL;
 }
 
 static jerry_value_t zjs_buffer_read_bytes(const jerry_value_t this,
                                            const jerry_value_t argv[],
                                            const jerry_length_t argc,
-                                           int bytes, bool big_endian)
+                                           uint8_t type, bool big_endian)
 {
     // requires: this is a JS buffer object created with zjs_buffer_create,
     //             argv[0] should be an offset into the buffer, but will treat
     //             offset as 0 if not given, as node.js seems to
-    //           bytes is the number of bytes to read (expects 1, 2, or 4)
+    //           type is the TYPE_* element to read
     //           big_endian true reads the bytes in big endian order, false in
     //             little endian order
-    //  effects: reads bytes from the buffer associated with this JS object, if
-    //             found, at the given offset, if within the bounds of the
-    //             buffer; otherwise returns an error
+    //  effects: reads an element from the buffer associated with this JS
+    //             object, if found, at the given offset, if within the bounds
+    //             of the buffer; otherwise returns an error
 
     // args: offset
     ZJS_VALIDATE_ARGS(Z_OPTIONAL Z_NUMBER);
@@ -54,43 +153,34 @@ static jerry_value_t zjs_buffer_read_bytes(const jerry_value_t this,
     if (!buf)
         return zjs_error("zjs_buffer_read_bytes: buffer not found on read");
 
-    if (offset + bytes > buf->bufsize)
+    uint32_t bytes = TYPE_SIZE(type);
+    if (offset > buf->bufsize || bytes > buf->bufsize - offset)
         return zjs_error("zjs_buffer_read_bytes: read attempted beyond buffer");
 
-    int dir = big_endian ? 1 : -1;
-    if (!big_endian)
-        offset += bytes - 1;  // start on the big end
-
-    uint32_t value = 0;
-    for (int i = 0; i < bytes; i++) {
-        value <<= 8;
-        value |= buf->buffer[offset];
-        offset += dir;
-    }
-
-    return jerry_create_number(value);
+    return jerry_create_number(zjs_buffer_get_value(buf->buffer + offset, type,
+                                                    big_endian));
 }
 
 static jerry_value_t zjs_buffer_write_bytes(const jerry_value_t this,
                                             const jerry_value_t argv[],
                                             const jerry_length_t argc,
-                                            int bytes, bool big_endian)
+                                            uint8_t type, bool big_endian)
 {
     // requires: this is a JS buffer object created with zjs_buffer_create,
     //             argv[0] must be the value to be written, argv[1] should be
     //             an offset into the buffer, but will treat offset as 0 if not
     //             given, as node.js seems to
-    //           bytes is the number of bytes to write (expects 1, 2, or 4)
+    //           type is the TYPE_* element to write
     //           big_endian true writes the bytes in big endian order, false in
     //             little endian order
-    //  effects: writes bytes into the buffer associated with this JS object, if
-    //             found, at the given offset, if within the bounds of the
-    //             buffer; otherwise returns an error
+    //  effects: writes an element into the buffer associated with this JS
+    //             object, if found, at the given offset, if within the bounds
+    //             of the buffer; otherwise returns an error
 
     // args: value[, offset]
     ZJS_VALIDATE_ARGS(Z_NUMBER, Z_OPTIONAL Z_NUMBER);
 
-    uint32_t value = (uint32_t)(int32_t)jerry_get_number_value(argv[0]);
+    double value = jerry_get_number_value(argv[0]);
 
     uint32_t offset = 0;
     if (argc > 1)
@@ -100,108 +190,536 @@ static jerry_value_t zjs_buffer_write_bytes(const jerry_value_t this,
     if (!buf)
         return zjs_error("zjs_buffer_write_bytes: buffer not found on write");
 
-    if (offset + bytes > buf->bufsize)
+    if (zjs_buffer_is_readonly(buf))
+        return zjs_error("zjs_buffer_write_bytes: buffer is read-only");
+
+    uint32_t bytes = TYPE_SIZE(type);
+    if (offset > buf->bufsize || bytes > buf->bufsize - offset)
         return zjs_error("zjs_buffer_write_bytes: write attempted beyond buffer");
 
-    int dir = big_endian ? -1 : 1;
-    if (big_endian)
-        offset += bytes - 1;  // start on the little end
+    zjs_buffer_put_value(buf->buffer + offset, type, big_endian, value);
+    return ZJS_UNDEFINED;
+}
 
-    for (int i = 0; i < bytes; i++) {
-        buf->buffer[offset] = value & 0xff;
-        value >>= 8;
-        offset += dir;
+static bool zjs_buffer_get_endian(const jerry_value_t argv[],
+                                  const jerry_length_t argc, int index,
+                                  bool *big_endian)
+{
+    // requires: argv[index], if present, is a string
+    //  effects: sets big_endian from 'BE' or 'LE' in argv[index], or to false
+    //             if not given; returns false for any other string
+    *big_endian = false;
+    if (argc <= index)
+        return true;
+
+    const int ENDIAN_LEN = 3;
+    jerry_size_t size = ENDIAN_LEN;
+    char endian[ENDIAN_LEN];
+    zjs_copy_jstring(argv[index], endian, &size);
+    if (!strcmp(endian, "BE")) {
+        *big_endian = true;
+        return true;
     }
-
-    return ZJS_UNDEFINED;
+    return !strcmp(endian, "LE");
 }
 
-static jerry_value_t zjs_buffer_read_uint8(const jerry_value_t function_obj,
-                                           const jerry_value_t this,
+static jerry_value_t zjs_buffer_read_array(const jerry_value_t this,
                                            const jerry_value_t argv[],
-                                           const jerry_length_t argc)
+                                           const jerry_length_t argc,
+                                           uint8_t type)
 {
-    return zjs_buffer_read_bytes(this, argv, argc, 1, true);
+    // requires: this is a JS buffer object, argv[0] is the offset to start
+    //             reading, argv[1] the number of elements, argv[2] optionally
+    //             'BE' or 'LE' for the byte order, little endian by default
+    //           type is the TYPE_* element to read
+    //  effects: returns an array of count elements read from the buffer,
+    //             or an error if they don't all lie within it
+
+    // args: offset, count[, endian]
+    ZJS_VALIDATE_ARGS(Z_NUMBER, Z_NUMBER, Z_OPTIONAL Z_STRING);
+
+    uint32_t offset = (uint32_t)jerry_get_number_value(argv[0]);
+    uint32_t count = (uint32_t)jerry_get_number_value(argv[1]);
+    bool big_endian;
+    if (!zjs_buffer_get_endian(argv, argc, 2, &big_endian))
+        return zjs_error("zjs_buffer_read_array: endian must be 'BE' or 'LE'");
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_read_array: buffer not found on read");
+
+    uint32_t bytes = TYPE_SIZE(type);
+    if (offset > buf->bufsize || count > (buf->bufsize - offset) / bytes)
+        return zjs_error("zjs_buffer_read_array: read attempted beyond buffer");
+
+    jerry_value_t array = jerry_create_array(count);
+    const uint8_t *src = buf->buffer + offset;
+    for (uint32_t i = 0; i < count; i++, src += bytes) {
+        jerry_value_t num =
+            jerry_create_number(zjs_buffer_get_value(src, type, big_endian));
+        jerry_set_property_by_index(array, i, num);
+        jerry_release_value(num);
+    }
+    return array;
 }
 
-static jerry_value_t zjs_buffer_read_uint16_be(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static jerry_value_t zjs_buffer_write_array(const jerry_value_t this,
+                                            const jerry_value_t argv[],
+                                            const jerry_length_t argc,
+                                            uint8_t type)
 {
-    return zjs_buffer_read_bytes(this, argv, argc, 2, true);
+    // requires: this is a JS buffer object, argv[0] is an array of numbers,
+    //             argv[1] optionally the offset to start writing, 0 by
+    //             default, argv[2] optionally 'BE' or 'LE' for the byte order,
+    //             little endian by default
+    //           type is the TYPE_* element to write
+    //  effects: writes each array element into the buffer and returns the
+    //             offset just past the last one, or an error if they don't
+    //             all fit; non-numbers are written as 0
+
+    // args: values[, offset[, endian]]
+    ZJS_VALIDATE_ARGS(Z_ARRAY, Z_OPTIONAL Z_NUMBER, Z_OPTIONAL Z_STRING);
+
+    uint32_t offset = 0;
+    if (argc > 1)
+        offset = (uint32_t)jerry_get_number_value(argv[1]);
+    bool big_endian;
+    if (!zjs_buffer_get_endian(argv, argc, 2, &big_endian))
+        return zjs_error("zjs_buffer_write_array: endian must be 'BE' or 'LE'");
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_write_array: buffer not found on write");
+
+    if (zjs_buffer_is_readonly(buf))
+        return zjs_error("zjs_buffer_write_array: buffer is read-only");
+
+    uint32_t bytes = TYPE_SIZE(type);
+    uint32_t count = jerry_get_array_length(argv[0]);
+    if (offset > buf->bufsize || count > (buf->bufsize - offset) / bytes)
+        return zjs_error("zjs_buffer_write_array: write attempted beyond buffer");
+
+    uint8_t *dst = buf->buffer + offset;
+    for (uint32_t i = 0; i < count; i++, dst += bytes) {
+        jerry_value_t num = jerry_get_property_by_index(argv[0], i);
+        double value = 0;
+        if (jerry_value_is_number(num))
+            value = jerry_get_number_value(num);
+        jerry_release_value(num);
+        zjs_buffer_put_value(dst, type, big_endian, value);
+    }
+    return jerry_create_number(offset + count * bytes);
 }
 
-static jerry_value_t zjs_buffer_read_uint16_le(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+#define BUFFER_READER(name, type, big_endian) \
+static jerry_value_t name(const jerry_value_t function_obj, \
+                          const jerry_value_t this, \
+                          const jerry_value_t argv[], \
+                          const jerry_length_t argc) \
+{ \
+    return zjs_buffer_read_bytes(this, argv, argc, type, big_endian); \
+}
+
+#define BUFFER_WRITER(name, type, big_endian) \
+static jerry_value_t name(const jerry_value_t function_obj, \
+                          const jerry_value_t this, \
+                          const jerry_value_t argv[], \
+                          const jerry_length_t argc) \
+{ \
+    return zjs_buffer_write_bytes(this, argv, argc, type, big_endian); \
+}
+
+#define BUFFER_ARRAY_ACCESSORS(suffix, type) \
+static jerry_value_t zjs_buffer_read_array_##suffix( \
+    const jerry_value_t function_obj, const jerry_value_t this, \
+    const jerry_value_t argv[], const jerry_length_t argc) \
+{ \
+    return zjs_buffer_read_array(this, argv, argc, type); \
+} \
+static jerry_value_t zjs_buffer_write_array_##suffix( \
+    const jerry_value_t function_obj, const jerry_value_t this, \
+    const jerry_value_t argv[], const jerry_length_t argc) \
+{ \
+    return zjs_buffer_write_array(this, argv, argc, type); \
+}
+
+BUFFER_READER(zjs_buffer_read_uint8, TYPE_UINT8, true)
+BUFFER_READER(zjs_buffer_read_int8, TYPE_INT8, true)
+BUFFER_READER(zjs_buffer_read_uint16_be, TYPE_UINT16, true)
+BUFFER_READER(zjs_buffer_read_uint16_le, TYPE_UINT16, false)
+BUFFER_READER(zjs_buffer_read_int16_be, TYPE_INT16, true)
+BUFFER_READER(zjs_buffer_read_int16_le, TYPE_INT16, false)
+BUFFER_READER(zjs_buffer_read_uint32_be, TYPE_UINT32, true)
+BUFFER_READER(zjs_buffer_read_uint32_le, TYPE_UINT32, false)
+BUFFER_READER(zjs_buffer_read_int32_be, TYPE_INT32, true)
+BUFFER_READER(zjs_buffer_read_int32_le, TYPE_INT32, false)
+BUFFER_READER(zjs_buffer_read_float_be, TYPE_FLOAT32, true)
+BUFFER_READER(zjs_buffer_read_float_le, TYPE_FLOAT32, false)
+BUFFER_READER(zjs_buffer_read_double_be, TYPE_FLOAT64, true)
+BUFFER_READER(zjs_buffer_read_double_le, TYPE_FLOAT64, false)
+
+BUFFER_WRITER(zjs_buffer_write_uint8, TYPE_UINT8, true)
+BUFFER_WRITER(zjs_buffer_write_int8, TYPE_INT8, true)
+BUFFER_WRITER(zjs_buffer_write_uint16_be, TYPE_UINT16, true)
+BUFFER_WRITER(zjs_buffer_write_uint16_le, TYPE_UINT16, false)
+BUFFER_WRITER(zjs_buffer_write_int16_be, TYPE_INT16, true)
+BUFFER_WRITER(zjs_buffer_write_int16_le, TYPE_INT16, false)
+BUFFER_WRITER(zjs_buffer_write_uint32_be, TYPE_UINT32, true)
+BUFFER_WRITER(zjs_buffer_write_uint32_le, TYPE_UINT32, false)
+BUFFER_WRITER(zjs_buffer_write_int32_be, TYPE_INT32, true)
+BUFFER_WRITER(zjs_buffer_write_int32_le, TYPE_INT32, false)
+BUFFER_WRITER(zjs_buffer_write_float_be, TYPE_FLOAT32, true)
+BUFFER_WRITER(zjs_buffer_write_float_le, TYPE_FLOAT32, false)
+BUFFER_WRITER(zjs_buffer_write_double_be, TYPE_FLOAT64, true)
+BUFFER_WRITER(zjs_buffer_write_double_le, TYPE_FLOAT64, false)
+
+BUFFER_ARRAY_ACCESSORS(uint8, TYPE_UINT8)
+BUFFER_ARRAY_ACCESSORS(int8, TYPE_INT8)
+BUFFER_ARRAY_ACCESSORS(uint16, TYPE_UINT16)
+BUFFER_ARRAY_ACCESSORS(int16, TYPE_INT16)
+BUFFER_ARRAY_ACCESSORS(uint32, TYPE_UINT32)
+BUFFER_ARRAY_ACCESSORS(int32, TYPE_INT32)
+BUFFER_ARRAY_ACCESSORS(float, TYPE_FLOAT32)
+BUFFER_ARRAY_ACCESSORS(double, TYPE_FLOAT64)
+
+// bytes to fill with or search for, given as a byte value, string or Buffer
+typedef struct buffer_pattern {
+    const uint8_t *data;
+    uint32_t len;
+    uint8_t byte;
+    char *str;                      // allocated copy of a string, or NULL
+} buffer_pattern_t;
+
+static bool zjs_buffer_get_pattern(jerry_value_t value, buffer_pattern_t *pat)
 {
-    return zjs_buffer_read_bytes(this, argv, argc, 2, false);
+    // requires: value is a number, string or object
+    //  effects: points pat at the bytes value represents; returns false if an
+    //             object is not a Buffer or a string can't be copied; call
+    //             zjs_buffer_free_pattern when done
+    pat->str = NULL;
+    if (jerry_value_is_number(value)) {
+        pat->byte = (uint8_t)(int32_t)jerry_get_number_value(value);
+        pat->data = &pat->byte;
+        pat->len = 1;
+        return true;
+    }
+    if (jerry_value_is_string(value)) {
+        jerry_size_t size = 0;
+        pat->str = zjs_alloc_from_jstring(value, &size);
+        pat->data = (uint8_t *)pat->str;
+        pat->len = size;
+        return pat->str != NULL;
+    }
+    zjs_buffer_t *buf = zjs_buffer_find(value);
+    if (!buf)
+        return false;
+    pat->data = buf->buffer;
+    pat->len = buf->bufsize;
+    return true;
 }
 
-static jerry_value_t zjs_buffer_read_uint32_be(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static void zjs_buffer_free_pattern(buffer_pattern_t *pat)
 {
-    return zjs_buffer_read_bytes(this, argv, argc, 4, true);
+    zjs_free(pat->str);
 }
 
-static jerry_value_t zjs_buffer_read_uint32_le(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static uint32_t zjs_buffer_get_offset(const jerry_value_t argv[],
+                                      const jerry_length_t argc, int index,
+                                      uint32_t def, uint32_t max)
 {
-    return zjs_buffer_read_bytes(this, argv, argc, 4, false);
+    // requires: argv[index], if present, is a number
+    //  effects: returns argv[index] clamped to 0..max, or def if not given
+    if (argc <= index)
+        return def;
+    double pos = jerry_get_number_value(argv[index]);
+    if (!(pos > 0))
+        return 0;
+    return pos > max ? max : (uint32_t)pos;
 }
 
-static jerry_value_t zjs_buffer_write_uint8(const jerry_value_t function_obj,
-                                           const jerry_value_t this,
-                                           const jerry_value_t argv[],
-                                           const jerry_length_t argc)
+static jerry_value_t zjs_buffer_concat(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
 {
-    return zjs_buffer_write_bytes(this, argv, argc, 1, true);
+    // requires: argv[0] is an array of Buffers, argv[1] optionally the length
+    //             of the result
+    //  effects: returns a new Buffer with the contents of each Buffer in turn,
+    //             truncated to or zero-filled up to the given length
+
+    // args: list[, totalLength]
+    ZJS_VALIDATE_ARGS(Z_ARRAY, Z_OPTIONAL Z_NUMBER);
+
+    uint32_t count = jerry_get_array_length(argv[0]);
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        jerry_value_t item = jerry_get_property_by_index(argv[0], i);
+        zjs_buffer_t *buf = zjs_buffer_find(item);
+        jerry_release_value(item);
+        if (!buf)
+            return zjs_error("zjs_buffer_concat: list must contain Buffers");
+        total += buf->bufsize;
+    }
+    if (argc > 1) {
+        double len = jerry_get_number_value(argv[1]);
+        if (!(len >= 0))
+            return zjs_error("zjs_buffer_concat: invalid length");
+        total = (uint32_t)len;
+    }
+
+    jerry_value_t new_buf = zjs_buffer_create(total);
+    zjs_buffer_t *dst = zjs_buffer_find(new_buf);
+    if (!dst) {
+        jerry_release_value(new_buf);
+        return zjs_error("zjs_buffer_concat: out of memory");
+    }
+
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < count && pos < total; i++) {
+        jerry_value_t item = jerry_get_property_by_index(argv[0], i);
+        zjs_buffer_t *buf = zjs_buffer_find(item);
+        uint32_t len = buf->bufsize;
+        if (len > total - pos)
+            len = total - pos;
+        memcpy(dst->buffer + pos, buf->buffer, len);
+        pos += len;
+        jerry_release_value(item);
+    }
+    memset(dst->buffer + pos, 0, total - pos);
+    return new_buf;
 }
 
-static jerry_value_t zjs_buffer_write_uint16_be(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static jerry_value_t zjs_buffer_copy(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
 {
-    return zjs_buffer_write_bytes(this, argv, argc, 2, true);
+    // requires: this must be a JS buffer object, argv[0] the target Buffer,
+    //             and the rest optional offsets within the target and this
+    //  effects: copies from sourceStart up to sourceEnd in this Buffer to
+    //             targetStart in the target, as much as fits; the two may
+    //             share memory; returns the number of bytes copied
+
+    // args: target[, targetStart[, sourceStart[, sourceEnd]]]
+    ZJS_VALIDATE_ARGS(Z_OBJECT, Z_OPTIONAL Z_NUMBER, Z_OPTIONAL Z_NUMBER,
+                      Z_OPTIONAL Z_NUMBER);
+
+    zjs_buffer_t *src = zjs_buffer_find(this);
+    zjs_buffer_t *dst = zjs_buffer_find(argv[0]);
+    if (!src || !dst)
+        return zjs_error("zjs_buffer_copy: buffer not found");
+    if (zjs_buffer_is_readonly(dst))
+        return zjs_error("zjs_buffer_copy: target is read-only");
+
+    uint32_t target_start = zjs_buffer_get_offset(argv, argc, 1, 0,
+                                                  dst->bufsize);
+    uint32_t source_start = zjs_buffer_get_offset(argv, argc, 2, 0,
+                                                  src->bufsize);
+    uint32_t source_end = zjs_buffer_get_offset(argv, argc, 3, src->bufsize,
+                                                src->bufsize);
+    if (source_end < source_start)
+        source_end = source_start;
+
+    uint32_t len = source_end - source_start;
+    if (len > dst->bufsize - target_start)
+        len = dst->bufsize - target_start;
+    memmove(dst->buffer + target_start, src->buffer + source_start, len);
+    return jerry_create_number(len);
 }
 
-static jerry_value_t zjs_buffer_write_uint16_le(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static jerry_value_t zjs_buffer_fill(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
 {
-    return zjs_buffer_write_bytes(this, argv, argc, 2, false);
+    // requires: this must be a JS buffer object, argv[0] a byte value, string
+    //             or Buffer, and the rest optional offsets within this
+    //  effects: fills from offset up to end with value, repeated as needed,
+    //             and returns this
+
+    // args: value[, offset[, end]]
+    ZJS_VALIDATE_ARGS(Z_NUMBER Z_STRING Z_OBJECT, Z_OPTIONAL Z_NUMBER,
+                      Z_OPTIONAL Z_NUMBER);
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_fill: buffer not found");
+    if (zjs_buffer_is_readonly(buf))
+        return zjs_error("zjs_buffer_fill: buffer is read-only");
+
+    uint32_t start = zjs_buffer_get_offset(argv, argc, 1, 0, buf->bufsize);
+    uint32_t end = zjs_buffer_get_offset(argv, argc, 2, buf->bufsize,
+                                         buf->bufsize);
+    if (end < start)
+        end = start;
+
+    buffer_pattern_t pat;
+    if (!zjs_buffer_get_pattern(argv[0], &pat))
+        return zjs_error("zjs_buffer_fill: invalid value");
+
+    uint8_t *dst = buf->buffer + start;
+    uint32_t len = end - start;
+    if (pat.len == 1) {
+        memset(dst, pat.data[0], len);
+    } else if (pat.len && len) {
+        // lay down one copy, then double what's filled until done; the
+        //   pattern may overlap the destination, so move the first copy
+        uint32_t filled = pat.len < len ? pat.len : len;
+        memmove(dst, pat.data, filled);
+        while (filled < len) {
+            uint32_t chunk = filled < len - filled ? filled : len - filled;
+            memcpy(dst + filled, dst, chunk);
+            filled += chunk;
+        }
+    }
+    zjs_buffer_free_pattern(&pat);
+    return jerry_acquire_value(this);
 }
 
-static jerry_value_t zjs_buffer_write_uint32_be(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
+static jerry_value_t zjs_buffer_compare_common(const jerry_value_t this,
                                                const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+                                               const jerry_length_t argc,
+                                               bool equals)
 {
-    return zjs_buffer_write_bytes(this, argv, argc, 4, true);
+    // requires: this must be a JS buffer object, argv[0] another Buffer
+    //  effects: compares the contents bytewise and returns -1, 0 or 1 as this
+    //             sorts before, equal to or after the other Buffer, or a
+    //             boolean for equality if equals is true
+
+    // args: other
+    ZJS_VALIDATE_ARGS(Z_OBJECT);
+
+    zjs_buffer_t *a = zjs_buffer_find(this);
+    zjs_buffer_t *b = zjs_buffer_find(argv[0]);
+    if (!a || !b)
+        return zjs_error("zjs_buffer_compare: buffer not found");
+
+    if (equals) {
+        return jerry_create_boolean(a->bufsize == b->bufsize &&
+            !zjs_compare_bytes(a->buffer, b->buffer, a->bufsize));
+    }
+
+    uint32_t len = a->bufsize < b->bufsize ? a->bufsize : b->bufsize;
+    int result = zjs_compare_bytes(a->buffer, b->buffer, len);
+    if (!result && a->bufsize != b->bufsize)
+        result = a->bufsize < b->bufsize ? -1 : 1;
+    return jerry_create_number(result);
 }
 
-static jerry_value_t zjs_buffer_write_uint32_le(const jerry_value_t function_obj,
-                                               const jerry_value_t this,
-                                               const jerry_value_t argv[],
-                                               const jerry_length_t argc)
+static jerry_value_t zjs_buffer_equals(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    return zjs_buffer_compare_common(this, argv, argc, true);
+}
+
+static jerry_value_t zjs_buffer_compare(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    return zjs_buffer_compare_common(this, argv, argc, false);
+}
+
+static jerry_value_t zjs_buffer_index_of(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // requires: this must be a JS buffer object, argv[0] a byte value, string
+    //             or Buffer to find, argv[1] optionally the offset to start
+    //             searching, counted back from the end if negative
+    //  effects: returns the offset of the first match, or -1 if not found
+
+    // args: value[, byteOffset]
+    ZJS_VALIDATE_ARGS(Z_NUMBER Z_STRING Z_OBJECT, Z_OPTIONAL Z_NUMBER);
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_index_of: buffer not found");
+
+    uint32_t start = 0;
+    if (argc > 1) {
+        double pos = jerry_get_number_value(argv[1]);
+        if (pos < 0)
+            pos += buf->bufsize;
+        if (pos > buf->bufsize)
+            return jerry_create_number(-1);
+        if (pos > 0)
+            start = (uint32_t)pos;
+    }
+
+    buffer_pattern_t pat;
+    if (!zjs_buffer_get_pattern(argv[0], &pat))
+        return zjs_error("zjs_buffer_index_of: invalid value");
+
+    const uint8_t *match = zjs_find_bytes(buf->buffer + start,
+                                          buf->bufsize - start, pat.data,
+                                          pat.len);
+    zjs_buffer_free_pattern(&pat);
+    return jerry_create_number(match ? match - buf->buffer : -1);
+}
+
+enum buffer_encoding {
+    ENCODING_UTF8,
+    ENCODING_ASCII,
+    ENCODING_HEX,
+    ENCODING_BASE64
+};
+
+static int zjs_buffer_get_encoding(jerry_value_t value)
+{
+    // requires: value is a string
+    //  effects: returns the ENCODING_* value names, or -1 if not supported
+    const int MAX_ENCODING_LEN = 16;
+    jerry_size_t size = MAX_ENCODING_LEN;
+    char encoding[MAX_ENCODING_LEN];
+    zjs_copy_jstring(value, encoding, &size);
+
+    if (!strcmp(encoding, "utf8") || !strcmp(encoding, "utf-8"))
+        return ENCODING_UTF8;
+    if (!strcmp(encoding, "ascii"))
+        return ENCODING_ASCII;
+    if (!strcmp(encoding, "hex"))
+        return ENCODING_HEX;
+    if (!strcmp(encoding, "base64"))
+        return ENCODING_BASE64;
+    return -1;
+}
+
+static uint32_t zjs_buffer_decoded_size(const char *str, uint32_t len,
+                                        int encoding)
+{
+    if (encoding == ENCODING_HEX)
+        return len / 2;
+    if (encoding == ENCODING_BASE64)
+        return zjs_base64_decoded_size(str, len);
+    return len;
+}
+
+static int32_t zjs_buffer_decode(const char *str, uint32_t len, int encoding,
+                                 uint8_t *dst)
 {
-    return zjs_buffer_write_bytes(this, argv, argc, 4, false);
+    // requires: dst has room for zjs_buffer_decoded_size(str, len, encoding)
+    //  effects: decodes str into dst and returns the number of bytes, or -1 if
+    //             str is not valid in the encoding; utf8 and ascii strings are
+    //             copied as JerryScript stores them
+    if (encoding == ENCODING_HEX)
+        return zjs_hex_decode(str, len, dst);
+    if (encoding == ENCODING_BASE64)
+        return zjs_base64_decode(str, len, dst);
+    memcpy(dst, str, len);
+    return len;
 }
 
-char zjs_int_to_hex(int value) {
-    // requires: value is between 0 and 15
-    //  effects: returns value as a lowercase hex digit 0-9a-f
-    if (value < 10)
-        return '0' + value;
-    return 'a' + value - 10;
+static bool zjs_buffer_is_ascii(const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] & 0x80)
+            return false;
+    }
+    return true;
 }
 
 static jerry_value_t zjs_buffer_to_string(const jerry_value_t function_obj,
@@ -210,10 +728,9 @@ static jerry_value_t zjs_buffer_to_string(const jerry_value_t function_obj,
                                           const jerry_length_t argc)
 {
     // requires: this must be a JS buffer object, if an argument is present it
-    //             must be the string 'ascii' or 'hex', as those are the only
-    //             supported encodings for now
-    //  effects: if the buffer object is found, converts its contents to a hex
-    //             string and returns it
+    //             must be the string 'utf8', 'ascii', 'hex' or 'base64'
+    //  effects: if the buffer object is found, converts its contents to a
+    //             string in that encoding and returns it
 
     // args: [encoding]
     ZJS_VALIDATE_ARGS(Z_OPTIONAL Z_STRING);
@@ -223,43 +740,335 @@ static jerry_value_t zjs_buffer_to_string(const jerry_value_t function_obj,
         return jerry_create_string((jerry_char_t *)"[Buffer Object]");
     }
 
-    const int MAX_ENCODING_LEN = 16;
-    jerry_size_t size = MAX_ENCODING_LEN;
-    char encoding[size];
-    zjs_copy_jstring(argv[0], encoding, &size);
-    if (!size) {
-        return zjs_error("zjs_buffer_to_string: encoding argument too long");
-    }
-
-    if (strcmp(encoding, "ascii") == 0) {
-        buf->buffer[buf->bufsize] = '\0';
-        return jerry_create_string((jerry_char_t *)buf->buffer);
-    } else if (strcmp(encoding, "hex") == 0) {
-        if (buf && buf->bufsize > 0) {
-            char hexbuf[buf->bufsize * 2 + 1];
-            for (int i=0; i<buf->bufsize; i++) {
-                int high = (0xf0 & buf->buffer[i]) >> 4;
-                int low = 0xf & buf->buffer[i];
-                hexbuf[2*i] = zjs_int_to_hex(high);
-                hexbuf[2*i+1] = zjs_int_to_hex(low);
+    int encoding = zjs_buffer_get_encoding(argv[0]);
+    if (encoding < 0) {
+        return zjs_error("zjs_buffer_to_string: unsupported encoding type");
+    }
+
+    if (!buf) {
+        return zjs_error("zjs_buffer_to_string: buffer not found");
+    }
+
+    // strings the buffer can't be passed through as are built on the heap,
+    //   never the stack, since Zephyr stacks are small
+    uint32_t len = 0;
+    switch (encoding) {
+    case ENCODING_UTF8:
+        if (zjs_utf8_is_cesu8(buf->buffer, buf->bufsize)) {
+            return jerry_create_string_sz((jerry_char_t *)buf->buffer,
+                                          buf->bufsize);
+        }
+        len = zjs_utf8_to_cesu8(buf->buffer, buf->bufsize, NULL);
+        break;
+    case ENCODING_ASCII:
+        len = buf->bufsize;
+        if (zjs_buffer_is_ascii(buf->buffer, len)) {
+            return jerry_create_string_sz((jerry_char_t *)buf->buffer, len);
+        }
+        break;
+    case ENCODING_HEX:
+        len = ZJS_HEX_ENCODED_SIZE(buf->bufsize);
+        break;
+    default:
+        len = ZJS_BASE64_ENCODED_SIZE(buf->bufsize);
+        break;
+    }
+
+    if (!len) {
+        return jerry_create_string((jerry_char_t *)"");
+    }
+
+    char *str = zjs_malloc(len);
+    if (!str) {
+        return zjs_error("zjs_buffer_to_string: out of memory");
+    }
+
+    switch (encoding) {
+    case ENCODING_UTF8:
+        zjs_utf8_to_cesu8(buf->buffer, buf->bufsize, (uint8_t *)str);
+        break;
+    case ENCODING_ASCII:
+        // like node, drop the high bit
+        for (uint32_t i = 0; i < len; i++) {
+            str[i] = buf->buffer[i] & 0x7f;
+        }
+        break;
+    case ENCODING_HEX:
+        zjs_hex_encode(buf->buffer, buf->bufsize, str);
+        break;
+    default:
+        zjs_base64_encode(buf->buffer, buf->bufsize, str);
+        break;
+    }
+
+    jerry_value_t result = jerry_create_string_sz((jerry_char_t *)str, len);
+    zjs_free(str);
+    return result;
+}
+
+// Small stores come from per-size-class slabs: each slab is one heap
+//   allocation carved into ZJS_BUFFER_SLAB_BLOCKS blocks of store header plus
+//   data, and freed blocks go on a free list for reuse. Slabs are kept for
+//   the life of the program, so repeated small reads never touch the heap.
+#ifndef ZJS_BUFFER_SLAB_BLOCKS
+#define ZJS_BUFFER_SLAB_BLOCKS  8
+#endif
+
+#define BUFFER_POOL_HEAP        0xff
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block_t;
+
+typedef struct buffer_pool {
+    uint16_t data_size;
+    pool_block_t *free_list;
+    uint32_t blocks;                // total blocks in this pool's slabs
+    uint32_t in_use;
+    uint32_t used_bytes;            // bytes requested by blocks in use
+    uint32_t hits;                  // allocations served from the free list
+    uint32_t misses;                // allocations that needed a new slab
+} buffer_pool_t;
+
+static buffer_pool_t buffer_pools[] = {
+    { 16 }, { 32 }, { 64 }, { 128 }
+};
+
+#define BUFFER_POOLS (sizeof(buffer_pools) / sizeof(buffer_pools[0]))
+
+static uint32_t heap_stores = 0;
+static uint32_t heap_allocs = 0;
+
+static uint32_t pool_block_size(const buffer_pool_t *pool)
+{
+    // keep blocks pointer aligned so each store header is too
+    uint32_t size = sizeof(zjs_buffer_store_t) + pool->data_size;
+    return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+static bool pool_grow(buffer_pool_t *pool)
+{
+    //  effects: adds a slab of blocks to pool's free list
+    uint32_t block_size = pool_block_size(pool);
+    uint8_t *slab = zjs_malloc(block_size * ZJS_BUFFER_SLAB_BLOCKS);
+    if (!slab) {
+        return false;
+    }
+    for (int i = ZJS_BUFFER_SLAB_BLOCKS - 1; i >= 0; i--) {
+        pool_block_t *block = (pool_block_t *)(slab + i * block_size);
+        block->next = pool->free_list;
+        pool->free_list = block;
+    }
+    pool->blocks += ZJS_BUFFER_SLAB_BLOCKS;
+    return true;
+}
+
+static zjs_buffer_store_t *zjs_buffer_store_alloc(uint32_t size)
+{
+    //  effects: allocates a store with room for size bytes of data, from the
+    //             smallest pool that fits or else from the heap
+    zjs_buffer_store_t *store = NULL;
+    uint8_t index = BUFFER_POOL_HEAP;
+    for (int i = 0; i < BUFFER_POOLS; i++) {
+        buffer_pool_t *pool = &buffer_pools[i];
+        if (size > pool->data_size) {
+            continue;
+        }
+        if (pool->free_list) {
+            pool->hits++;
+        } else {
+            pool->misses++;
+            if (!pool_grow(pool)) {
+                // heap is too fragmented for a whole slab, try just this one
+                break;
             }
-            hexbuf[buf->bufsize * 2] = '\0';
-            return jerry_create_string((jerry_char_t *)hexbuf);
         }
-    } else {
-        return zjs_error("zjs_buffer_to_string: unsupported encoding type");
+        store = (zjs_buffer_store_t *)pool->free_list;
+        pool->free_list = pool->free_list->next;
+        pool->in_use++;
+        pool->used_bytes += size;
+        index = i;
+        break;
+    }
+
+    if (!store) {
+        if (size > UINT32_MAX - sizeof(zjs_buffer_store_t)) {
+            return NULL;
+        }
+        store = zjs_malloc(sizeof(zjs_buffer_store_t) + size);
+        if (!store) {
+            return NULL;
+        }
+        heap_stores++;
+        heap_allocs++;
+    }
+
+    store->data = (uint8_t *)(store + 1);
+    store->size = size;
+    store->refs = 0;
+    store->pool = index;
+    store->flags = 0;
+    store->release = NULL;
+    store->ctx = NULL;
+    return store;
+}
+
+static void zjs_buffer_store_free(zjs_buffer_store_t *store)
+{
+    if (store->flags & ZJS_BUFFER_EXTERNAL) {
+        if (store->release) {
+            store->release(store->data, store->ctx);
+        }
+        // only the header came from the pool
+        store->size = 0;
+    }
+
+    if (store->pool == BUFFER_POOL_HEAP) {
+        heap_stores--;
+        zjs_free(store);
+        return;
+    }
+
+    buffer_pool_t *pool = &buffer_pools[store->pool];
+    pool->in_use--;
+    pool->used_bytes -= store->size;
+    pool_block_t *block = (pool_block_t *)store;
+    block->next = pool->free_list;
+    pool->free_list = block;
+}
+
+void zjs_buffer_print_stats()
+{
+    ZJS_PRINT("\nBuffer pools:\n");
+    ZJS_PRINT("%6s %8s %8s %8s %8s %6s %8s %8s\n", "SIZE", "BLOCKS", "IN_USE",
+              "HITS", "MISSES", "HIT%", "SLACK", "IDLE");
+    for (int i = 0; i < BUFFER_POOLS; i++) {
+        buffer_pool_t *pool = &buffer_pools[i];
+        uint32_t allocs = pool->hits + pool->misses;
+        // slack is data space lost to rounding up to the size class, idle is
+        //   space held by free blocks in the slabs
+        uint32_t slack = pool->in_use * pool->data_size - pool->used_bytes;
+        uint32_t idle = (pool->blocks - pool->in_use) * pool_block_size(pool);
+        ZJS_PRINT("%6u %8u %8u %8u %8u %6u %8u %8u\n", pool->data_size,
+                  pool->blocks, pool->in_use, pool->hits, pool->misses,
+                  allocs ? pool->hits * 100 / allocs : 0, slack, idle);
     }
-    return zjs_error("zjs_buffer_to_string: buffer is empty");
+    ZJS_PRINT("%6s %8s %8u %8u\n", "heap", "", heap_stores, heap_allocs);
 }
 
 static void zjs_buffer_callback_free(uintptr_t handle)
 {
-    // requires: handle is the native pointer we registered with
-    //             jerry_set_object_native_handle
-    //  effects: frees the buffer item
+    // requires: handle is the buffer item we registered with zjs_wrap
+    //  effects: frees the buffer item, and its store if no other views of it
+    //             remain
     zjs_buffer_t *item = (zjs_buffer_t *)handle;
-    zjs_free(item->buffer);
-    zjs_free(item);
+    zjs_buffer_store_t *store = item->store;
+    if (item != &store->head) {
+        zjs_free(item);
+    }
+    if (--store->refs == 0) {
+        zjs_buffer_store_free(store);
+    }
+}
+
+static jerry_value_t zjs_buffer_new_view(zjs_buffer_store_t *store,
+                                         zjs_buffer_t *buf_item,
+                                         uint8_t *start, uint32_t size)
+{
+    // requires: store is a valid store, start and size lie within it; buf_item
+    //             is the store's head view or NULL to allocate one
+    //  effects: creates a JS Buffer object viewing size bytes from start and
+    //             takes a reference on store; returns undefined on failure
+    if (!buf_item) {
+        buf_item = (zjs_buffer_t *)zjs_malloc(sizeof(zjs_buffer_t));
+        if (!buf_item) {
+            ERR_PRINT("unable to allocate buffer\n");
+            return ZJS_UNDEFINED;
+        }
+    }
+
+    jerry_value_t buf_obj = jerry_create_object();
+    buf_item->obj = buf_obj;
+    buf_item->buffer = start;
+    buf_item->bufsize = size;
+    buf_item->store = store;
+    store->refs++;
+
+    jerry_set_prototype(buf_obj, zjs_buffer_prototype);
+    zjs_obj_add_readonly_number(buf_obj, size, "length");
+
+    // watch for the object getting garbage collected, and clean up
+    zjs_wrap(buf_obj, &buf_item->native, ZJS_CLASS_BUFFER,
+             zjs_buffer_callback_free);
+
+    return buf_obj;
+}
+
+jerry_value_t zjs_buffer_wrap_external(void *ptr, uint32_t len,
+                                       zjs_buffer_release_cb release,
+                                       void *ctx, bool readonly)
+{
+    zjs_buffer_store_t *store = zjs_buffer_store_alloc(0);
+    if (!store) {
+        ERR_PRINT("unable to allocate buffer\n");
+        return ZJS_UNDEFINED;
+    }
+    store->data = (uint8_t *)ptr;
+    store->size = len;
+    store->flags = ZJS_BUFFER_EXTERNAL;
+    if (readonly) {
+        store->flags |= ZJS_BUFFER_READONLY;
+    }
+    store->release = release;
+    store->ctx = ctx;
+    return zjs_buffer_new_view(store, &store->head, store->data, len);
+}
+
+jerry_value_t zjs_buffer_create_view(zjs_buffer_t *buf, uint32_t offset,
+                                     uint32_t length)
+{
+    return zjs_buffer_new_view(buf->store, NULL, buf->buffer + offset, length);
+}
+
+static jerry_value_t zjs_buffer_slice(const jerry_value_t function_obj,
+                                      const jerry_value_t this,
+                                      const jerry_value_t argv[],
+                                      const jerry_length_t argc)
+{
+    // requires: this must be a JS buffer object; start and end are byte
+    //             offsets, counted back from the end of the buffer if negative
+    //  effects: returns a new Buffer sharing the memory from start up to but
+    //             not including end, without copying it
+
+    // args: [start[, end]]
+    ZJS_VALIDATE_ARGS(Z_OPTIONAL Z_NUMBER, Z_OPTIONAL Z_NUMBER);
+
+    zjs_buffer_t *buf = zjs_buffer_find(this);
+    if (!buf)
+        return zjs_error("zjs_buffer_slice: buffer not found");
+
+    double len = buf->bufsize;
+    double bounds[2] = { 0, len };
+    for (int i = 0; i < 2 && i < argc; i++) {
+        double pos = jerry_get_number_value(argv[i]);
+        if (pos < 0)
+            pos += len;
+        if (pos < 0)
+            pos = 0;
+        else if (pos > len)
+            pos = len;
+        bounds[i] = pos;
+    }
+
+    uint32_t start = (uint32_t)bounds[0];
+    uint32_t end = (uint32_t)bounds[1];
+    if (end < start)
+        end = start;
+
+    jerry_value_t view = zjs_buffer_create_view(buf, start, end - start);
+    if (!jerry_value_is_object(view))
+        return zjs_error("zjs_buffer_slice: out of memory");
+    return view;
 }
 
 static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
@@ -270,8 +1079,8 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
     // requires: string - what will be written to buf
     //           offset - where to start writing (Default: 0)
     //           length - how many bytes to write (Default: buf.length -offset)
-    //           encoding - the character encoding of string. Currently only
-    //             supports the default of utf8
+    //           encoding - the character encoding of string: utf8 (the
+    //             default), ascii, hex or base64
     //  effects: writes string to buf at offset according to the character
     //             encoding in encoding.
 
@@ -279,28 +1088,20 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
     ZJS_VALIDATE_ARGS(Z_STRING, Z_OPTIONAL Z_NUMBER, Z_OPTIONAL Z_NUMBER,
                       Z_OPTIONAL Z_STRING);
 
-    // Check if the encoding string is anything other than utf8
+    int encoding = ENCODING_UTF8;
     if (argc > 3) {
-        char *encoding = zjs_alloc_from_jstring(argv[3], NULL);
-        if (!encoding) {
-            return zjs_error("zjs_buffer_write_string: allocation failure");
-        }
-
-        // ask for one more char than needed to make sure not just prefix match
-        const char *utf8_encoding = "utf8";
-        int utf8_len = strlen(utf8_encoding);
-        int rval = strncmp(encoding, utf8_encoding, utf8_len + 1);
-        zjs_free(encoding);
-        if (rval != 0) {
-            return NOTSUPPORTED_ERROR("zjs_buffer_write_string: only utf8 encoding supported");
+        encoding = zjs_buffer_get_encoding(argv[3]);
+        if (encoding < 0) {
+            return NOTSUPPORTED_ERROR("zjs_buffer_write_string: unsupported encoding");
         }
     }
 
-    jerry_size_t size = 0;
-    char *str = zjs_alloc_from_jstring(argv[0], &size);
+    jerry_size_t len = 0;
+    char *str = zjs_alloc_from_jstring(argv[0], &len);
     if (!str) {
         return zjs_error("zjs_buffer_write_string: string too long");
     }
+    uint32_t size = zjs_buffer_decoded_size(str, len, encoding);
 
     zjs_buffer_t *buf = zjs_buffer_find(this);
     if (!buf) {
@@ -308,13 +1109,20 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
         return zjs_error("zjs_buffer_write_string: buffer not found");
     }
 
+    if (zjs_buffer_is_readonly(buf)) {
+        zjs_free(str);
+        return zjs_error("zjs_buffer_write_string: buffer is read-only");
+    }
+
     uint32_t offset = 0;
     if (argc > 1)
         offset = (uint32_t)jerry_get_number_value(argv[1]);
 
-    uint32_t length = buf->bufsize - offset;
+    uint32_t length = size;
     if (argc > 2)
         length = (uint32_t)jerry_get_number_value(argv[2]);
+    else if (offset < buf->bufsize && length > buf->bufsize - offset)
+        length = buf->bufsize - offset;
 
     if (length > size) {
         zjs_free(str);
@@ -326,8 +1134,25 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
         return zjs_error("zjs_buffer_write_string: string + offset larger than buffer");
     }
 
-    memcpy(buf->buffer + offset, str, length);
+    // decode straight into the buffer unless only part of it will fit
+    uint8_t *dst = buf->buffer + offset;
+    if (length < size) {
+        dst = zjs_malloc(size);
+        if (!dst) {
+            zjs_free(str);
+            return zjs_error("zjs_buffer_write_string: out of memory");
+        }
+    }
+    int32_t decoded = zjs_buffer_decode(str, len, encoding, dst);
     zjs_free(str);
+    if (dst != buf->buffer + offset) {
+        if (decoded >= 0)
+            memcpy(buf->buffer + offset, dst, length);
+        zjs_free(dst);
+    }
+    if (decoded < 0) {
+        return zjs_error("zjs_buffer_write_string: invalid string for encoding");
+    }
 
     return jerry_create_number(length);
 }
@@ -335,34 +1160,15 @@ static jerry_value_t zjs_buffer_write_string(const jerry_value_t function_obj,
 jerry_value_t zjs_buffer_create(uint32_t size)
 {
     // requires: size is size of desired buffer, in bytes
-    //  effects: allocates a JS Buffer object, an underlying C buffer, and a
-    //             list item to track it; if any of these fail, free them all
-    //             and return undefined, otherwise return the JS object
-    jerry_value_t buf_obj = jerry_create_object();
-    void *buf = zjs_malloc(size);
-    zjs_buffer_t *buf_item =
-        (zjs_buffer_t *)zjs_malloc(sizeof(zjs_buffer_t));
-
-    if (!buf || !buf_item) {
+    //  effects: allocates a store holding the C buffer and the JS Buffer's
+    //             list item inline, and a JS Buffer object viewing all of it;
+    //             returns undefined on failure, otherwise the JS object
+    zjs_buffer_store_t *store = zjs_buffer_store_alloc(size);
+    if (!store) {
         ERR_PRINT("unable to allocate buffer\n");
-        jerry_release_value(buf_obj);
-        zjs_free(buf);
-        zjs_free(buf_item);
         return ZJS_UNDEFINED;
     }
-
-    buf_item->obj = buf_obj;
-    buf_item->buffer = buf;
-    buf_item->bufsize = size;
-
-    jerry_set_prototype(buf_obj, zjs_buffer_prototype);
-    zjs_obj_add_readonly_number(buf_obj, size, "length");
-
-    // watch for the object getting garbage collected, and clean up
-    jerry_set_object_native_handle(buf_obj, (uintptr_t)buf_item,
-                                   zjs_buffer_callback_free);
-
-    return buf_obj;
+    return zjs_buffer_new_view(store, &store->head, store->data, size);
 }
 
 // Buffer constructor
@@ -371,14 +1177,15 @@ static jerry_value_t zjs_buffer(const jerry_value_t function_obj,
                                 const jerry_value_t argv[],
                                 const jerry_length_t argc)
 {
-    // requires: single argument can be a numeric size in bytes, an array of
-    //             uint8s, or a string
+    // requires: first argument can be a numeric size in bytes, an array of
+    //             uint8s, or a string; a string may be followed by its
+    //             encoding, utf8 by default
     //  effects: constructs a new JS Buffer object, and an associated buffer
     //             tied to it through a zjs_buffer_t struct stored in a global
     //             list
 
-    // args: initial size or initialization data
-    ZJS_VALIDATE_ARGS(Z_NUMBER Z_ARRAY Z_STRING);
+    // args: initial size or initialization data[, encoding]
+    ZJS_VALIDATE_ARGS(Z_NUMBER Z_ARRAY Z_STRING, Z_OPTIONAL Z_STRING);
 
     if (jerry_value_is_number(argv[0])) {
         // treat a number argument as a length
@@ -410,16 +1217,26 @@ static jerry_value_t zjs_buffer(const jerry_value_t function_obj,
     }
     else {
         // treat string argument as initializer
-        jerry_size_t size = 0;
-        char *str = zjs_alloc_from_jstring(argv[0], &size);
+        int encoding = ENCODING_UTF8;
+        if (argc > 1) {
+            encoding = zjs_buffer_get_encoding(argv[1]);
+            if (encoding < 0) {
+                return NOTSUPPORTED_ERROR("zjs_buffer: unsupported encoding");
+            }
+        }
+
+        jerry_size_t len = 0;
+        char *str = zjs_alloc_from_jstring(argv[0], &len);
         if (!str) {
             return zjs_error("zjs_buffer: could not allocate string");
         }
 
+        uint32_t size = zjs_buffer_decoded_size(str, len, encoding);
         jerry_value_t new_buf = zjs_buffer_create(size);
-        if (jerry_value_is_object(new_buf)) {
-            zjs_buffer_t *buf = zjs_buffer_find(new_buf);
-            memcpy(buf->buffer, str, size);
+        zjs_buffer_t *buf = zjs_buffer_find(new_buf);
+        if (buf && zjs_buffer_decode(str, len, encoding, buf->buffer) < 0) {
+            jerry_release_value(new_buf);
+            new_buf = zjs_error("zjs_buffer: invalid string for encoding");
         }
 
         zjs_free(str);
@@ -431,6 +1248,9 @@ void zjs_buffer_init()
 {
     jerry_value_t global_obj = jerry_get_global_object();
     zjs_obj_add_function(global_obj, zjs_buffer, "Buffer");
+    jerry_value_t buffer_func = zjs_get_property(global_obj, "Buffer");
+    zjs_obj_add_function(buffer_func, zjs_buffer_concat, "concat");
+    jerry_release_value(buffer_func);
     jerry_release_value(global_obj);
 
     zjs_native_func_t array[] = {
@@ -444,6 +1264,47 @@ void zjs_buffer_init()
         { zjs_buffer_write_uint32_be, "writeUInt32BE" },
         { zjs_buffer_read_uint32_le, "readUInt32LE" },
         { zjs_buffer_write_uint32_le, "writeUInt32LE" },
+        { zjs_buffer_read_int8, "readInt8" },
+        { zjs_buffer_write_int8, "writeInt8" },
+        { zjs_buffer_read_int16_be, "readInt16BE" },
+        { zjs_buffer_write_int16_be, "writeInt16BE" },
+        { zjs_buffer_read_int16_le, "readInt16LE" },
+        { zjs_buffer_write_int16_le, "writeInt16LE" },
+        { zjs_buffer_read_int32_be, "readInt32BE" },
+        { zjs_buffer_write_int32_be, "writeInt32BE" },
+        { zjs_buffer_read_int32_le, "readInt32LE" },
+        { zjs_buffer_write_int32_le, "writeInt32LE" },
+        { zjs_buffer_read_float_be, "readFloatBE" },
+        { zjs_buffer_write_float_be, "writeFloatBE" },
+        { zjs_buffer_read_float_le, "readFloatLE" },
+        { zjs_buffer_write_float_le, "writeFloatLE" },
+        { zjs_buffer_read_double_be, "readDoubleBE" },
+        { zjs_buffer_write_double_be, "writeDoubleBE" },
+        { zjs_buffer_read_double_le, "readDoubleLE" },
+        { zjs_buffer_write_double_le, "writeDoubleLE" },
+        { zjs_buffer_read_array_uint8, "readUInt8Array" },
+        { zjs_buffer_write_array_uint8, "writeUInt8Array" },
+        { zjs_buffer_read_array_int8, "readInt8Array" },
+        { zjs_buffer_write_array_int8, "writeInt8Array" },
+        { zjs_buffer_read_array_uint16, "readUInt16Array" },
+        { zjs_buffer_write_array_uint16, "writeUInt16Array" },
+        { zjs_buffer_read_array_int16, "readInt16Array" },
+        { zjs_buffer_write_array_int16, "writeInt16Array" },
+        { zjs_buffer_read_array_uint32, "readUInt32Array" },
+        { zjs_buffer_write_array_uint32, "writeUInt32Array" },
+        { zjs_buffer_read_array_int32, "readInt32Array" },
+        { zjs_buffer_write_array_int32, "writeInt32Array" },
+        { zjs_buffer_read_array_float, "readFloatArray" },
+        { zjs_buffer_write_array_float, "writeFloatArray" },
+        { zjs_buffer_read_array_double, "readDoubleArray" },
+        { zjs_buffer_write_array_double, "writeDoubleArray" },
+        { zjs_buffer_copy, "copy" },
+        { zjs_buffer_fill, "fill" },
+        { zjs_buffer_equals, "equals" },
+        { zjs_buffer_compare, "compare" },
+        { zjs_buffer_index_of, "indexOf" },
+        { zjs_buffer_slice, "slice" },
+        { zjs_buffer_slice, "subarray" },
         { zjs_buffer_to_string, "toString" },
         { zjs_buffer_write_string, "write" },
         { NULL, NULL }
@@ -4,6 +4,7 @@
 #define __zjs_buffer_h__
 
 #include "jerry-api.h"
+#include "zjs_util.h"
 
 /** Initialize the buffer module, or reinitialize after cleanup */
 void zjs_buffer_init();
@@ -11,15 +12,87 @@ void zjs_buffer_init();
 /** Release resources held by the buffer module */
 void zjs_buffer_cleanup();
 
+/** Print buffer pool hit rates and fragmentation */
+void zjs_buffer_print_stats();
+
+// a Buffer is a view of bufsize bytes of its store, starting at buffer
 typedef struct zjs_buffer {
+    zjs_native_t native;
     jerry_value_t obj;
     uint8_t *buffer;
     uint32_t bufsize;
-    struct zjs_buffer *next;
+    struct zjs_buffer_store *store;
 } zjs_buffer_t;
 
+/**
+ * Called when the last Buffer viewing external memory has been collected.
+ *
+ * @param ptr  Memory given to zjs_buffer_wrap_external
+ * @param ctx  Context given to zjs_buffer_wrap_external
+ */
+typedef void (*zjs_buffer_release_cb)(void *ptr, void *ctx);
+
+// store flags
+#define ZJS_BUFFER_EXTERNAL     0x01    // data is not owned by the store
+#define ZJS_BUFFER_READONLY     0x02    // JS and natives must not write data
+
+// backing memory shared by a Buffer and any slices of it, freed when the last
+//   Buffer viewing it is collected; the store, the first Buffer's view and
+//   the data are one allocation, from a slab pool when small enough
+typedef struct zjs_buffer_store {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t refs;
+    uint8_t pool;                   // size class, or BUFFER_POOL_HEAP
+    uint8_t flags;
+    zjs_buffer_release_cb release;  // for external data, may be NULL
+    void *ctx;
+    zjs_buffer_t head;              // view created along with the store
+} zjs_buffer_store_t;
+
+// true if buf must not be written to, e.g. a view of a const table in ROM
+#define zjs_buffer_is_readonly(buf) \
+    ((buf)->store->flags & ZJS_BUFFER_READONLY)
+
+/**
+ * Get the view a Buffer object wraps.
+ *
+ * @param obj  Any JS value
+ * @return The Buffer's view, or NULL if obj is not a Buffer
+ */
 zjs_buffer_t *zjs_buffer_find(const jerry_value_t obj);
 
 jerry_value_t zjs_buffer_create(uint32_t size);
 
+/**
+ * Create a Buffer over memory owned by the caller, without copying it.
+ *
+ * @param ptr       Memory to expose, must stay valid until release is called
+ * @param len       Length of the memory in bytes
+ * @param release   Called with ptr and ctx once the Buffer and any slices of
+ *                    it have been collected; may be NULL for static memory
+ * @param ctx       Passed to release
+ * @param readonly  True to make writes to the Buffer fail
+ * @return A new Buffer object or undefined if out of memory, in which case
+ *           release is not called
+ */
+jerry_value_t zjs_buffer_wrap_external(void *ptr, uint32_t len,
+                                       zjs_buffer_release_cb release,
+                                       void *ctx, bool readonly);
+
+// wrap a const table, e.g. in ROM, as a read-only Buffer
+#define zjs_buffer_wrap_const(ptr, len) \
+    zjs_buffer_wrap_external((void *)(ptr), len, NULL, NULL, true)
+
+/**
+ * Create a Buffer that views part of an existing Buffer without copying.
+ *
+ * @param buf     Buffer to view, the new Buffer keeps its store alive
+ * @param offset  Offset of the view within buf
+ * @param length  Length of the view, offset + length must be <= buf->bufsize
+ * @return A new Buffer object or undefined if out of memory
+ */
+jerry_value_t zjs_buffer_create_view(zjs_buffer_t *buf, uint32_t offset,
+                                     uint32_t length);
+
 #endif  // __zjs_buffer_h__
@@ -11,6 +11,12 @@
 
 #include "zjs_util.h"
 #include "zjs_callbacks.h"
+#ifdef ZJS_RECORD
+#include "zjs_record.h"
+#endif
+#ifdef ZJS_WATCHDOG
+#include "zjs_watchdog.h"
+#endif
 
 #include "jerry-api.h"
 
@@ -28,6 +34,7 @@
 #define INITIAL_CALLBACK_SIZE  16
 #define CB_CHUNK_SIZE          16
 #define CB_LIST_MULTIPLIER  4
+#define CB_LIST_MAX_FUNCS   255
 
 // flag bit value for JS callback
 #define CALLBACK_TYPE_JS    0
@@ -48,44 +55,84 @@
 #define SET_TYPE(f, b)     f |= (b << TYPE_BIT)
 #define SET_JS_TYPE(f, b)  f |= (b << JS_TYPE_BIT)
 #define SET_CB_REMOVED(f)  f |= (1 << CB_REMOVED_BIT)
+#define CLEAR_CB_REMOVED(f) f &= ~(1 << CB_REMOVED_BIT)
 // Macros to get the bits in flags
 #define GET_ONCE(f)        (f & (1 << ONCE_BIT)) >> ONCE_BIT
 #define GET_TYPE(f)        (f & (1 << TYPE_BIT)) >> TYPE_BIT
 #define GET_JS_TYPE(f)     (f & (1 << JS_TYPE_BIT)) >> JS_TYPE_BIT
 #define GET_CB_REMOVED(f)  (f & (1 << CB_REMOVED_BIT)) >> CB_REMOVED_BIT
 
+#ifdef ZJS_WATCHDOG
+#define CB_SOURCE_NAME_SIZE 16
+#endif
+
 // ring buffer values for flushing pending callbacks
 #define CB_FLUSH_ONE 0xfe
 #define CB_FLUSH_ALL 0xff
+// ring buffer value for a signal whose args are followed by a signal_post_t
+#define CB_SIGNAL_POST 0x01
+
+// post hook carried in the ring buffer with one signal of a callback
+typedef struct signal_post {
+    zjs_signal_post_func post;
+    void *handle;
+} signal_post_t;
+
+#define SIGNAL_POST_WORDS ((sizeof(signal_post_t) + 3) / 4)
+
+// entry flag for a function removed from a list; its slot is reclaimed when
+//   the list is compacted, which waits until no dispatch is walking the list
+#define CB_LIST_REMOVED 0x80
+
+// one function in a JS callback list
+typedef struct cb_list_entry {
+    jerry_value_t func;                 // 0 once released
+    uint8_t flags;                      // ZJS_CB_LIST_ONCE, CB_LIST_REMOVED
+} cb_list_entry_t;
 
-// FIXME: func_list is really an array :)
 typedef struct zjs_callback {
     void* handle;
     zjs_post_callback_func post;
     jerry_value_t this;
     union {
         jerry_value_t js_func;          // Single JS function callback
-        jerry_value_t* func_list;       // JS callback list
+        cb_list_entry_t *func_list;     // JS callback list
         zjs_c_callback_func function;   // C callback
     };
     zjs_callback_id id;
     uint8_t flags;      // holds once and type bits
     uint8_t max_funcs;
-    uint8_t num_funcs;
+    uint8_t num_funcs;  // functions in the list, not counting removed ones
+    // list slots in use are first to first + used - 1, removed ones included
+    uint8_t first;
+    uint8_t used;
+    uint8_t depth;      // dispatches walking the list
+    uint8_t shift;      // slots the list has moved right, mod 256
+#ifdef ZJS_WATCHDOG
+    const char *source_kind;
+    char source_name[CB_SOURCE_NAME_SIZE];
+#endif
 } zjs_callback_t;
 
 #ifdef ZJS_LINUX_BUILD
-static uint8_t args_buffer[ZJS_CALLBACK_BUF_SIZE];
+static uint32_t cb_buf_size = ZJS_CALLBACK_BUF_SIZE;
+static uint8_t *args_buffer = NULL;
 static struct zjs_port_ring_buf ring_buffer;
 #else
 SYS_RING_BUF_DECLARE_POW2(ring_buffer, 5);
 #endif
 static uint8_t ring_buf_initialized = 1;
+static uint16_t cb_loop_max = ZJS_MAX_CB_LOOP_ITERATION;
 
 static zjs_callback_id cb_limit = INITIAL_CALLBACK_SIZE;
 static zjs_callback_id cb_size = 0;
 static zjs_callback_t** cb_map = NULL;
 
+#ifdef ZJS_RECORD
+// nesting of zjs_call_callback, signals raised from JS are not recorded
+static uint8_t dispatch_depth = 0;
+#endif
+
 static int zjs_ringbuf_error_count = 0;
 static int zjs_ringbuf_error_max = 0;
 static int zjs_ringbuf_last_error = 0;
@@ -130,13 +177,49 @@ void zjs_init_callbacks(void)
         memset(cb_map, 0, size);
     }
 #ifdef ZJS_LINUX_BUILD
-    zjs_port_ring_buf_init(&ring_buffer, ZJS_CALLBACK_BUF_SIZE,
-                           (uint32_t*)args_buffer);
+    if (!args_buffer) {
+        args_buffer = zjs_malloc(cb_buf_size);
+        if (!args_buffer) {
+            ERR_PRINT("error allocating %lu byte callback buffer\n",
+                      (unsigned long)cb_buf_size);
+            ring_buf_initialized = 0;
+            return;
+        }
+    }
+    zjs_port_ring_buf_init(&ring_buffer, cb_buf_size, (uint32_t*)args_buffer);
 #endif
     ring_buf_initialized = 1;
     return;
 }
 
+#ifdef ZJS_LINUX_BUILD
+void zjs_set_callback_limits(uint32_t buf_size, uint16_t max_iter)
+{
+    // requires: buf_size is a power of 2, called before zjs_init_callbacks
+    if (buf_size) {
+        cb_buf_size = buf_size;
+    }
+    if (max_iter) {
+        cb_loop_max = max_iter;
+    }
+}
+#endif
+
+#ifdef ZJS_WATCHDOG
+void zjs_set_callback_source(zjs_callback_id id, const char *kind,
+                             const char *name)
+{
+    if (id != -1 && cb_map[id]) {
+        cb_map[id]->source_kind = kind;
+        cb_map[id]->source_name[0] = '\0';
+        if (name) {
+            strncpy(cb_map[id]->source_name, name, CB_SOURCE_NAME_SIZE - 1);
+            cb_map[id]->source_name[CB_SOURCE_NAME_SIZE - 1] = '\0';
+        }
+    }
+}
+#endif
+
 bool zjs_edit_js_func(zjs_callback_id id, jerry_value_t func)
 {
     if (id != -1 && cb_map[id]) {
@@ -158,19 +241,54 @@ bool zjs_edit_callback_handle(zjs_callback_id id, void* handle)
     }
 }
 
+static void remove_list_entry(zjs_callback_t *cb, int pos)
+{
+    // effects: marks the function in slot pos removed; it is released right
+    //            away unless a dispatch is walking the list, and an end slot
+    //            is given back, otherwise the slot waits for compact_list
+    cb_list_entry_t *entry = &cb->func_list[pos];
+    entry->flags |= CB_LIST_REMOVED;
+    cb->num_funcs--;
+    if (cb->depth) {
+        return;
+    }
+    jerry_release_value(entry->func);
+    entry->func = 0;
+    if (pos == cb->first + cb->used - 1) {
+        cb->used--;
+    } else if (pos == cb->first) {
+        cb->first++;
+        cb->used--;
+    }
+}
+
+static void compact_list(zjs_callback_t *cb)
+{
+    // requires: no dispatch is walking the list
+    //  effects: releases removed functions and moves the rest to the start
+    uint32_t n = 0;
+    for (int i = cb->first; i < cb->first + cb->used; ++i) {
+        cb_list_entry_t *entry = &cb->func_list[i];
+        if (entry->flags & CB_LIST_REMOVED) {
+            if (entry->func) {
+                jerry_release_value(entry->func);
+            }
+        } else {
+            cb->func_list[n++] = *entry;
+        }
+    }
+    cb->first = 0;
+    cb->used = n;
+}
+
 bool zjs_remove_callback_list_func(zjs_callback_id id, jerry_value_t js_func)
 {
-    if (id != -1 && cb_map[id]) {
-        int i;
-        for (i = 0; i < cb_map[id]->num_funcs; ++i) {
-            if (js_func == cb_map[id]->func_list[i]) {
-                int j;
-                jerry_release_value(cb_map[id]->func_list[i]);
-                for (j = i; j < cb_map[id]->num_funcs - 1; ++j) {
-                    cb_map[id]->func_list[j] = cb_map[id]->func_list[j + 1];
-                }
-                cb_map[id]->num_funcs--;
-                cb_map[id]->func_list[cb_map[id]->num_funcs] = 0;
+    if (id != -1 && cb_map[id] && cb_map[id]->func_list) {
+        zjs_callback_t *cb = cb_map[id];
+        for (int i = cb->first; i < cb->first + cb->used; ++i) {
+            if (js_func == cb->func_list[i].func &&
+                !(cb->func_list[i].flags & CB_LIST_REMOVED)) {
+                remove_list_entry(cb, i);
                 return true;
             }
         }
@@ -179,6 +297,18 @@ bool zjs_remove_callback_list_func(zjs_callback_id id, jerry_value_t js_func)
     return false;
 }
 
+bool zjs_callback_exists(zjs_callback_id id, bool *is_js)
+{
+    if (id < 0 || id >= cb_size || !cb_map[id] ||
+        GET_CB_REMOVED(cb_map[id]->flags)) {
+        return false;
+    }
+    if (is_js) {
+        *is_js = GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS;
+    }
+    return true;
+}
+
 int zjs_get_num_callbacks(zjs_callback_id id)
 {
     if (id != -1 && cb_map[id]) {
@@ -187,15 +317,23 @@ int zjs_get_num_callbacks(zjs_callback_id id)
     return 0;
 }
 
-jerry_value_t* zjs_get_callback_func_list(zjs_callback_id id, int* count)
+jerry_value_t zjs_get_callback_funcs(zjs_callback_id id)
 {
-    if (id != -1) {
-        if (cb_map[id]) {
-            *count = cb_map[id]->num_funcs;
-            return cb_map[id]->func_list;
+    zjs_callback_t *cb = NULL;
+    if (id != -1 && cb_map[id] && cb_map[id]->func_list) {
+        cb = cb_map[id];
+    }
+
+    jerry_value_t array = jerry_create_array(cb ? cb->num_funcs : 0);
+    if (cb) {
+        uint32_t n = 0;
+        for (int i = cb->first; i < cb->first + cb->used; ++i) {
+            if (!(cb->func_list[i].flags & CB_LIST_REMOVED)) {
+                jerry_set_property_by_index(array, n++, cb->func_list[i].func);
+            }
         }
     }
-    return NULL;
+    return array;
 }
 
 zjs_callback_id zjs_add_callback_list(jerry_value_t js_func,
@@ -204,26 +342,97 @@ zjs_callback_id zjs_add_callback_list(jerry_value_t js_func,
                                       zjs_post_callback_func post,
                                       zjs_callback_id id)
 {
-    if (id != -1) {
-        if (cb_map[id] && cb_map[id]->func_list) {
-            // The function list is full, allocate more space, copy the existing
-            // list, and add the new function
-            if (cb_map[id]->num_funcs == cb_map[id]->max_funcs - 1) {
-                int i;
-                jerry_value_t* new_list = zjs_malloc((sizeof(jerry_value_t) *
-                        (cb_map[id]->max_funcs + CB_LIST_MULTIPLIER)));
-                for (i = 0; i < cb_map[id]->num_funcs; ++i) {
-                    new_list[i] = cb_map[id]->func_list[i];
-                }
-                new_list[cb_map[id]->num_funcs] = jerry_acquire_value(js_func);
+    return zjs_add_callback_list_flags(js_func, this, handle, post, id, 0);
+}
+
+static bool move_list(zjs_callback_t *cb, uint32_t max, uint32_t first)
+{
+    // requires: cb->used <= max - first
+    //  effects: moves the used slots to start at first, in a new list if max
+    //             differs from the capacity; returns false if out of memory
+    cb_list_entry_t *list = cb->func_list;
+    if (max != cb->max_funcs) {
+        list = zjs_malloc(sizeof(cb_list_entry_t) * max);
+        if (!list) {
+            return false;
+        }
+    }
+    if (cb->used) {
+        memmove(&list[first], &cb->func_list[cb->first],
+                sizeof(cb_list_entry_t) * cb->used);
+    }
+    if (list != cb->func_list) {
+        zjs_free(cb->func_list);
+        cb->func_list = list;
+        cb->max_funcs = max;
+    }
+    // tells dispatches walking the list where their next slot went
+    cb->shift += first - cb->first;
+    cb->first = first;
+    return true;
+}
 
-                cb_map[id]->max_funcs += CB_LIST_MULTIPLIER;
-                zjs_free(cb_map[id]->func_list);
-                cb_map[id]->func_list = new_list;
+static bool add_list_entry(zjs_callback_t *cb, jerry_value_t js_func,
+                           uint8_t flags)
+{
+    // effects: adds js_func to the end of the list, or the start with
+    //            ZJS_CB_LIST_PREPEND; when that end has no free slot the list
+    //            is compacted and moved so the free slots are at the end, or
+    //            split between both ends for a prepend, doubling the
+    //            capacity when too few are free, so adding and removing is
+    //            O(1) amortized and a list that grows to n functions
+    //            allocates O(log n) times
+    bool prepend = flags & ZJS_CB_LIST_PREPEND;
+    if (prepend ? !cb->first : cb->first + cb->used == cb->max_funcs) {
+        if (!cb->depth) {
+            compact_list(cb);
+        }
+        uint32_t max = cb->max_funcs;
+        uint32_t spare = max - cb->used;
+        if (!spare || (prepend && spare <= cb->used / 2)) {
+            if (max == CB_LIST_MAX_FUNCS) {
+                if (!spare) {
+                    ERR_PRINT("callback list is full\n");
+                    return false;
+                }
             } else {
-                // Add function to list
-                cb_map[id]->func_list[cb_map[id]->num_funcs] =
-                        jerry_acquire_value(js_func);
+                max = max ? max * 2 : CB_LIST_MULTIPLIER;
+                if (max > CB_LIST_MAX_FUNCS) {
+                    max = CB_LIST_MAX_FUNCS;
+                }
+            }
+        }
+        uint32_t first = prepend ? (max - cb->used + 1) / 2 : 0;
+        if (!move_list(cb, max, first)) {
+            ERR_PRINT("could not grow function list\n");
+            return false;
+        }
+    }
+
+    cb_list_entry_t *entry;
+    if (prepend) {
+        entry = &cb->func_list[--cb->first];
+    } else {
+        entry = &cb->func_list[cb->first + cb->used];
+    }
+    entry->func = jerry_acquire_value(js_func);
+    entry->flags = flags & ZJS_CB_LIST_ONCE;
+    cb->used++;
+    cb->num_funcs++;
+    return true;
+}
+
+zjs_callback_id zjs_add_callback_list_flags(jerry_value_t js_func,
+                                            jerry_value_t this,
+                                            void* handle,
+                                            zjs_post_callback_func post,
+                                            zjs_callback_id id,
+                                            uint8_t flags)
+{
+    if (id != -1) {
+        if (cb_map[id] && cb_map[id]->func_list) {
+            if (!add_list_entry(cb_map[id], js_func, flags)) {
+                return -1;
             }
             // If not already set, set the handle/pre/post provided. These will
             // only be set once, when the list is created.
@@ -233,7 +442,6 @@ zjs_callback_id zjs_add_callback_list(jerry_value_t js_func,
             if (!cb_map[id]->post) {
                 cb_map[id]->post = post;
             }
-            cb_map[id]->num_funcs++;
             return cb_map[id]->id;
         } else {
             DBG_PRINT("list handle was NULL\n");
@@ -250,18 +458,14 @@ zjs_callback_id zjs_add_callback_list(jerry_value_t js_func,
         SET_ONCE(new_cb->flags, 0);
         SET_TYPE(new_cb->flags, CALLBACK_TYPE_JS);
         SET_JS_TYPE(new_cb->flags, JS_TYPE_LIST);
+        if (!add_list_entry(new_cb, js_func, flags)) {
+            zjs_free(new_cb);
+            return -1;
+        }
         new_cb->id = new_id();
         new_cb->this = jerry_acquire_value(this);
         new_cb->post = post;
         new_cb->handle = handle;
-        new_cb->max_funcs = CB_LIST_MULTIPLIER;
-        new_cb->num_funcs = 1;
-        new_cb->func_list = zjs_malloc(sizeof(jerry_value_t) * CB_LIST_MULTIPLIER);
-        if (!new_cb->func_list) {
-            DBG_PRINT("could not allocate function list\n");
-            return -1;
-        }
-        new_cb->func_list[0] = jerry_acquire_value(js_func);
         cb_map[new_cb->id] = new_cb;
         if (new_cb->id >= cb_size - 1) {
             cb_size++;
@@ -337,16 +541,24 @@ static void zjs_remove_callback_priv(zjs_callback_id id, bool skip_flush)
     //            assumes the callback will be "flushed" elsewhere, that is
     //            freed and the id reclaimed; otherwise, tries to do it here
     if (id != -1 && cb_map[id]) {
+        if (cb_map[id]->depth) {
+            // a dispatch is walking the list; call_callback finishes the
+            //   removal when the last one returns
+            SET_CB_REMOVED(cb_map[id]->flags);
+            return;
+        }
         if (GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS) {
             if (GET_JS_TYPE(cb_map[id]->flags) == JS_TYPE_SINGLE) {
                 jerry_release_value(cb_map[id]->js_func);
             } else if (GET_JS_TYPE(cb_map[id]->flags) == JS_TYPE_LIST &&
                        cb_map[id]->func_list) {
-                int i;
-                for (i = 0; i < cb_map[id]->num_funcs; ++i) {
-                    jerry_release_value(cb_map[id]->func_list[i]);
+                zjs_callback_t *cb = cb_map[id];
+                for (int i = cb->first; i < cb->first + cb->used; ++i) {
+                    if (cb->func_list[i].func) {
+                        jerry_release_value(cb->func_list[i].func);
+                    }
                 }
-                zjs_free(cb_map[id]->func_list);
+                zjs_free(cb->func_list);
             }
             jerry_release_value(cb_map[id]->this);
         }
@@ -383,11 +595,24 @@ void zjs_remove_all_callbacks()
 }
 
 // INTERRUPT SAFE FUNCTION: No JerryScript VM, allocs, or release prints!
-void zjs_signal_callback(zjs_callback_id id, const void *args, uint32_t size)
+static int put_signal(zjs_callback_id id, const void *args, uint32_t size,
+                      const uint32_t *record, uint8_t words, uint8_t value)
 {
+    // requires: record holds args, plus any trailer given by value, in words
+    //  effects: queues a signal of callback id with args; returns 0 on
+    //             success, or the ring buffer error
     DBG_PRINT("pushing item to ring buffer. id=%d, args=%p, size=%lu\n", id,
               args, size);
 
+#ifdef ZJS_RECORD
+    // C callbacks are signaled by drivers and interrupts, JS callbacks count
+    //   as inputs only when JS isn't the one signaling them
+    bool is_js = GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS;
+    if (!is_js || !dispatch_depth) {
+        zjs_record_signal(id, is_js, args, size);
+    }
+#endif
+
     if (GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS) {
         // for JS, acquire values and release them after servicing callback
         int argc = size / sizeof(jerry_value_t);
@@ -398,9 +623,9 @@ void zjs_signal_callback(zjs_callback_id id, const void *args, uint32_t size)
     }
     int ret = zjs_port_ring_buf_put(&ring_buffer,
                                     (uint16_t)id,
-                                    0,  // we use value for CB_FLUSH_ONE/ALL
-                                    (uint32_t*)args,
-                                    (uint8_t)((size + 3) / 4));
+                                    value,
+                                    (uint32_t *)record,
+                                    words);
     if (ret != 0) {
         if (GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS) {
             // for JS, acquire values and release them after servicing callback
@@ -414,6 +639,41 @@ void zjs_signal_callback(zjs_callback_id id, const void *args, uint32_t size)
         zjs_ringbuf_error_count++;
         zjs_ringbuf_last_error = ret;
     }
+    return ret;
+}
+
+// INTERRUPT SAFE FUNCTION: No JerryScript VM, allocs, or release prints!
+void zjs_signal_callback(zjs_callback_id id, const void *args, uint32_t size)
+{
+    // value 0 is a plain signal, the others are used for CB_FLUSH_ONE/ALL and
+    //   CB_SIGNAL_POST
+    put_signal(id, args, size, (const uint32_t *)args,
+               (uint8_t)((size + 3) / 4), 0);
+}
+
+bool zjs_signal_callback_post(zjs_callback_id id, const void *args,
+                              uint32_t size, zjs_signal_post_func post,
+                              void *handle)
+{
+    // the post hook rides in the ring buffer after the args, so pending
+    //   signals of the same callback each keep their own
+    uint32_t words = (size + 3) / 4;
+    uint32_t record[words + SIGNAL_POST_WORDS];
+    signal_post_t trailer = { post, handle };
+    if (size) {
+        memcpy(record, args, size);
+    }
+    memcpy(record + words, &trailer, sizeof(signal_post_t));
+
+    if (put_signal(id, args, size, record, words + SIGNAL_POST_WORDS,
+                   CB_SIGNAL_POST)) {
+        // the signal is lost, but let the caller release what it passed
+        if (post) {
+            post(handle);
+        }
+        return false;
+    }
+    return true;
 }
 
 zjs_callback_id zjs_add_c_callback(void* handle, zjs_c_callback_func callback)
@@ -469,8 +729,11 @@ void print_callbacks(void)
 #define print_callbacks() do {} while (0)
 #endif
 
-void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
+static void call_callback(zjs_callback_id id, void *data, uint32_t sz,
+                          zjs_signal_post_func post, void *handle)
 {
+    // effects: calls callback id with the args in data, then post with handle
+    //            if given, even if the callback no longer exists
     if (id == -1 || id > cb_size || !cb_map[id]) {
         ERR_PRINT("callback %d does not exist\n", id);
     }
@@ -478,11 +741,21 @@ void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
         DBG_PRINT("callback %d has already been removed\n", id);
     }
     else {
+#ifdef ZJS_WATCHDOG
+        const char *kind = cb_map[id]->source_kind;
+        if (!kind) {
+            kind = GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS ? "js" : "c";
+        }
+        zjs_watchdog_enter(id, kind, cb_map[id]->source_name);
+#endif
+#ifdef ZJS_RECORD
+        dispatch_depth++;
+#endif
         if (GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS) {
             // Function list callback
             int i;
             jerry_value_t *values = (jerry_value_t *)data;
-            jerry_value_t ret_val;
+            jerry_value_t ret_val = ZJS_UNDEFINED;
             if (GET_JS_TYPE(cb_map[id]->flags) == JS_TYPE_SINGLE) {
                 ret_val = jerry_call_function(cb_map[id]->js_func,
                                               cb_map[id]->this, values, sz);
@@ -491,14 +764,46 @@ void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
                 }
                 jerry_release_value(ret_val);
             } else if (GET_JS_TYPE(cb_map[id]->flags) == JS_TYPE_LIST) {
-                for (i = 0; i < cb_map[id]->num_funcs; ++i) {
-                    ret_val = jerry_call_function(cb_map[id]->func_list[i],
-                                                  cb_map[id]->this, values, sz);
+                // call the functions in the slots used at the start; while
+                //   depth is set, removal only marks slots and removing the
+                //   callback waits, so nothing is released under the loop,
+                //   and functions added by the calls are not called
+                zjs_callback_t *cb = cb_map[id];
+                uint8_t shift = cb->shift;
+                int end = cb->first + cb->used;
+                cb->depth++;
+                for (i = cb->first; i < end; ++i) {
+                    if (GET_CB_REMOVED(cb->flags)) {
+                        break;
+                    }
+                    // a prepend may have moved the list
+                    int8_t moved = cb->shift - shift;
+                    shift = cb->shift;
+                    i += moved;
+                    end += moved;
+                    cb_list_entry_t *entry = &cb->func_list[i];
+                    if (entry->flags & CB_LIST_REMOVED) {
+                        continue;
+                    }
+                    if (entry->flags & ZJS_CB_LIST_ONCE) {
+                        // once functions are removed before they are called
+                        remove_list_entry(cb, i);
+                    }
+                    ret_val = jerry_call_function(entry->func, cb->this,
+                                                  values, sz);
                     if (jerry_value_has_error_flag(ret_val)) {
                         zjs_print_error_message(ret_val);
                     }
                     jerry_release_value(ret_val);
                 }
+                if (!--cb->depth) {
+                    if (GET_CB_REMOVED(cb->flags)) {
+                        CLEAR_CB_REMOVED(cb->flags);
+                        zjs_remove_callback_priv(id, false);
+                    } else if (cb->used != cb->num_funcs) {
+                        compact_list(cb);
+                    }
+                }
             }
 
             // ensure the callback wasn't deleted by the previous calls
@@ -506,7 +811,8 @@ void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
                 if (cb_map[id]->post) {
                     cb_map[id]->post(cb_map[id]->handle, &ret_val);
                 }
-                if (GET_ONCE(cb_map[id]->flags)) {
+                if (GET_ONCE(cb_map[id]->flags) &&
+                    !GET_CB_REMOVED(cb_map[id]->flags)) {
                     zjs_remove_callback_priv(id, false);
                 }
             }
@@ -514,9 +820,30 @@ void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
                    cb_map[id]->function) {
             cb_map[id]->function(cb_map[id]->handle, data);
         }
+#ifdef ZJS_RECORD
+        dispatch_depth--;
+#endif
+#ifdef ZJS_WATCHDOG
+        zjs_watchdog_leave();
+#endif
+    }
+
+    if (post) {
+        post(handle);
     }
 }
 
+void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz)
+{
+    call_callback(id, data, sz, NULL, NULL);
+}
+
+void zjs_call_callback_post(zjs_callback_id id, void *data, uint32_t sz,
+                            zjs_signal_post_func post, void *handle)
+{
+    call_callback(id, data, sz, post, handle);
+}
+
 uint8_t zjs_service_callbacks(void)
 {
     if (zjs_ringbuf_error_count > zjs_ringbuf_error_max) {
@@ -533,7 +860,7 @@ uint8_t zjs_service_callbacks(void)
         uint32_t num_callbacks = 0;
 #endif
         uint16_t count = 0;
-        while (count++ < ZJS_MAX_CB_LOOP_ITERATION) {
+        while (count++ < cb_loop_max) {
             int ret;
             uint16_t id;
             uint8_t value;
@@ -561,9 +888,14 @@ uint8_t zjs_service_callbacks(void)
                         ERR_PRINT("pulling from ring buffer: ret = %u\n", ret);
                         break;
                     }
+                    signal_post_t trailer = { NULL, NULL };
+                    if (value == CB_SIGNAL_POST) {
+                        sz -= SIGNAL_POST_WORDS;
+                        memcpy(&trailer, data + sz, sizeof(signal_post_t));
+                    }
                     DBG_PRINT("calling callback with args. id=%u, args=%p, sz=%u, ret=%i\n", id, data, sz, ret);
                     bool is_js = GET_TYPE(cb_map[id]->flags) == CALLBACK_TYPE_JS;
-                    zjs_call_callback(id, data, sz);
+                    call_callback(id, data, sz, trailer.post, trailer.handle);
                     if (is_js) {
                         for (int i = 0; i < sz; i++)
                             jerry_release_value(data[i]);
@@ -611,7 +943,7 @@ uint8_t zjs_service_callbacks(void)
             PRINT("[cb stats] Number of Callbacks (this service): %lu\n",
                   num_callbacks);
             PRINT("[cb stats] Max Callbacks Per Service: %u\n",
-                  ZJS_MAX_CB_LOOP_ITERATION);
+                  cb_loop_max);
             PRINT("------------- End ----------------\n");
         }
 #endif
@@ -7,6 +7,10 @@
 
 typedef int16_t zjs_callback_id;
 
+// flags for zjs_add_callback_list_flags()
+#define ZJS_CB_LIST_ONCE        0x01    // remove the function when called
+#define ZJS_CB_LIST_PREPEND     0x02    // add the function first in the list
+
 /*
  * Function that will be called BEFORE the JS function is called.
  * This should return an array of jerry_value_t's that contain
@@ -30,6 +34,14 @@ typedef jerry_value_t* (*zjs_pre_callback_func)(void* handle, uint32_t* argc);
  */
 typedef void (*zjs_post_callback_func)(void* handle, jerry_value_t* ret_val);
 
+/*
+ * Function that will be called after one particular signal of a JS callback
+ * has been serviced, given to zjs_signal_callback_post().
+ *
+ * @param handle        Handle given with the signal
+ */
+typedef void (*zjs_signal_post_func)(void* handle);
+
 /*
  * Function definition for a C callback
  *
@@ -42,6 +54,45 @@ typedef void (*zjs_c_callback_func)(void* handle, void* args);
  */
 void zjs_init_callbacks(void);
 
+#ifdef ZJS_LINUX_BUILD
+/*
+ * Override the compile time callback limits (Linux only). This must be called
+ * before zjs_init_callbacks().
+ *
+ * @param buf_size      Size of the callback ring buffer in bytes, must be a
+ *                        power of 2 (0 keeps ZJS_CALLBACK_BUF_SIZE)
+ * @param max_iter      Max callbacks serviced per zjs_service_callbacks()
+ *                        call (0 keeps ZJS_MAX_CB_LOOP_ITERATION)
+ */
+void zjs_set_callback_limits(uint32_t buf_size, uint16_t max_iter);
+#endif
+
+#ifdef ZJS_WATCHDOG
+/*
+ * Describe where a callback comes from, so that the stall watchdog can report
+ * which source blocked the event loop.
+ *
+ * @param id            ID of callback
+ * @param kind          Kind of source, e.g. "timer", must be a static string
+ * @param name          Name within that kind, e.g. an event name; copied and
+ *                        truncated, may be NULL
+ */
+void zjs_set_callback_source(zjs_callback_id id, const char *kind,
+                             const char *name);
+#else
+#define zjs_set_callback_source(id, kind, name) do {} while (0)
+#endif
+
+/*
+ * Check whether a callback is registered and not removed
+ *
+ * @param id            ID of callback
+ * @param is_js[out]    Set to true for a JS callback, false for C (optional)
+ *
+ * @return              True if the callback exists
+ */
+bool zjs_callback_exists(zjs_callback_id id, bool *is_js);
+
 /*
  * Get the number of callback functions registered to this ID
  *
@@ -52,14 +103,13 @@ void zjs_init_callbacks(void);
 int zjs_get_num_callbacks(zjs_callback_id id);
 
 /*
- * Get the list of callback functions in a callback list
+ * Get the functions in a callback list, in the order they will be called
  *
  * @param id            ID of callback list
- * @param count         Number of functions
  *
- * @return              Array of functions
+ * @return              New JS array of functions, empty if id isn't a list
  */
-jerry_value_t* zjs_get_callback_func_list(zjs_callback_id id, int* count);
+jerry_value_t zjs_get_callback_funcs(zjs_callback_id id);
 
 /*
  * Remove a function from a list of callbacks
@@ -89,6 +139,30 @@ zjs_callback_id zjs_add_callback_list(jerry_value_t js_func,
                                       zjs_post_callback_func post,
                                       zjs_callback_id id);
 
+/*
+ * Create/add a function to a callback list like zjs_add_callback_list(), with
+ * ZJS_CB_LIST_* flags. A ZJS_CB_LIST_ONCE function is removed from the list
+ * just before it is called. The list's capacity doubles as it grows and isn't
+ * given back until the callback is removed, so adding and removing functions
+ * repeatedly doesn't allocate. While the list is being called, a function
+ * removed before its turn is skipped and one added is first called next time.
+ *
+ * @param js_func       JS function to be added to the callback list
+ * @param handle        Module specific handle, given to pre/post
+ * @param post          Function called after the JS function (explained above)
+ * @param id            ID for this callback list (-1 if its a new list)
+ * @param flags         ZJS_CB_LIST_ONCE and/or ZJS_CB_LIST_PREPEND
+ *
+ * @return              New callback ID for this list (or existing ID), or -1
+ *                        if out of memory or the list is full
+ */
+zjs_callback_id zjs_add_callback_list_flags(jerry_value_t js_func,
+                                            jerry_value_t this,
+                                            void* handle,
+                                            zjs_post_callback_func post,
+                                            zjs_callback_id id,
+                                            uint8_t flags);
+
 /*
  * Add/register a callback function
  *
@@ -175,6 +249,27 @@ void zjs_remove_all_callbacks();
  */
 void zjs_signal_callback(zjs_callback_id id, const void *args, uint32_t size);
 
+/*
+ * Signal a JS callback like zjs_signal_callback(), and call post with handle
+ * once the callback has been serviced for this signal. The hook is queued with
+ * the signal rather than stored on the callback, so signaling the same
+ * callback again before it is serviced doesn't replace it, and no memory is
+ * allocated. Post is called even if the callback is removed in the meantime.
+ * Not interrupt safe.
+ *
+ * @param id            ID returned from zjs_add_callback
+ * @param args          Arguments given to the JS callback
+ * @param size          Size of arguments (in bytes)
+ * @param post          Function called after the callback, or NULL
+ * @param handle        Handle given to post
+ *
+ * @return              True if the signal was queued; if not, post has
+ *                        already been called
+ */
+bool zjs_signal_callback_post(zjs_callback_id id, const void *args,
+                              uint32_t size, zjs_signal_post_func post,
+                              void *handle);
+
 /*
  * Add/register a C callback
  *
@@ -197,6 +292,19 @@ zjs_callback_id zjs_add_c_callback(void* handle, zjs_c_callback_func callback);
  */
 void zjs_call_callback(zjs_callback_id id, void* data, uint32_t sz);
 
+/*
+ * Call a JS callback immediately like zjs_call_callback(), then call post with
+ * handle.
+ *
+ * @param id            ID of callback
+ * @param data          Callback arguments
+ * @param sz            Number of arguments in data
+ * @param post          Function called after the callback, or NULL
+ * @param handle        Handle given to post
+ */
+void zjs_call_callback_post(zjs_callback_id id, void *data, uint32_t sz,
+                            zjs_signal_post_func post, void *handle);
+
 /*
  * Service the callback module. Any callback's that have been signaled will
  * be serviced and the signal flag will be unset.
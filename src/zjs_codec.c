@@ -0,0 +1,287 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#include <string.h>
+
+// ZJS includes
+#include "zjs_codec.h"
+
+#define INVALID                 0xff
+#define REPLACEMENT_CHAR        0xfffd
+#define INVALID_CHAR            UINT32_MAX
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static const char base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// value of each hex digit, or INVALID
+static const uint8_t hex_values[256] = {
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    0x00,    0x01,    0x02,    0x03,    0x04,    0x05,    0x06,    0x07,
+    0x08,    0x09,    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, 0x0a,    0x0b,    0x0c,    0x0d,    0x0e,    0x0f,    INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, 0x0a,    0x0b,    0x0c,    0x0d,    0x0e,    0x0f,    INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID
+};
+
+// value of each base64 char in the standard or URL-safe alphabet, or INVALID
+static const uint8_t base64_values[256] = {
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, 0x3e,    INVALID, 0x3e,    INVALID, 0x3f,
+    0x34,    0x35,    0x36,    0x37,    0x38,    0x39,    0x3a,    0x3b,
+    0x3c,    0x3d,    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, 0x00,    0x01,    0x02,    0x03,    0x04,    0x05,    0x06,
+    0x07,    0x08,    0x09,    0x0a,    0x0b,    0x0c,    0x0d,    0x0e,
+    0x0f,    0x10,    0x11,    0x12,    0x13,    0x14,    0x15,    0x16,
+    0x17,    0x18,    0x19,    INVALID, INVALID, INVALID, INVALID, 0x3f,
+    INVALID, 0x1a,    0x1b,    0x1c,    0x1d,    0x1e,    0x1f,    0x20,
+    0x21,    0x22,    0x23,    0x24,    0x25,    0x26,    0x27,    0x28,
+    0x29,    0x2a,    0x2b,    0x2c,    0x2d,    0x2e,    0x2f,    0x30,
+    0x31,    0x32,    0x33,    INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
+    INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID
+};
+
+// length of the UTF-8 sequence each lead byte starts, 0 if it can't lead one
+static const uint8_t utf8_lengths[256] = {
+    [0x00 ... 0x7f] = 1,
+    [0xc2 ... 0xdf] = 2,
+    [0xe0 ... 0xef] = 3,
+    [0xf0 ... 0xf4] = 4
+};
+
+// smallest code point for each sequence length, anything less is overlong
+static const uint32_t utf8_min[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+void zjs_hex_encode(const uint8_t *src, uint32_t len, char *dst)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        *dst++ = hex_digits[src[i] >> 4];
+        *dst++ = hex_digits[src[i] & 0xf];
+    }
+}
+
+int32_t zjs_hex_decode(const char *src, uint32_t len, uint8_t *dst)
+{
+    if (len & 1)
+        return -1;
+
+    const uint8_t *in = (const uint8_t *)src;
+    for (uint32_t i = 0; i < len / 2; i++, in += 2) {
+        uint8_t high = hex_values[in[0]];
+        uint8_t low = hex_values[in[1]];
+        // valid values are all under 16, so one test catches either
+        if ((high | low) & 0xf0)
+            return -1;
+        dst[i] = high << 4 | low;
+    }
+    return len / 2;
+}
+
+void zjs_base64_encode(const uint8_t *src, uint32_t len, char *dst)
+{
+    for (; len >= 3; len -= 3, src += 3) {
+        uint32_t bits = src[0] << 16 | src[1] << 8 | src[2];
+        *dst++ = base64_alphabet[bits >> 18];
+        *dst++ = base64_alphabet[(bits >> 12) & 0x3f];
+        *dst++ = base64_alphabet[(bits >> 6) & 0x3f];
+        *dst++ = base64_alphabet[bits & 0x3f];
+    }
+
+    if (len) {
+        uint32_t bits = src[0] << 16;
+        if (len == 2)
+            bits |= src[1] << 8;
+        *dst++ = base64_alphabet[bits >> 18];
+        *dst++ = base64_alphabet[(bits >> 12) & 0x3f];
+        *dst++ = len == 2 ? base64_alphabet[(bits >> 6) & 0x3f] : '=';
+        *dst++ = '=';
+    }
+}
+
+static uint32_t base64_strip_padding(const char *src, uint32_t len)
+{
+    for (int i = 0; i < 2 && len && src[len - 1] == '='; i++) {
+        len--;
+    }
+    return len;
+}
+
+uint32_t zjs_base64_decoded_size(const char *src, uint32_t len)
+{
+    len = base64_strip_padding(src, len);
+    uint32_t tail = len % 4;
+    return len / 4 * 3 + (tail ? tail - 1 : 0);
+}
+
+int32_t zjs_base64_decode(const char *src, uint32_t len, uint8_t *dst)
+{
+    len = base64_strip_padding(src, len);
+    if (len % 4 == 1)
+        return -1;
+
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = dst;
+    for (; len >= 4; len -= 4, in += 4) {
+        uint8_t a = base64_values[in[0]];
+        uint8_t b = base64_values[in[1]];
+        uint8_t c = base64_values[in[2]];
+        uint8_t d = base64_values[in[3]];
+        // valid values are all under 64, so one test catches any invalid char
+        if ((a | b | c | d) & 0xc0)
+            return -1;
+        uint32_t bits = a << 18 | b << 12 | c << 6 | d;
+        *out++ = bits >> 16;
+        *out++ = bits >> 8;
+        *out++ = bits;
+    }
+
+    if (len) {
+        uint8_t a = base64_values[in[0]];
+        uint8_t b = base64_values[in[1]];
+        uint8_t c = len == 3 ? base64_values[in[2]] : 0;
+        if ((a | b | c) & 0xc0)
+            return -1;
+        uint32_t bits = a << 18 | b << 12 | c << 6;
+        *out++ = bits >> 16;
+        if (len == 3)
+            *out++ = bits >> 8;
+    }
+    return out - dst;
+}
+
+static uint32_t utf8_next(const uint8_t *src, uint32_t len, uint32_t *cp)
+{
+    // requires: len > 0
+    //  effects: decodes the sequence at src into *cp, or sets it to
+    //             INVALID_CHAR if the sequence is invalid; surrogates are
+    //             accepted since JerryScript itself writes them; returns the
+    //             number of bytes consumed
+    uint8_t n = utf8_lengths[src[0]];
+    if (n == 1) {
+        *cp = src[0];
+        return 1;
+    }
+    *cp = INVALID_CHAR;
+    if (!n)
+        return 1;
+
+    uint32_t c = src[0] & (0x7f >> n);
+    for (uint32_t i = 1; i < n; i++) {
+        if (i >= len || (src[i] & 0xc0) != 0x80)
+            return i;
+        c = c << 6 | (src[i] & 0x3f);
+    }
+    if (c >= utf8_min[n] && c <= 0x10ffff)
+        *cp = c;
+    return n;
+}
+
+bool zjs_utf8_is_cesu8(const uint8_t *src, uint32_t len)
+{
+    uint32_t i = 0;
+    while (i < len) {
+        if (src[i] < 0x80) {
+            i++;
+            continue;
+        }
+        uint32_t cp;
+        i += utf8_next(src + i, len - i, &cp);
+        if (cp == INVALID_CHAR || cp >= 0x10000)
+            return false;
+    }
+    return true;
+}
+
+static uint32_t cesu8_put(uint8_t *dst, uint32_t cp)
+{
+    // requires: cp < 0x10000
+    if (dst) {
+        dst[0] = 0xe0 | cp >> 12;
+        dst[1] = 0x80 | ((cp >> 6) & 0x3f);
+        dst[2] = 0x80 | (cp & 0x3f);
+    }
+    return 3;
+}
+
+uint32_t zjs_utf8_to_cesu8(const uint8_t *src, uint32_t len, uint8_t *dst)
+{
+    uint32_t i = 0;
+    uint32_t out = 0;
+    while (i < len) {
+        uint32_t cp;
+        uint32_t n = utf8_next(src + i, len - i, &cp);
+        if (cp == INVALID_CHAR) {
+            out += cesu8_put(dst ? dst + out : NULL, REPLACEMENT_CHAR);
+        } else if (cp >= 0x10000) {
+            // encode as a surrogate pair, each a three byte sequence
+            cp -= 0x10000;
+            out += cesu8_put(dst ? dst + out : NULL, 0xd800 | cp >> 10);
+            out += cesu8_put(dst ? dst + out : NULL, 0xdc00 | (cp & 0x3ff));
+        } else {
+            if (dst)
+                memcpy(dst + out, src + i, n);
+            out += n;
+        }
+        i += n;
+    }
+    return out;
+}
+
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+uint16_t zjs_crc16(const uint8_t *src, uint32_t len, uint16_t crc)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (src[i] >> 4)];
+        crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (src[i] & 0x0f)];
+    }
+    return crc;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_codec_h__
+#define __zjs_codec_h__
+
+// Table-driven byte <-> text codecs for Buffer. None of these allocate; the
+//   caller sizes the output with the *_SIZE macros or size functions.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ZJS_HEX_ENCODED_SIZE(len)       ((len) * 2)
+#define ZJS_BASE64_ENCODED_SIZE(len)    (((len) + 2) / 3 * 4)
+
+/**
+ * Encode bytes as lowercase hex digits.
+ *
+ * @param src  Bytes to encode
+ * @param len  Number of bytes in src
+ * @param dst  Receives ZJS_HEX_ENCODED_SIZE(len) chars, not null-terminated
+ */
+void zjs_hex_encode(const uint8_t *src, uint32_t len, char *dst);
+
+/**
+ * Decode hex digits, in either case.
+ *
+ * @param src  Hex digits
+ * @param len  Number of chars in src
+ * @param dst  Receives len / 2 bytes
+ * @return Number of bytes written, or -1 if len is odd or a char isn't hex
+ */
+int32_t zjs_hex_decode(const char *src, uint32_t len, uint8_t *dst);
+
+/**
+ * Encode bytes as padded base64.
+ *
+ * @param src  Bytes to encode
+ * @param len  Number of bytes in src
+ * @param dst  Receives ZJS_BASE64_ENCODED_SIZE(len) chars, not null-terminated
+ */
+void zjs_base64_encode(const uint8_t *src, uint32_t len, char *dst);
+
+/**
+ * Get the number of bytes base64 text decodes to, ignoring any padding.
+ *
+ * @param src  Base64 text
+ * @param len  Number of chars in src
+ * @return Decoded size in bytes; the text may still turn out to be invalid
+ */
+uint32_t zjs_base64_decoded_size(const char *src, uint32_t len);
+
+/**
+ * Decode base64 text, accepting the standard and URL-safe alphabets, with or
+ *   without padding.
+ *
+ * @param src  Base64 text
+ * @param len  Number of chars in src
+ * @param dst  Receives zjs_base64_decoded_size(src, len) bytes
+ * @return Number of bytes written, or -1 if the text is invalid
+ */
+int32_t zjs_base64_decode(const char *src, uint32_t len, uint8_t *dst);
+
+/**
+ * Check whether bytes can be passed to JerryScript as a string unchanged:
+ *   valid UTF-8 with no characters outside the Basic Multilingual Plane,
+ *   which JerryScript stores as surrogate pairs (CESU-8).
+ *
+ * @param src  Bytes to check
+ * @param len  Number of bytes in src
+ * @return true if no conversion is needed
+ */
+bool zjs_utf8_is_cesu8(const uint8_t *src, uint32_t len);
+
+/**
+ * Convert UTF-8 to CESU-8 for JerryScript, encoding characters outside the
+ *   BMP as surrogate pairs and replacing invalid sequences with U+FFFD.
+ *
+ * @param src  UTF-8 bytes
+ * @param len  Number of bytes in src
+ * @param dst  Receives the converted bytes, or NULL to only measure them
+ * @return Number of bytes written, or that would be written
+ */
+uint32_t zjs_utf8_to_cesu8(const uint8_t *src, uint32_t len, uint8_t *dst);
+
+// starting value for zjs_crc16
+#define ZJS_CRC16_INIT  0xffff
+
+/**
+ * Compute a CRC-16/CCITT (polynomial 0x1021, MSB first, no final XOR), e.g.
+ *   zjs_crc16(data, len, ZJS_CRC16_INIT). The table is by nibble, to keep it
+ *   to 32 bytes.
+ *
+ * @param src  Bytes to checksum
+ * @param len  Number of bytes in src
+ * @param crc  ZJS_CRC16_INIT, or the result for the bytes before src
+ * @return The CRC so far
+ */
+uint16_t zjs_crc16(const uint8_t *src, uint32_t len, uint16_t crc);
+
+#endif  // __zjs_codec_h__
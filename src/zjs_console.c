@@ -2,8 +2,15 @@
 
 #ifdef BUILD_MODULE_CONSOLE
 
+#include <string.h>
+
+#ifdef ZJS_CONSOLE_BINARY
+#include "zjs_binlog.h"
+#endif
 #include "zjs_common.h"
+#include "zjs_console.h"
 #include "zjs_error.h"
+#include "zjs_modules.h"
 #include "zjs_util.h"
 #ifdef ZJS_LINUX_BUILD
 #include "zjs_linux_port.h"
@@ -25,7 +32,184 @@
 #define IS_INT    1
 #define IS_UINT   2
 
-static jerry_value_t gbl_time_obj;
+// console.time labels; an entry lives from time() to timeEnd(), or until
+//   aggregation is turned off for its label
+typedef struct console_timer {
+    uint32_t hash;
+    bool running;
+    bool aggregate;
+    uint32_t start_ms;
+    zjs_port_cycles_t start_cycles;
+    // totals for aggregate mode
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    struct console_timer *next;
+    char label[];
+} console_timer_t;
+
+static console_timer_t *console_timers = NULL;
+
+#ifdef ZJS_CONSOLE_BUFFER
+#if ZJS_CONSOLE_BUF_SIZE & (ZJS_CONSOLE_BUF_SIZE - 1)
+#error "ZJS_CONSOLE_BUF_SIZE must be a power of 2"
+#endif
+
+#define RING_MASK   (ZJS_CONSOLE_BUF_SIZE - 1)
+
+// the indices run freely and are masked on access; bytes from ring_head to
+//   ring_tail are complete lines waiting to be written out, and bytes from
+//   ring_tail to line_end are the line being formatted
+static char ring[ZJS_CONSOLE_BUF_SIZE];
+static uint32_t ring_head = 0;
+static uint32_t ring_tail = 0;
+static uint32_t line_end = 0;
+static bool line_dropped = false;
+static uint32_t dropped_lines = 0;      // not yet reported in COUNT mode
+static uint8_t overflow_policy = ZJS_CONSOLE_OVERFLOW;
+static bool service_registered = false;
+
+static void ring_drain(uint32_t len)
+{
+    // requires: len is at most line_end - ring_head
+    //  effects: writes out len bytes from the head of the ring
+    char chunk[ZJS_CONSOLE_DRAIN_SIZE + 1];
+    while (len) {
+        uint32_t count = len;
+        if (count > ZJS_CONSOLE_DRAIN_SIZE) {
+            count = ZJS_CONSOLE_DRAIN_SIZE;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            chunk[i] = ring[(ring_head + i) & RING_MASK];
+        }
+        chunk[count] = '\0';
+        fprintf(stdout, "%s", chunk);
+        ring_head += count;
+        len -= count;
+    }
+}
+
+static bool ring_write(const char *str, uint32_t len)
+{
+    // effects: appends len bytes of str to the line being formatted; if they
+    //            don't fit, applies the overflow policy and returns false if
+    //            the line was dropped
+    if (line_dropped) {
+        return false;
+    }
+    if (len > ZJS_CONSOLE_BUF_SIZE - (line_end - ring_head)) {
+        if (overflow_policy != ZJS_CONSOLE_BLOCK) {
+            line_end = ring_tail;
+            line_dropped = true;
+            dropped_lines++;
+            return false;
+        }
+        // write out everything so far, including the partial line
+        ring_tail = line_end;
+        ring_drain(ring_tail - ring_head);
+        if (len > ZJS_CONSOLE_BUF_SIZE) {
+            fprintf(stdout, "%s", str);
+            return true;
+        }
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        ring[(line_end + i) & RING_MASK] = str[i];
+    }
+    line_end += len;
+    return true;
+}
+
+static uint8_t console_service(void *handle)
+{
+    uint32_t pending = ring_tail - ring_head;
+    if (!pending) {
+        return 0;
+    }
+    if (pending > ZJS_CONSOLE_DRAIN_SIZE) {
+        pending = ZJS_CONSOLE_DRAIN_SIZE;
+    }
+    ring_drain(pending);
+    return 1;
+}
+
+static void ring_begin_line()
+{
+    if (overflow_policy == ZJS_CONSOLE_COUNT && dropped_lines) {
+        char note[40];
+        snprintf(note, sizeof(note), "[console: %lu lines dropped]\n",
+                 (unsigned long)dropped_lines);
+        if (ring_write(note, strlen(note))) {
+            ring_tail = line_end;
+            dropped_lines = 0;
+        } else {
+            // the failed note counted itself as a dropped line
+            line_dropped = false;
+            dropped_lines--;
+        }
+    }
+}
+
+static bool ring_end_line(const char *term)
+{
+    // effects: appends term and commits the line; returns false if the line
+    //            was dropped instead
+    bool committed = ring_write(term, strlen(term));
+    if (committed) {
+        ring_tail = line_end;
+    }
+    line_dropped = false;
+    return committed;
+}
+
+void zjs_console_set_overflow(enum zjs_console_overflow policy)
+{
+    overflow_policy = policy;
+}
+
+void zjs_console_flush()
+{
+    ring_drain(ring_tail - ring_head);
+#ifdef ZJS_LINUX_BUILD
+    fflush(stdout);
+#endif
+}
+#endif  // ZJS_CONSOLE_BUFFER
+
+static void console_begin(FILE *out)
+{
+#ifdef ZJS_CONSOLE_BUFFER
+    if (out == stdout) {
+        ring_begin_line();
+    } else {
+        // keep error output in order with the log lines before it
+        zjs_console_flush();
+    }
+#endif
+}
+
+static void console_puts(FILE *out, const char *str)
+{
+#ifdef ZJS_CONSOLE_BUFFER
+    if (out == stdout) {
+        ring_write(str, strlen(str));
+        return;
+    }
+#endif
+    fprintf(out, "%s", str);
+}
+
+static bool console_end(FILE *out, const char *term)
+{
+    // effects: ends the line with term; returns false if it was dropped
+#ifdef ZJS_CONSOLE_BUFFER
+    if (out == stdout) {
+        return ring_end_line(term);
+    }
+#endif
+    fprintf(out, "%s", term);
+    return true;
+}
 
 static int is_int(jerry_value_t val) {
     int ret = 0;
@@ -120,6 +304,181 @@ static bool value2str(const jerry_value_t value, char *buf, int maxlen,
     return true;
 }
 
+#ifdef ZJS_CONSOLE_BINARY
+// escaped record bytes are staged here for console_puts, which takes strings;
+//   the escaping keeps NUL out of them
+#define BIN_STAGE_SIZE  32
+
+typedef struct bin_atom {
+    uint32_t hash;
+    uint8_t len;
+    char text[ZJS_BINLOG_ATOM_SIZE];
+} bin_atom_t;
+
+static bin_atom_t bin_atoms[ZJS_BINLOG_ATOMS];
+static uint8_t bin_atom_count = 0;
+static bool bin_synced = false;         // host has the same atoms as we do
+static char bin_stage[BIN_STAGE_SIZE + 1];
+static uint8_t bin_len = 0;
+
+static void bin_flush()
+{
+    bin_stage[bin_len] = '\0';
+    console_puts(stdout, bin_stage);
+    bin_len = 0;
+}
+
+static void bin_raw(uint8_t byte)
+{
+    if (bin_len == BIN_STAGE_SIZE) {
+        bin_flush();
+    }
+    bin_stage[bin_len++] = byte;
+}
+
+static void bin_byte(uint8_t byte)
+{
+    if (ZJS_BINLOG_ESCAPED(byte)) {
+        bin_raw(ZJS_BINLOG_ESC);
+        byte ^= ZJS_BINLOG_ESC_XOR;
+    }
+    bin_raw(byte);
+}
+
+static void bin_bytes(const void *data, uint32_t len)
+{
+    const uint8_t *bytes = data;
+    for (uint32_t i = 0; i < len; i++) {
+        bin_byte(bytes[i]);
+    }
+}
+
+static void bin_varint(uint64_t num)
+{
+    while (num >= 0x80) {
+        bin_byte((num & 0x7f) | 0x80);
+        num >>= 7;
+    }
+    bin_byte(num);
+}
+
+static void bin_string(const char *str, uint32_t len)
+{
+    // effects: sends a short string by atom id, defining the atom the first
+    //            time, or inline once the atom table is full
+    if (len <= ZJS_BINLOG_ATOM_SIZE) {
+        uint32_t hash = 2166136261u;
+        for (uint32_t i = 0; i < len; i++) {
+            hash = (hash ^ (uint8_t)str[i]) * 16777619;
+        }
+        for (uint8_t id = 0; id < bin_atom_count; id++) {
+            bin_atom_t *atom = &bin_atoms[id];
+            if (atom->hash == hash && atom->len == len &&
+                !memcmp(atom->text, str, len)) {
+                bin_byte(ZJS_BINLOG_ATOM);
+                bin_varint(id);
+                return;
+            }
+        }
+        if (bin_atom_count < ZJS_BINLOG_ATOMS) {
+            bin_atom_t *atom = &bin_atoms[bin_atom_count];
+            atom->hash = hash;
+            atom->len = len;
+            memcpy(atom->text, str, len);
+            bin_byte(ZJS_BINLOG_ATOM_DEF);
+            bin_varint(bin_atom_count++);
+            bin_varint(len);
+            bin_bytes(str, len);
+            return;
+        }
+    }
+    bin_byte(ZJS_BINLOG_STRING);
+    bin_varint(len);
+    bin_bytes(str, len);
+}
+
+static void bin_value(const jerry_value_t value, bool deep)
+{
+    // effects: sends value in the form print_value would print it
+    if (jerry_value_is_array(value)) {
+        uint32_t len = jerry_get_array_length(value);
+        bin_byte(deep ? ZJS_BINLOG_ARRAY : ZJS_BINLOG_ARRAY_LONG);
+        bin_varint(len);
+        if (deep) {
+            for (uint32_t i = 0; i < len; i++) {
+                jerry_value_t element = jerry_get_property_by_index(value, i);
+                bin_value(element, false);
+                jerry_release_value(element);
+            }
+        }
+    }
+    else if (jerry_value_is_boolean(value)) {
+        bin_byte(jerry_get_boolean_value(value) ? ZJS_BINLOG_TRUE
+                                                : ZJS_BINLOG_FALSE);
+    }
+    else if (jerry_value_is_function(value)) {
+        bin_byte(ZJS_BINLOG_FUNCTION);
+    }
+    else if (jerry_value_is_number(value)) {
+        // integers up to 2^53 are exact in a double; NaN fails the range test
+        double num = jerry_get_number_value(value);
+        if (num >= -9007199254740992.0 && num <= 9007199254740992.0 &&
+            num == (double)(int64_t)num) {
+            int64_t n = (int64_t)num;
+            bin_byte(ZJS_BINLOG_INT);
+            bin_varint(((uint64_t)n << 1) ^ (uint64_t)(n >> 63));
+        } else if ((double)(float)num == num) {
+            float f = num;
+            bin_byte(ZJS_BINLOG_FLOAT);
+            bin_bytes(&f, sizeof(f));
+        } else {
+            bin_byte(ZJS_BINLOG_DOUBLE);
+            bin_bytes(&num, sizeof(num));
+        }
+    }
+    else if (jerry_value_is_null(value)) {
+        bin_byte(ZJS_BINLOG_NULL);
+    }
+    // NOTE: important that checks for function and array were above this
+    else if (jerry_value_is_object(value)) {
+        bin_byte(ZJS_BINLOG_OBJECT);
+    }
+    else if (jerry_value_is_string(value)) {
+        jerry_size_t size = jerry_get_string_size(value);
+        if (size >= MAX_STR_LENGTH) {
+            bin_byte(ZJS_BINLOG_STRING_LONG);
+            bin_varint(size);
+        } else {
+            char buffer[++size];
+            zjs_copy_jstring(value, buffer, &size);
+            bin_string(buffer, size);
+        }
+    }
+    else {
+        bin_byte(ZJS_BINLOG_UNDEFINED);
+    }
+}
+
+static void bin_log(const jerry_value_t argv[], const jerry_length_t argc)
+{
+    if (!bin_synced) {
+        bin_raw(ZJS_BINLOG_START);
+        bin_byte(ZJS_BINLOG_RESET);
+        bin_byte(ZJS_BINLOG_VERSION);
+        bin_raw(ZJS_BINLOG_END);
+        bin_atom_count = 0;
+        bin_synced = true;
+    }
+    bin_raw(ZJS_BINLOG_START);
+    bin_byte(ZJS_BINLOG_LOG);
+    for (int i = 0; i < argc; i++) {
+        bin_value(argv[i], true);
+    }
+    bin_raw(ZJS_BINLOG_END);
+    bin_flush();
+}
+#endif  // ZJS_CONSOLE_BINARY
+
 static void print_value(const jerry_value_t value, FILE *out, bool deep,
                         bool quotes)
 {
@@ -127,20 +486,20 @@ static void print_value(const jerry_value_t value, FILE *out, bool deep,
     if (!value2str(value, buf, MAX_STR_LENGTH, quotes) && deep) {
         if (jerry_value_is_array(value)) {
             uint32_t len = jerry_get_array_length(value);
-            fprintf(out, "[");
+            console_puts(out, "[");
             for (int i = 0; i < len; i++) {
                 if (i) {
-                    fprintf(out, ", ");
+                    console_puts(out, ", ");
                 }
                 jerry_value_t element = jerry_get_property_by_index(value, i);
                 print_value(element, out, false, true);
                 jerry_release_value(element);
             }
-            fprintf(out, "]");
+            console_puts(out, "]");
         }
     }
     else {
-        fprintf(out, "%s", buf);
+        console_puts(out, buf);
     }
 }
 
@@ -150,14 +509,25 @@ static jerry_value_t do_print(const jerry_value_t function_obj,
                               const jerry_length_t argc,
                               FILE* out)
 {
+    console_begin(out);
+#ifdef ZJS_CONSOLE_BINARY
+    if (out == stdout) {
+        bin_log(argv, argc);
+        if (!console_end(out, "")) {
+            // the host may have missed atoms defined in the dropped record
+            bin_synced = false;
+        }
+        return ZJS_UNDEFINED;
+    }
+#endif
     for (int i = 0; i < argc; i++) {
         if (i) {
             // insert spaces between arguments
-            fprintf(out, " ");
+            console_puts(out, " ");
         }
         print_value(argv[i], out, true, false);
     }
-    fprintf(out, "\n");
+    console_end(out, "\n");
     return ZJS_UNDEFINED;
 }
 
@@ -177,6 +547,109 @@ static jerry_value_t console_error(const jerry_value_t function_obj,
     return do_print(function_obj, this, argv, argc, stderr);
 }
 
+static console_timer_t *timer_find(const jerry_value_t label, bool create)
+{
+    // effects: returns the timer for label, or if there is none and create is
+    //            true, a new idle one; returns NULL otherwise or on failure
+    char buf[MAX_STR_LENGTH];
+    jerry_size_t len = MAX_STR_LENGTH;
+    zjs_copy_jstring(label, buf, &len);
+    if (!len && jerry_get_string_size(label)) {
+        // too long to store, or not a string
+        return NULL;
+    }
+
+    uint32_t hash = 2166136261u;
+    for (jerry_size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)buf[i]) * 16777619;
+    }
+    for (console_timer_t *t = console_timers; t; t = t->next) {
+        if (t->hash == hash && !strcmp(t->label, buf)) {
+            return t;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    console_timer_t *t = zjs_malloc(sizeof(console_timer_t) + len + 1);
+    if (!t) {
+        return NULL;
+    }
+    memset(t, 0, sizeof(console_timer_t));
+    t->hash = hash;
+    memcpy(t->label, buf, len + 1);
+    t->next = console_timers;
+    console_timers = t;
+    return t;
+}
+
+static void timer_free(console_timer_t *timer)
+{
+    for (console_timer_t **pt = &console_timers; *pt; pt = &(*pt)->next) {
+        if (*pt == timer) {
+            *pt = timer->next;
+            zjs_free(timer);
+            return;
+        }
+    }
+}
+
+static uint64_t timer_elapsed_ns(console_timer_t *timer)
+{
+    // the cycle counter is only 32 bits on some boards and wraps within a
+    //   couple of minutes, so long intervals come from the uptime clock
+    uint32_t ms = zjs_port_timer_get_uptime() - timer->start_ms;
+    if (ms >= 1000) {
+        return (uint64_t)ms * 1000000;
+    }
+    zjs_port_cycles_t cycles = zjs_port_get_cycles() - timer->start_cycles;
+    return zjs_port_cycles_to_ns(cycles);
+}
+
+static void format_ms(char *buf, int len, uint64_t ns)
+{
+    // effects: writes ns as milliseconds with three decimals, without
+    //            relying on float support in printf
+    uint64_t us = ns / 1000;
+    snprintf(buf, len, "%lu.%03lums", (unsigned long)(us / 1000),
+             (unsigned long)(us % 1000));
+}
+
+static void print_elapsed(console_timer_t *timer, uint64_t ns,
+                          const jerry_value_t argv[], jerry_length_t argc)
+{
+    // effects: prints "label: 1.234ms", followed by any extra values
+    char elapsed[32];
+    format_ms(elapsed, sizeof(elapsed), ns);
+    console_begin(stdout);
+    console_puts(stdout, timer->label);
+    console_puts(stdout, ": ");
+    console_puts(stdout, elapsed);
+    for (int i = 0; i < argc; i++) {
+        console_puts(stdout, " ");
+        print_value(argv[i], stdout, true, false);
+    }
+    console_end(stdout, "\n");
+}
+
+static void print_aggregate(console_timer_t *timer)
+{
+    char min[24], mean[24], max[24];
+    uint64_t count = timer->count;
+    format_ms(min, sizeof(min), count ? timer->min_ns : 0);
+    format_ms(mean, sizeof(mean), count ? timer->total_ns / count : 0);
+    format_ms(max, sizeof(max), timer->max_ns);
+
+    char line[96];
+    snprintf(line, sizeof(line), ": %lu calls, min %s, mean %s, max %s",
+             (unsigned long)timer->count, min, mean, max);
+    console_begin(stdout);
+    console_puts(stdout, timer->label);
+    console_puts(stdout, line);
+    console_end(stdout, "\n");
+}
+
 static jerry_value_t console_time(const jerry_value_t function_obj,
                                   const jerry_value_t this,
                                   const jerry_value_t argv[],
@@ -185,11 +658,32 @@ static jerry_value_t console_time(const jerry_value_t function_obj,
     // args: label
     ZJS_VALIDATE_ARGS(Z_STRING);
 
-    uint32_t start = zjs_port_timer_get_uptime();
+    console_timer_t *timer = timer_find(argv[0], true);
+    if (!timer) {
+        return zjs_error("console.time: unable to add timer");
+    }
+
+    // restarts the timer if it was already running
+    timer->running = true;
+    timer->start_ms = zjs_port_timer_get_uptime();
+    timer->start_cycles = zjs_port_get_cycles();
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t console_time_log(const jerry_value_t function_obj,
+                                      const jerry_value_t this,
+                                      const jerry_value_t argv[],
+                                      const jerry_length_t argc)
+{
+    // args: label[, data...]
+    ZJS_VALIDATE_ARGS(Z_STRING);
+
+    console_timer_t *timer = timer_find(argv[0], false);
+    if (!timer || !timer->running) {
+        return TYPE_ERROR("no such timer");
+    }
 
-    jerry_value_t num = jerry_create_number(start);
-    jerry_set_property(gbl_time_obj, argv[0], num);
-    jerry_release_value(num);
+    print_elapsed(timer, timer_elapsed_ns(timer), argv + 1, argc - 1);
     return ZJS_UNDEFINED;
 }
 
@@ -201,26 +695,80 @@ static jerry_value_t console_time_end(const jerry_value_t function_obj,
     // args: label
     ZJS_VALIDATE_ARGS(Z_STRING);
 
-    jerry_value_t num = jerry_get_property(gbl_time_obj, argv[0]);
-    jerry_delete_property(gbl_time_obj, argv[0]);
+    console_timer_t *timer = timer_find(argv[0], false);
+    if (!timer || !timer->running) {
+        return TYPE_ERROR("no such timer");
+    }
 
-    if (!jerry_value_is_number(num)) {
-        jerry_release_value(num);
-        return TYPE_ERROR("unexpected value");
+    uint64_t ns = timer_elapsed_ns(timer);
+    if (!timer->aggregate) {
+        print_elapsed(timer, ns, NULL, 0);
+        timer_free(timer);
+        return ZJS_UNDEFINED;
     }
 
-    uint32_t start = (uint32_t)jerry_get_number_value(num);
-    uint32_t milli = zjs_port_timer_get_uptime() - start;
-    jerry_release_value(num);
+    // aggregate mode just records the interval, for timeReport to print
+    timer->running = false;
+    if (!timer->count || ns < timer->min_ns) {
+        timer->min_ns = ns;
+    }
+    if (ns > timer->max_ns) {
+        timer->max_ns = ns;
+    }
+    timer->total_ns += ns;
+    timer->count++;
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t console_time_aggregate(const jerry_value_t function_obj,
+                                            const jerry_value_t this,
+                                            const jerry_value_t argv[],
+                                            const jerry_length_t argc)
+{
+    // args: label[, enable]
+    ZJS_VALIDATE_ARGS(Z_STRING, Z_OPTIONAL Z_BOOL);
 
-    char *label = zjs_alloc_from_jstring(argv[0], NULL);
-    const char *const_label = "unknown";
-    if (label) {
-        const_label = label;
+    bool enable = argc < 2 || jerry_get_boolean_value(argv[1]);
+    console_timer_t *timer = timer_find(argv[0], enable);
+    if (!timer) {
+        return enable ? zjs_error("console.timeAggregate: unable to add timer")
+                      : ZJS_UNDEFINED;
     }
 
-    ZJS_PRINT("%s: %lums\n", const_label, milli);
-    zjs_free(label);
+    timer->aggregate = enable;
+    if (!enable) {
+        // discard the totals; a running timer goes back to printing
+        timer->count = 0;
+        timer->total_ns = timer->min_ns = timer->max_ns = 0;
+        if (!timer->running) {
+            timer_free(timer);
+        }
+    }
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t console_time_report(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // args: [label]
+    ZJS_VALIDATE_ARGS(Z_OPTIONAL Z_STRING);
+
+    if (argc > 0) {
+        console_timer_t *timer = timer_find(argv[0], false);
+        if (!timer || !timer->aggregate) {
+            return TYPE_ERROR("no such aggregate timer");
+        }
+        print_aggregate(timer);
+        return ZJS_UNDEFINED;
+    }
+
+    for (console_timer_t *t = console_timers; t; t = t->next) {
+        if (t->aggregate) {
+            print_aggregate(t);
+        }
+    }
     return ZJS_UNDEFINED;
 }
 
@@ -253,7 +801,10 @@ void zjs_console_init(void)
     zjs_obj_add_function(console, console_error, "error");
     zjs_obj_add_function(console, console_error, "warn");
     zjs_obj_add_function(console, console_time, "time");
+    zjs_obj_add_function(console, console_time_log, "timeLog");
     zjs_obj_add_function(console, console_time_end, "timeEnd");
+    zjs_obj_add_function(console, console_time_aggregate, "timeAggregate");
+    zjs_obj_add_function(console, console_time_report, "timeReport");
     zjs_obj_add_function(console, console_assert, "assert");
 
     jerry_value_t global_obj = jerry_get_global_object();
@@ -262,13 +813,22 @@ void zjs_console_init(void)
     jerry_release_value(console);
     jerry_release_value(global_obj);
 
-    // initialize the time object
-    gbl_time_obj = jerry_create_object();
+#ifdef ZJS_CONSOLE_BUFFER
+    if (!service_registered) {
+        zjs_register_service_routine(NULL, console_service);
+        service_registered = true;
+    }
+#endif
 }
 
 void zjs_console_cleanup()
 {
-    jerry_release_value(gbl_time_obj);
+    while (console_timers) {
+        console_timer_t *t = console_timers;
+        console_timers = t->next;
+        zjs_free(t);
+    }
+    zjs_console_flush();
 }
 
 #endif  // BUILD_MODULE_CONSOLE
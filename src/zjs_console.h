@@ -1,4 +1,7 @@
-// Copyright (c) 2016, Intel Corporation.
+// Copyright (c) 2016-2017, Intel Corporation.
+
+#ifndef __zjs_console_h__
+#define __zjs_console_h__
 
 /**
  * Initialize the console module, or reinitialize after cleanup
@@ -9,3 +12,46 @@ void zjs_console_init();
 
 /** Release resources held by the console module */
 void zjs_console_cleanup();
+
+#if defined(BUILD_MODULE_CONSOLE) && defined(ZJS_CONSOLE_BUFFER)
+// Buffered console output, enabled with CONSOLE_BUFFER=on. Lines from
+//   console.log are formatted into a ring and written out a chunk at a time
+//   from a service routine, so a script that logs heavily doesn't wait on a
+//   slow UART for every line. console.error output is written immediately,
+//   after flushing the ring so the lines stay in order.
+
+// bytes of RAM kept for pending output, must be a power of 2
+#ifndef ZJS_CONSOLE_BUF_SIZE
+#define ZJS_CONSOLE_BUF_SIZE    1024
+#endif
+
+// most bytes written out per pass of the event loop
+#ifndef ZJS_CONSOLE_DRAIN_SIZE
+#define ZJS_CONSOLE_DRAIN_SIZE  64
+#endif
+
+// what console.log does with a line that doesn't fit in the ring
+enum zjs_console_overflow {
+    ZJS_CONSOLE_DROP,       // discard the line
+    ZJS_CONSOLE_COUNT,      // discard it, then print how many were lost
+    ZJS_CONSOLE_BLOCK,      // write out pending output to make room
+};
+
+#ifndef ZJS_CONSOLE_OVERFLOW
+#define ZJS_CONSOLE_OVERFLOW    ZJS_CONSOLE_COUNT
+#endif
+
+/**
+ * Choose how console.log handles a full ring.
+ *
+ * @param policy  One of the zjs_console_overflow values
+ */
+void zjs_console_set_overflow(enum zjs_console_overflow policy);
+
+/** Write out all pending console output, e.g. before exiting. */
+void zjs_console_flush();
+#else
+#define zjs_console_flush() do {} while (0)
+#endif
+
+#endif  // __zjs_console_h__
@@ -14,6 +14,7 @@
 static jerry_value_t zjs_dgram_socket_prototype;
 
 typedef struct dgram_handle {
+    zjs_native_t native;
     struct net_context *udp_sock;
     zjs_callback_id message_cb_id;
     zjs_callback_id error_cb_id;
@@ -28,16 +29,6 @@ typedef struct dgram_handle {
         zjs_copy_jstring(jval, buf, &str_sz); \
     }
 
-#define GET_HANDLE(type, var) \
-    type *var; \
-    { \
-        uintptr_t native; \
-        if (!jerry_get_object_native_handle(this, &native)) { \
-            return zjs_error("no native handle"); \
-        } \
-        var = (type*)native; \
-    }
-
 // Parse textual address of given address family (IPv4/IPv6) and numeric
 // port and fill in sockaddr. Returns ZJS_UNDEFINED if everything is OK,
 // or error instance otherwise.
@@ -124,6 +115,11 @@ static void udp_received(struct net_context *context,
 
     jerry_value_t buf_js = zjs_buffer_create(recv_len);
     zjs_buffer_t *buf = zjs_buffer_find(buf_js);
+    if (!buf) {
+        ERR_PRINT("dgram: out of memory, dropping message\n");
+        net_nbuf_unref(net_buf);
+        return;
+    }
 
     jerry_value_t rinfo = jerry_create_object();
     zjs_obj_add_number(rinfo, ntohs(NET_UDP_BUF(net_buf)->src_port), "port");
@@ -166,14 +162,15 @@ static jerry_value_t zjs_dgram_createSocket(const jerry_value_t function_obj,
     jerry_value_t sockobj = jerry_create_object();
     jerry_set_prototype(sockobj, zjs_dgram_socket_prototype);
 
-    dgram_handle_t *handle = zjs_malloc(sizeof(handle));
+    dgram_handle_t *handle = zjs_malloc(sizeof(dgram_handle_t));
     if (!handle)
         return zjs_error("createSocket: OOM");
     handle->udp_sock = udp_sock;
     handle->message_cb_id = -1;
     handle->error_cb_id = -1;
 
-    jerry_set_object_native_handle(sockobj, (uintptr_t)handle, zjs_dgram_free_cb);
+    zjs_wrap(sockobj, &handle->native, ZJS_CLASS_DGRAM_SOCKET,
+             zjs_dgram_free_cb);
 
     // Can't call this here due to bug in Zephyr - called in .bind() instead
     //CHECK(net_context_recv(udp_sock, udp_received, K_NO_WAIT, handle));
@@ -189,7 +186,7 @@ static jerry_value_t zjs_dgram_sock_on(const jerry_value_t function_obj,
     // args: event name, callback
     ZJS_VALIDATE_ARGS(Z_STRING, Z_FUNCTION Z_NULL);
 
-    GET_HANDLE(dgram_handle_t, handle);
+    ZJS_GET_HANDLE(this, dgram_handle_t, handle, DGRAM_SOCKET);
 
     jerry_size_t str_sz = 32;
     char event[str_sz];
@@ -204,8 +201,10 @@ static jerry_value_t zjs_dgram_sock_on(const jerry_value_t function_obj,
         return zjs_error("zjs_dgram_sock_on: unsupported event type");
 
     zjs_remove_callback(*cb_slot);
-    if (!jerry_value_is_null(argv[1]))
+    if (!jerry_value_is_null(argv[1])) {
         *cb_slot = zjs_add_callback(argv[1], this, handle, NULL);
+        zjs_set_callback_source(*cb_slot, "dgram", event);
+    }
 
     return ZJS_UNDEFINED;
 }
@@ -251,7 +250,7 @@ static jerry_value_t zjs_dgram_sock_send(const jerry_value_t function_obj,
 
     int ret;
 
-    GET_HANDLE(dgram_handle_t, handle);
+    ZJS_GET_HANDLE(this, dgram_handle_t, handle, DGRAM_SOCKET);
 
     zjs_buffer_t *buf = zjs_buffer_find(argv[0]);
     if (!buf) {
@@ -301,7 +300,7 @@ static jerry_value_t zjs_dgram_sock_bind(const jerry_value_t function_obj,
 
     int ret;
 
-    GET_HANDLE(dgram_handle_t, handle);
+    ZJS_GET_HANDLE(this, dgram_handle_t, handle, DGRAM_SOCKET);
 
     sa_family_t family = net_context_get_family(handle->udp_sock);
     struct sockaddr sockaddr_buf;
@@ -322,7 +321,7 @@ static jerry_value_t zjs_dgram_sock_close(const jerry_value_t function_obj,
                                           const jerry_value_t argv[],
                                           const jerry_length_t argc)
 {
-    GET_HANDLE(dgram_handle_t, handle);
+    ZJS_GET_HANDLE(this, dgram_handle_t, handle, DGRAM_SOCKET);
     zjs_dgram_free_cb((uintptr_t)handle);
     jerry_set_object_native_handle(this, (uintptr_t)NULL, NULL);
     return ZJS_UNDEFINED;
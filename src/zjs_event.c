@@ -1,132 +1,241 @@
 // Copyright (c) 2016-2017, Intel Corporation.
 
+#include <string.h>
+
 #include "zjs_event.h"
 #include "zjs_callbacks.h"
 
 #define ZJS_MAX_EVENT_NAME_SIZE     24
 #define DEFAULT_MAX_LISTENERS       10
-#ifdef DEBUG_BUILD
-#define HIDDEN_PROP(n) n
-#else
-#define HIDDEN_PROP(n) "\377" n
-#endif
 
 static jerry_value_t zjs_event_emitter_prototype;
 
-typedef struct event {
-    int num_events;
-    jerry_value_t map;
-    int max_listeners;
-} event_t;
+// Event names are interned to atoms, small integers that index a global
+//   name table, so an emitter finds an event's callback by comparing atoms
+//   instead of looking up JS properties. Atoms are never freed; there is one
+//   per distinct event name used by the program.
+typedef uint16_t event_atom_t;
+
+#define NO_ATOM                     0
+#define ATOM_HASH_INITIAL_SIZE      32
+
+static char **atom_names = NULL;            // name of atom n at n - 1
+static uint16_t atom_count = 0;
+static uint16_t *atom_hash = NULL;          // open addressed, holds atoms
+static uint16_t atom_hash_size = 0;         // power of 2
+
+// listener registry kept natively on the hidden event object of an emitter
+typedef struct event_entry {
+    event_atom_t atom;
+    zjs_callback_id callback_id;
+} event_entry_t;
+
+typedef struct emitter {
+    zjs_native_t native;
+    uint32_t max_listeners;
+    uint16_t num_events;
+    uint16_t capacity;
+    event_entry_t *events;                  // in the order first added
+} emitter_t;
+
+static uint32_t atom_hash_name(const char *name)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619;
+    }
+    return hash;
+}
 
-typedef struct event_trigger {
-    void* handle;
-    zjs_post_event post;
-} event_trigger_t;
+static void atom_hash_insert(uint16_t *table, uint16_t size, event_atom_t atom)
+{
+    uint32_t mask = size - 1;
+    uint32_t slot = atom_hash_name(atom_names[atom - 1]) & mask;
+    while (table[slot] != NO_ATOM) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = atom;
+}
 
-typedef struct event_names {
-    jerry_value_t name_array;
-    int idx;
-} event_names_t;
+static bool atom_grow()
+{
+    // keep the hash table at most 3/4 full, and the name table the same size
+    uint16_t size = atom_hash_size ? atom_hash_size * 2 : ATOM_HASH_INITIAL_SIZE;
+    if (!size) {
+        // out of atoms
+        return false;
+    }
+    uint16_t *table = zjs_malloc(size * sizeof(uint16_t));
+    char **names = zjs_malloc(size * sizeof(char *));
+    if (!table || !names) {
+        zjs_free(table);
+        zjs_free(names);
+        return false;
+    }
+    memset(table, 0, size * sizeof(uint16_t));
+    if (atom_count) {
+        memcpy(names, atom_names, atom_count * sizeof(char *));
+    }
+    zjs_free(atom_names);
+    atom_names = names;
+    for (event_atom_t atom = 1; atom <= atom_count; atom++) {
+        atom_hash_insert(table, size, atom);
+    }
+    zjs_free(atom_hash);
+    atom_hash = table;
+    atom_hash_size = size;
+    return true;
+}
 
-void post_event(void* h, jerry_value_t* ret_val)
+static event_atom_t event_intern(const char *name, bool create)
 {
-    event_trigger_t *trigger = (event_trigger_t *)h;
-    if (trigger) {
-        if (trigger->post) {
-            trigger->post(trigger->handle);
+    // effects: returns the atom for name, creating it if create is true and
+    //            it doesn't exist yet; returns NO_ATOM if not found or out of
+    //            memory
+    if (atom_hash_size) {
+        uint32_t mask = atom_hash_size - 1;
+        uint32_t slot = atom_hash_name(name) & mask;
+        while (atom_hash[slot] != NO_ATOM) {
+            event_atom_t atom = atom_hash[slot];
+            if (!strcmp(atom_names[atom - 1], name)) {
+                return atom;
+            }
+            slot = (slot + 1) & mask;
         }
-        zjs_free(trigger);
     }
+    if (!create) {
+        return NO_ATOM;
+    }
+
+    if ((atom_count + 1) * 4 > atom_hash_size * 3 && !atom_grow()) {
+        ERR_PRINT("out of memory for event names\n");
+        return NO_ATOM;
+    }
+    int len = strlen(name);
+    char *copy = zjs_malloc(len + 1);
+    if (!copy) {
+        ERR_PRINT("out of memory for event names\n");
+        return NO_ATOM;
+    }
+    memcpy(copy, name, len + 1);
+    atom_names[atom_count++] = copy;
+    atom_hash_insert(atom_hash, atom_hash_size, atom_count);
+    return atom_count;
 }
 
-static uint32_t get_num_events(jerry_value_t emitter)
+static void free_emitter(uintptr_t handle)
 {
-    jerry_value_t val = zjs_get_property(emitter, "numEvents");
-    if (!jerry_value_is_number(val)) {
-        jerry_release_value(val);
-        ERR_PRINT("emitter had no numEvents property\n");
-        return 0;
-    }
-    uint32_t num = jerry_get_number_value(val);
-    jerry_release_value(val);
-    return num;
+    emitter_t *emitter = (emitter_t *)handle;
+    zjs_free(emitter->events);
+    zjs_free(emitter);
 }
 
-static uint32_t get_max_event_listeners(jerry_value_t emitter)
+static emitter_t *get_emitter(jerry_value_t obj)
 {
-    jerry_value_t val = zjs_get_property(emitter, "maxListeners");
-    if (!jerry_value_is_number(val)) {
-        jerry_release_value(val);
-        ERR_PRINT("emitter had no maxListeners property\n");
-        return 0;
-    }
-    uint32_t num = jerry_get_number_value(val);
-    jerry_release_value(val);
-    return num;
+    // effects: returns the listener registry of an object made into an event
+    //            emitter with zjs_make_event, or NULL if it isn't one
+    jerry_value_t event_obj = jerry_get_property(obj, ZJS_PROP(event));
+    emitter_t *emitter = zjs_unwrap(event_obj, ZJS_CLASS_EVENT_EMITTER);
+    jerry_release_value(event_obj);
+    return emitter;
 }
 
-static int32_t get_callback_id(jerry_value_t event_obj)
+static event_entry_t *find_event(emitter_t *emitter, event_atom_t atom)
 {
-    int32_t callback_id = -1;
-    jerry_value_t id_prop = zjs_get_property(event_obj, "callback_id");
-    if (jerry_value_is_number(id_prop)) {
-        // If there already is an event object, get the callback ID
-        zjs_obj_get_int32(event_obj, "callback_id", &callback_id);
+    if (atom == NO_ATOM) {
+        return NULL;
+    }
+    for (int i = 0; i < emitter->num_events; i++) {
+        if (emitter->events[i].atom == atom) {
+            return &emitter->events[i];
+        }
     }
-    jerry_release_value(id_prop);
+    return NULL;
+}
 
-    return callback_id;
+static int32_t get_callback_id(jerry_value_t obj, const char *event)
+{
+    // effects: returns the callback ID holding the listeners for event on the
+    //            emitter obj, or -1 if there is none
+    emitter_t *emitter = get_emitter(obj);
+    if (!emitter) {
+        return -1;
+    }
+    event_entry_t *entry = find_event(emitter, event_intern(event, false));
+    return entry ? entry->callback_id : -1;
 }
 
-void zjs_add_event_listener(jerry_value_t obj, const char* event,
-                            jerry_value_t listener)
+static void add_event_listener(jerry_value_t obj, const char *event,
+                               jerry_value_t listener, uint8_t flags)
 {
-    jerry_value_t event_emitter = zjs_get_property(obj, HIDDEN_PROP("event"));
-    if (!jerry_value_is_object(event_emitter)) {
-        jerry_release_value(event_emitter);
+    // effects: adds listener for event with ZJS_CB_LIST_* flags
+    emitter_t *emitter = get_emitter(obj);
+    if (!emitter) {
         ERR_PRINT("no event '%s' found\n", event);
         return;
     }
-    uint32_t num_events = get_num_events(event_emitter);
-    uint32_t max_listeners = get_max_event_listeners(event_emitter);
 
-    if (num_events >= max_listeners) {
-        jerry_release_value(event_emitter);
+    event_atom_t atom = event_intern(event, true);
+    if (atom == NO_ATOM) {
+        return;
+    }
+
+    event_entry_t *entry = find_event(emitter, atom);
+    int32_t callback_id = entry ? entry->callback_id : -1;
+    if (callback_id != -1 &&
+        zjs_get_num_callbacks(callback_id) >= emitter->max_listeners) {
         ERR_PRINT("max listeners reached\n");
         return;
     }
 
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
+    if (!entry) {
+        if (emitter->num_events == emitter->capacity) {
+            uint16_t capacity = emitter->capacity ? emitter->capacity * 2 : 4;
+            event_entry_t *events =
+                zjs_malloc(capacity * sizeof(event_entry_t));
+            if (!events) {
+                ERR_PRINT("out of memory\n");
+                return;
+            }
+            if (emitter->num_events) {
+                memcpy(events, emitter->events,
+                       emitter->num_events * sizeof(event_entry_t));
+            }
+            zjs_free(emitter->events);
+            emitter->events = events;
+            emitter->capacity = capacity;
+        }
+    }
 
-    // Event object to hold callback ID and eventually listener arguments
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_obj);
-        event_obj = jerry_create_object();
+    callback_id = zjs_add_callback_list_flags(listener, obj, NULL, NULL,
+                                              callback_id, flags);
+    if (callback_id == -1) {
+        ERR_PRINT("could not add listener for '%s'\n", event);
+        return;
     }
 
-    int32_t callback_id = get_callback_id(event_obj);
-    callback_id = zjs_add_callback_list(listener, obj, NULL, post_event,
-                                        callback_id);
-    // Add callback ID to event object
-    zjs_obj_add_number(event_obj, callback_id, "callback_id");
-    // Add event object to master event listener
-    zjs_set_property(map, event, event_obj);
-    jerry_release_value(event_obj);
-    jerry_release_value(map);
+    if (!entry) {
+        entry = &emitter->events[emitter->num_events++];
+        entry->atom = atom;
+        entry->callback_id = callback_id;
+        zjs_set_callback_source(callback_id, "event", event);
+    }
 
     DBG_PRINT("added listener, callback id = %ld\n", callback_id);
+}
 
-    zjs_obj_add_number(event_emitter, ++num_events, "numEvents");
-
-    jerry_release_value(event_emitter);
+void zjs_add_event_listener(jerry_value_t obj, const char* event,
+                            jerry_value_t listener)
+{
+    add_event_listener(obj, event, listener, 0);
 }
 
-static jerry_value_t add_listener(const jerry_value_t function_obj,
-                                  const jerry_value_t this,
-                                  const jerry_value_t argv[],
-                                  const jerry_length_t argc)
+static jerry_value_t add_listener_flags(const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc,
+                                        uint8_t flags)
 {
     // args: event name, callback
     ZJS_VALIDATE_ARGS(Z_STRING, Z_FUNCTION);
@@ -137,10 +246,43 @@ static jerry_value_t add_listener(const jerry_value_t function_obj,
     if (!size) {
         return zjs_error("event name is too long");
     }
-    zjs_add_event_listener(this, name, argv[1]);
+    add_event_listener(this, name, argv[1], flags);
     return jerry_acquire_value(this);
 }
 
+static jerry_value_t add_listener(const jerry_value_t function_obj,
+                                  const jerry_value_t this,
+                                  const jerry_value_t argv[],
+                                  const jerry_length_t argc)
+{
+    return add_listener_flags(this, argv, argc, 0);
+}
+
+static jerry_value_t add_once_listener(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    return add_listener_flags(this, argv, argc, ZJS_CB_LIST_ONCE);
+}
+
+static jerry_value_t prepend_listener(const jerry_value_t function_obj,
+                                      const jerry_value_t this,
+                                      const jerry_value_t argv[],
+                                      const jerry_length_t argc)
+{
+    return add_listener_flags(this, argv, argc, ZJS_CB_LIST_PREPEND);
+}
+
+static jerry_value_t prepend_once_listener(const jerry_value_t function_obj,
+                                           const jerry_value_t this,
+                                           const jerry_value_t argv[],
+                                           const jerry_length_t argc)
+{
+    return add_listener_flags(this, argv, argc,
+                              ZJS_CB_LIST_ONCE | ZJS_CB_LIST_PREPEND);
+}
+
 static jerry_value_t emit_event(const jerry_value_t function_obj,
                                 const jerry_value_t this,
                                 const jerry_value_t *argv,
@@ -170,37 +312,19 @@ static jerry_value_t remove_listener(const jerry_value_t function_obj,
     // args: event name, callback
     ZJS_VALIDATE_ARGS(Z_STRING, Z_FUNCTION);
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-
     jerry_size_t size = ZJS_MAX_EVENT_NAME_SIZE;
     char event[size];
     zjs_copy_jstring(argv[0], event, &size);
     if (!size) {
-        jerry_release_value(event_emitter);
         return zjs_error("event name is too long");
     }
 
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-
-    jerry_release_value(event_emitter);
-    jerry_release_value(map);
-
-    // Event object to hold callback ID and eventually listener arguments
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_obj);
-        ERR_PRINT("event object not found\n");
-        return ZJS_UNDEFINED;
-    }
-
-    int32_t callback_id = get_callback_id(event_obj);
-
-   if (callback_id != -1) {
+    int32_t callback_id = get_callback_id(this, event);
+    if (callback_id != -1) {
         zjs_remove_callback_list_func(callback_id, argv[1]);
     } else {
         ERR_PRINT("callback_id not found for '%s'\n", event);
     }
-    jerry_release_value(event_obj);
 
     return jerry_acquire_value(this);
 }
@@ -213,80 +337,52 @@ static jerry_value_t remove_all_listeners(const jerry_value_t function_obj,
     // args: event name
     ZJS_VALIDATE_ARGS(Z_STRING);
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-
     jerry_size_t size = ZJS_MAX_EVENT_NAME_SIZE;
     char event[size];
     zjs_copy_jstring(argv[0], event, &size);
     if (!size) {
-        jerry_release_value(event_emitter);
         return zjs_error("event name is too long");
     }
 
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-
-    // Event object to hold callback ID and eventually listener arguments
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_emitter);
-        jerry_release_value(event_obj);
-        jerry_release_value(map);
-        ERR_PRINT("event object not found\n");
-        return ZJS_UNDEFINED;
+    emitter_t *emitter = get_emitter(this);
+    event_entry_t *entry = NULL;
+    if (emitter) {
+        entry = find_event(emitter, event_intern(event, false));
     }
-
-    int32_t callback_id = get_callback_id(event_obj);
-
-    if (callback_id != -1) {
-        zjs_remove_callback(callback_id);
-
-        jerry_value_t name = jerry_create_string((const jerry_char_t*)event);
-        jerry_delete_property(map, (const jerry_value_t)name);
-        jerry_release_value(name);
-    } else {
+    if (!entry) {
         ERR_PRINT("callback_id not found for '%s'\n", event);
+        return jerry_acquire_value(this);
     }
 
-    zjs_obj_add_number(event_emitter, 0, "numEvents");
+    zjs_remove_callback(entry->callback_id);
 
-    jerry_release_value(map);
-    jerry_release_value(event_obj);
-    jerry_release_value(event_emitter);
+    // keep the remaining events in the order they were added
+    int index = entry - emitter->events;
+    memmove(entry, entry + 1,
+            (emitter->num_events - index - 1) * sizeof(event_entry_t));
+    emitter->num_events--;
 
     return jerry_acquire_value(this);
 }
 
-bool foreach_event_name(const jerry_value_t prop_name,
-                        const jerry_value_t prop_value,
-                        void *data)
-{
-    event_names_t *names = (event_names_t *)data;
-
-    jerry_set_property_by_index(names->name_array,
-                                names->idx++,
-                                prop_name);
-    return true;
-}
-
 static jerry_value_t get_event_names(const jerry_value_t function_obj,
                                      const jerry_value_t this,
                                      const jerry_value_t argv[],
                                      const jerry_length_t argc)
 {
-    event_names_t names;
-
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-    uint32_t num_events = get_num_events(event_emitter);
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-
-    jerry_release_value(event_emitter);
-
-    names.idx = 0;
-    names.name_array = jerry_create_array(num_events);
-
-    jerry_foreach_object_property(map, foreach_event_name, &names);
+    emitter_t *emitter = get_emitter(this);
+    uint32_t num_events = emitter ? emitter->num_events : 0;
+
+    jerry_value_t name_array = jerry_create_array(num_events);
+    for (uint32_t i = 0; i < num_events; i++) {
+        event_atom_t atom = emitter->events[i].atom;
+        jerry_value_t name =
+            jerry_create_string((jerry_char_t *)atom_names[atom - 1]);
+        jerry_set_property_by_index(name_array, i, name);
+        jerry_release_value(name);
+    }
 
-    return names.name_array;
+    return name_array;
 }
 
 static jerry_value_t get_max_listeners(const jerry_value_t function_obj,
@@ -294,11 +390,12 @@ static jerry_value_t get_max_listeners(const jerry_value_t function_obj,
                                        const jerry_value_t argv[],
                                        const jerry_length_t argc)
 {
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-    uint32_t max_listeners = get_max_event_listeners(event_emitter);
-    jerry_release_value(event_emitter);
+    emitter_t *emitter = get_emitter(this);
+    if (!emitter) {
+        return zjs_error("object is not an event emitter");
+    }
 
-    return jerry_create_number(max_listeners);
+    return jerry_create_number(emitter->max_listeners);
 }
 
 static jerry_value_t set_max_listeners(const jerry_value_t function_obj,
@@ -309,15 +406,16 @@ static jerry_value_t set_max_listeners(const jerry_value_t function_obj,
     // args: max count
     ZJS_VALIDATE_ARGS(Z_NUMBER);
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
+    emitter_t *emitter = get_emitter(this);
+    if (!emitter) {
+        return zjs_error("object is not an event emitter");
+    }
 
     double num = jerry_get_number_value(argv[0]);
     if (num < 0) {
         return zjs_error("max listener value must be a positive integer");
     }
-    zjs_obj_add_number(event_emitter, num, "maxListeners");
-
-    jerry_release_value(event_emitter);
+    emitter->max_listeners = (uint32_t)num;
 
     return jerry_acquire_value(this);
 }
@@ -330,37 +428,19 @@ static jerry_value_t get_listener_count(const jerry_value_t function_obj,
     // args: event name
     ZJS_VALIDATE_ARGS(Z_STRING);
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-
     jerry_size_t size = ZJS_MAX_EVENT_NAME_SIZE;
     char event[size];
     zjs_copy_jstring(argv[0], event, &size);
     if (!size) {
-        jerry_release_value(event_emitter);
         return zjs_error("event name is too long");
     }
 
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-    jerry_release_value(map);
-    jerry_release_value(event_emitter);
-
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_obj);
-        return jerry_create_number(0);
-    }
-
-    int32_t callback_id = get_callback_id(event_obj);
-
+    int32_t callback_id = get_callback_id(this, event);
     int count = 0;
     if (callback_id != -1) {
         count = zjs_get_num_callbacks(callback_id);
-    } else {
-        ERR_PRINT("callback_id not found for '%s'\n", event);
     }
 
-    jerry_release_value(event_obj);
-
     return jerry_create_number(count);
 }
 
@@ -372,43 +452,25 @@ static jerry_value_t get_listeners(const jerry_value_t function_obj,
     // args: event name
     ZJS_VALIDATE_ARGS(Z_STRING);
 
-    jerry_value_t event_emitter = zjs_get_property(this, HIDDEN_PROP("event"));
-
     jerry_size_t size = ZJS_MAX_EVENT_NAME_SIZE;
     char event[size];
     zjs_copy_jstring(argv[0], event, &size);
     if (!size) {
-        jerry_release_value(event_emitter);
         return zjs_error("event name is too long");
     }
 
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-    jerry_release_value(map);
-    jerry_release_value(event_emitter);
-
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_obj);
-        return zjs_error("event object not found");
-    }
-
-    int32_t callback_id = get_callback_id(event_obj);
-    jerry_release_value(event_obj);
-
+    int32_t callback_id = get_callback_id(this, event);
     if (callback_id == -1) {
-        ERR_PRINT("callback_id not found for '%s'\n", event);
-        return ZJS_UNDEFINED;
+        return zjs_error("event object not found");
     }
 
-    int count;
-    int i;
-    jerry_value_t* func_array = zjs_get_callback_func_list(callback_id, &count);
-    jerry_value_t ret_array = jerry_create_array(count);
-    for (i = 0; i < count; ++i) {
-        jerry_set_property_by_index(ret_array, i, func_array[i]);
-    }
+    return zjs_get_callback_funcs(callback_id);
+}
 
-    return ret_array;
+bool zjs_event_has_listeners(jerry_value_t obj, const char *event)
+{
+    int32_t callback_id = get_callback_id(obj, event);
+    return callback_id != -1 && zjs_get_num_callbacks(callback_id) > 0;
 }
 
 bool zjs_trigger_event(jerry_value_t obj,
@@ -418,44 +480,21 @@ bool zjs_trigger_event(jerry_value_t obj,
                        zjs_post_event post,
                        void* h)
 {
-    event_trigger_t *trigger = zjs_malloc(sizeof(event_trigger_t));
-    if (!trigger) {
-        ERR_PRINT("could not allocate trigger, out of memory\n");
-        return false;
-    }
-
-    jerry_value_t event_emitter = zjs_get_property(obj, HIDDEN_PROP("event"));
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-    jerry_release_value(map);
-    jerry_release_value(event_emitter);
-
-    if (!jerry_value_is_object(event_obj)) {
-        zjs_free(trigger);
-        ERR_PRINT("event object not found\n");
-        return false;
-    }
-
-    int32_t callback_id = get_callback_id(event_obj);
-    jerry_release_value(event_obj);
-
+    int32_t callback_id = get_callback_id(obj, event);
     if (callback_id == -1) {
-        zjs_free(trigger);
-        ERR_PRINT("callback_id not found\n");
+        DBG_PRINT("no listeners for event '%s'\n", event);
+        if (post) {
+            post(h);
+        }
         return false;
     }
 
-    trigger->handle = h;
-    trigger->post = post;
-
-    zjs_edit_callback_handle(callback_id, trigger);
-
-    zjs_signal_callback(callback_id, argv, argc * sizeof(jerry_value_t));
-
     DBG_PRINT("triggering event '%s', args_cnt=%lu, callback_id=%ld\n",
               event, argc, callback_id);
 
-    return true;
+    // post travels with this signal, so back to back emits each get theirs
+    return zjs_signal_callback_post(callback_id, argv,
+                                    argc * sizeof(jerry_value_t), post, h);
 }
 
 bool zjs_trigger_event_now(jerry_value_t obj,
@@ -465,54 +504,37 @@ bool zjs_trigger_event_now(jerry_value_t obj,
                            zjs_post_event post,
                            void* h)
 {
-    event_trigger_t *trigger = zjs_malloc(sizeof(event_trigger_t));
-    if (!trigger) {
-        ERR_PRINT("could not allocate trigger, out of memory\n");
-        return false;
-    }
-
-    jerry_value_t event_emitter = zjs_get_property(obj, HIDDEN_PROP("event"));
-    jerry_value_t map = zjs_get_property(event_emitter, "map");
-    jerry_value_t event_obj = zjs_get_property(map, event);
-    jerry_release_value(map);
-    jerry_release_value(event_emitter);
-
-    if (!jerry_value_is_object(event_obj)) {
-        jerry_release_value(event_obj);
-        zjs_free(trigger);
-        ERR_PRINT("event object not found\n");
-        return false;
-    }
-
-    int32_t callback_id = get_callback_id(event_obj);
-    jerry_release_value(event_obj);
-
+    int32_t callback_id = get_callback_id(obj, event);
     if (callback_id == -1) {
-        zjs_free(trigger);
-        ERR_PRINT("callback_id not found\n");
+        DBG_PRINT("no listeners for event '%s'\n", event);
+        if (post) {
+            post(h);
+        }
         return false;
     }
 
-    trigger->handle = h;
-    trigger->post = post;
-
-    zjs_edit_callback_handle(callback_id, trigger);
-
-    zjs_call_callback(callback_id, argv, argc);
+    zjs_call_callback_post(callback_id, argv, argc, post, h);
 
     return true;
 }
 
 void zjs_make_event(jerry_value_t obj, jerry_value_t prototype)
 {
-    jerry_value_t event_obj = jerry_create_object();
-
-    zjs_obj_add_number(event_obj, DEFAULT_MAX_LISTENERS, "maxListeners");
-    zjs_obj_add_number(event_obj, 0, "numEvents");
+    emitter_t *emitter = zjs_malloc(sizeof(emitter_t));
+    if (!emitter) {
+        ERR_PRINT("out of memory\n");
+        return;
+    }
+    emitter->max_listeners = DEFAULT_MAX_LISTENERS;
+    emitter->num_events = 0;
+    emitter->capacity = 0;
+    emitter->events = NULL;
 
-    jerry_value_t map = jerry_create_object();
-    zjs_set_property(event_obj, "map", map);
-    jerry_release_value(map);
+    // the registry lives on a hidden object since obj may already have a
+    //   native handle of its own
+    jerry_value_t event_obj = jerry_create_object();
+    zjs_wrap(event_obj, &emitter->native, ZJS_CLASS_EVENT_EMITTER,
+             free_emitter);
 
     jerry_value_t proto = zjs_event_emitter_prototype;
     if (jerry_value_is_object(prototype)) {
@@ -521,7 +543,7 @@ void zjs_make_event(jerry_value_t obj, jerry_value_t prototype)
     }
     jerry_set_prototype(obj, proto);
 
-    zjs_obj_add_object(obj, event_obj, HIDDEN_PROP("event"));
+    jerry_set_property(obj, ZJS_PROP(event), event_obj);
     jerry_release_value(event_obj);
 }
 
@@ -540,8 +562,12 @@ jerry_value_t zjs_event_init()
     zjs_native_func_t array[] = {
         { add_listener, "on" },
         { add_listener, "addListener" },
+        { add_once_listener, "once" },
+        { prepend_listener, "prependListener" },
+        { prepend_once_listener, "prependOnceListener" },
         { emit_event, "emit" },
         { remove_listener, "removeListener" },
+        { remove_listener, "off" },
         { remove_all_listeners, "removeAllListeners" },
         { get_event_names, "eventNames" },
         { get_max_listeners, "getMaxListeners" },
@@ -562,4 +588,14 @@ jerry_value_t zjs_event_init()
 void zjs_event_cleanup()
 {
     jerry_release_value(zjs_event_emitter_prototype);
+
+    for (int i = 0; i < atom_count; i++) {
+        zjs_free(atom_names[i]);
+    }
+    zjs_free(atom_names);
+    zjs_free(atom_hash);
+    atom_names = NULL;
+    atom_hash = NULL;
+    atom_count = 0;
+    atom_hash_size = 0;
 }
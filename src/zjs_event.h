@@ -34,6 +34,15 @@ void zjs_make_event(jerry_value_t obj, jerry_value_t prototype);
  */
 void zjs_add_event_listener(jerry_value_t obj, const char* event, jerry_value_t listener);
 
+/**
+ * Check whether any listeners are registered for an event.
+ *
+ * @param obj    Object made into an emitter with zjs_make_event
+ * @param event  Name of the event
+ * @return true if at least one listener is registered
+ */
+bool zjs_event_has_listeners(jerry_value_t obj, const char *event);
+
 /**
  * Trigger an event
  *
@@ -47,7 +56,10 @@ void zjs_add_event_listener(jerry_value_t obj, const char* event, jerry_value_t
  * @param event         Name of event
  * @param args          Arguments to give to the event listener as parameters
  * @param args_cnt      Number of arguments
- * @param post          Function to be called after the event is triggered
+ * @param post          Function to be called after the event is triggered; it
+ *                        is called exactly once, even if there were no
+ *                        listeners or the event couldn't be queued, so it
+ *                        can release anything handle refers to
  * @param handle        A handle that is accessible in the 'post' call
  *
  * @return              True if there were listeners
@@ -66,7 +78,8 @@ bool zjs_trigger_event(jerry_value_t obj,
  * @param event         Name of event
  * @param args          Arguments to give to the event listener as parameters
  * @param args_cnt      Number of arguments
- * @param post          Function to be called after the event is triggered
+ * @param post          Function to be called after the event is triggered, or
+ *                        right away if there were no listeners
  * @param handle        A handle that is accessable in the 'post' call
  *
  * @return              True if there were listeners
@@ -0,0 +1,270 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#include <string.h>
+
+// ZJS includes
+#include "zjs_codec.h"
+#include "zjs_framer.h"
+#include "zjs_util.h"
+
+#define SLIP_END        0xc0
+#define SLIP_ESC        0xdb
+#define SLIP_ESC_END    0xdc
+#define SLIP_ESC_ESC    0xdd
+
+#define CRC_SIZE        2
+
+struct zjs_framer {
+    zjs_framer_config_t config;
+    zjs_frame_cb on_frame;
+    zjs_frame_error_cb on_error;
+    void *ctx;
+    uint32_t len;       // bytes of the current frame kept in buf
+    uint32_t left;      // LENGTH: the length read so far, then payload
+                        //   bytes still to come
+                        // COBS: data bytes left in the current block
+    uint8_t prefix;     // LENGTH: prefix bytes read so far
+    uint8_t code;       // COBS: code byte of the current block, 0 before one
+    bool escaped;       // SLIP: last byte was ESC
+    bool discard;       // dropping the rest of an invalid frame
+    uint8_t buf[];
+};
+
+static void report_error(zjs_framer_t *f, uint8_t error)
+{
+    if (f->on_error) {
+        f->on_error(f->ctx, error);
+    }
+}
+
+static void frame_error(zjs_framer_t *f, uint8_t error)
+{
+    // effects: drops the rest of the current frame and reports why
+    f->discard = true;
+    report_error(f, error);
+}
+
+static void frame_append(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    if (f->discard) {
+        return;
+    }
+    if (len > f->config.max_size - f->len) {
+        frame_error(f, ZJS_FRAME_OVERFLOW);
+        return;
+    }
+    memcpy(f->buf + f->len, data, len);
+    f->len += len;
+}
+
+static void frame_end(zjs_framer_t *f, bool skip_empty)
+{
+    // effects: hands the current frame to the callback, unless it is being
+    //            discarded or is empty and skip_empty is true, and starts
+    //            the next one
+    uint32_t len = f->len;
+    bool discard = f->discard;
+    f->len = 0;
+    f->discard = false;
+    if (discard || (skip_empty && !len)) {
+        return;
+    }
+
+    if (f->config.crc16) {
+        if (len < CRC_SIZE) {
+            report_error(f, ZJS_FRAME_CRC);
+            return;
+        }
+        len -= CRC_SIZE;
+        uint16_t crc = f->buf[len] << 8 | f->buf[len + 1];
+        if (zjs_crc16(f->buf, len, ZJS_CRC16_INIT) != crc) {
+            report_error(f, ZJS_FRAME_CRC);
+            return;
+        }
+    }
+    f->on_frame(f->ctx, f->buf, len);
+}
+
+static void push_delimiter(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    // copy runs between delimiters rather than a byte at a time
+    while (len) {
+        const uint8_t *end = zjs_find_byte(data, len, f->config.delimiter);
+        uint32_t run = end ? end - data : len;
+        frame_append(f, data, run);
+        if (!end) {
+            return;
+        }
+        frame_end(f, true);
+        data += run + 1;
+        len -= run + 1;
+    }
+}
+
+static void push_fixed(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    while (len) {
+        uint32_t run = f->config.max_size - f->len;
+        if (run > len) {
+            run = len;
+        }
+        frame_append(f, data, run);
+        data += run;
+        len -= run;
+        if (f->len == f->config.max_size) {
+            frame_end(f, false);
+        }
+    }
+}
+
+static void push_length(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    uint8_t size = f->config.prefix_size;
+    while (len) {
+        if (f->prefix < size) {
+            // still reading the length
+            uint32_t byte = *data++;
+            len--;
+            if (f->config.little_endian) {
+                f->left |= byte << (8 * f->prefix);
+            } else {
+                f->left = f->left << 8 | byte;
+            }
+            if (++f->prefix < size) {
+                continue;
+            }
+            if (f->left > f->config.max_size) {
+                // the length is known, so skip just this frame
+                frame_error(f, ZJS_FRAME_OVERFLOW);
+            }
+        } else {
+            uint32_t run = f->left < len ? f->left : len;
+            frame_append(f, data, run);
+            data += run;
+            len -= run;
+            f->left -= run;
+        }
+        if (!f->left) {
+            f->prefix = 0;
+            frame_end(f, false);
+        }
+    }
+}
+
+static void push_slip(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        if (byte == SLIP_END) {
+            f->escaped = false;
+            frame_end(f, true);
+            continue;
+        }
+        if (f->escaped) {
+            f->escaped = false;
+            if (byte == SLIP_ESC_END) {
+                byte = SLIP_END;
+            } else if (byte == SLIP_ESC_ESC) {
+                byte = SLIP_ESC;
+            } else {
+                if (!f->discard) {
+                    frame_error(f, ZJS_FRAME_ENCODING);
+                }
+                continue;
+            }
+        } else if (byte == SLIP_ESC) {
+            f->escaped = true;
+            continue;
+        }
+        frame_append(f, &byte, 1);
+    }
+}
+
+static void push_cobs(zjs_framer_t *f, const uint8_t *data, uint32_t len)
+{
+    static const uint8_t zero = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        if (!byte) {
+            if (f->left && !f->discard) {
+                // the frame ended partway through a block
+                frame_error(f, ZJS_FRAME_ENCODING);
+            }
+            f->code = 0;
+            f->left = 0;
+            frame_end(f, true);
+        } else if (f->left) {
+            frame_append(f, &byte, 1);
+            f->left--;
+        } else {
+            // a code byte; every block but the first and those after a full
+            //   254 byte block stands for a zero
+            if (f->code && f->code != 0xff) {
+                frame_append(f, &zero, 1);
+            }
+            f->code = byte;
+            f->left = byte - 1;
+        }
+    }
+}
+
+zjs_framer_t *zjs_framer_create(const zjs_framer_config_t *config,
+                                zjs_frame_cb on_frame,
+                                zjs_frame_error_cb on_error, void *ctx)
+{
+    if (!config->max_size || config->type > ZJS_FRAMER_COBS ||
+        (config->crc16 && config->max_size <= CRC_SIZE)) {
+        return NULL;
+    }
+    if (config->type == ZJS_FRAMER_LENGTH && config->prefix_size != 1 &&
+        config->prefix_size != 2 && config->prefix_size != 4) {
+        return NULL;
+    }
+
+    zjs_framer_t *f = zjs_malloc(sizeof(zjs_framer_t) + config->max_size);
+    if (!f) {
+        return NULL;
+    }
+    memset(f, 0, sizeof(zjs_framer_t));
+    f->config = *config;
+    f->on_frame = on_frame;
+    f->on_error = on_error;
+    f->ctx = ctx;
+    return f;
+}
+
+void zjs_framer_free(zjs_framer_t *framer)
+{
+    zjs_free(framer);
+}
+
+void zjs_framer_push(zjs_framer_t *framer, const uint8_t *data, uint32_t len)
+{
+    switch (framer->config.type) {
+    case ZJS_FRAMER_DELIMITER:
+        push_delimiter(framer, data, len);
+        break;
+    case ZJS_FRAMER_FIXED:
+        push_fixed(framer, data, len);
+        break;
+    case ZJS_FRAMER_LENGTH:
+        push_length(framer, data, len);
+        break;
+    case ZJS_FRAMER_SLIP:
+        push_slip(framer, data, len);
+        break;
+    case ZJS_FRAMER_COBS:
+        push_cobs(framer, data, len);
+        break;
+    }
+}
+
+void zjs_framer_reset(zjs_framer_t *framer)
+{
+    framer->len = 0;
+    framer->left = 0;
+    framer->prefix = 0;
+    framer->code = 0;
+    framer->escaped = false;
+    framer->discard = false;
+}
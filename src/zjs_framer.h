@@ -0,0 +1,88 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_framer_h__
+#define __zjs_framer_h__
+
+// Splits a byte stream into frames in native code, so serial protocols don't
+//   have to be parsed a byte at a time in JS. A framer is fed whatever chunks
+//   the stream delivers and calls back once per complete frame. It doesn't
+//   depend on JerryScript, so any module reading a byte stream can use it.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum zjs_framer_type {
+    ZJS_FRAMER_DELIMITER,   // frames end with a delimiter byte
+    ZJS_FRAMER_FIXED,       // frames are max_size bytes
+    ZJS_FRAMER_LENGTH,      // frames start with their length
+    ZJS_FRAMER_SLIP,        // RFC 1055 SLIP
+    ZJS_FRAMER_COBS,        // Consistent Overhead Byte Stuffing, 0 delimited
+};
+
+enum zjs_frame_error {
+    ZJS_FRAME_OVERFLOW = 1, // longer than max_size, dropped
+    ZJS_FRAME_CRC,          // failed the CRC check, dropped
+    ZJS_FRAME_ENCODING,     // invalid SLIP escape or truncated COBS, dropped
+};
+
+typedef struct zjs_framer_config {
+    uint8_t type;           // one of zjs_framer_type
+    uint8_t delimiter;      // DELIMITER: byte that ends a frame, not included
+    uint8_t prefix_size;    // LENGTH: 1, 2 or 4 byte payload length
+    bool little_endian;     // LENGTH: byte order of the prefix
+    bool crc16;             // frames end with a big-endian zjs_crc16 of the
+                            //   rest, which is checked and stripped
+    uint32_t max_size;      // longest frame kept, including any CRC; for
+                            //   FIXED, the size of every frame
+} zjs_framer_config_t;
+
+typedef struct zjs_framer zjs_framer_t;
+
+/**
+ * Called for each complete frame.
+ *
+ * @param ctx    Context given to zjs_framer_create
+ * @param frame  Frame contents, valid only during the call
+ * @param len    Length of the frame in bytes
+ */
+typedef void (*zjs_frame_cb)(void *ctx, const uint8_t *frame, uint32_t len);
+
+/**
+ * Called for each frame dropped because it was invalid.
+ *
+ * @param ctx    Context given to zjs_framer_create
+ * @param error  One of zjs_frame_error
+ */
+typedef void (*zjs_frame_error_cb)(void *ctx, uint8_t error);
+
+/**
+ * Create a framer.
+ *
+ * @param config    Framing to use
+ * @param on_frame  Called for each complete frame
+ * @param on_error  Called for each dropped frame, or NULL
+ * @param ctx       Passed to the callbacks
+ * @return A new framer to free with zjs_framer_free, or NULL if the config is
+ *           invalid or out of memory
+ */
+zjs_framer_t *zjs_framer_create(const zjs_framer_config_t *config,
+                                zjs_frame_cb on_frame,
+                                zjs_frame_error_cb on_error, void *ctx);
+
+/** Free a framer; not while it is calling back. */
+void zjs_framer_free(zjs_framer_t *framer);
+
+/**
+ * Feed bytes from the stream to a framer, which calls back for each frame
+ *   they complete. The rest is kept until the next push.
+ *
+ * @param framer  Framer to feed
+ * @param data    Next bytes of the stream
+ * @param len     Number of bytes in data
+ */
+void zjs_framer_push(zjs_framer_t *framer, const uint8_t *data, uint32_t len);
+
+/** Discard any partial frame, e.g. after the stream restarts. */
+void zjs_framer_reset(zjs_framer_t *framer);
+
+#endif  // __zjs_framer_h__
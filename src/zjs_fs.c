@@ -139,21 +139,19 @@ static uint16_t get_mode(char* str)
     return mode;
 }
 
+// native struct of a Stats object
+typedef struct fs_stats {
+    zjs_native_t native;
+    struct fs_dirent entry;
+} fs_stats_t;
+
 static jerry_value_t is_file(const jerry_value_t function_obj,
                              const jerry_value_t this,
                              const jerry_value_t argv[],
                              const jerry_length_t argc)
 {
-    struct fs_dirent* entry;
-
-    if (!jerry_get_object_native_handle(this, (uintptr_t*)&entry)) {
-        return zjs_error("native handle not found");
-    }
-    if (entry->type == FS_DIR_ENTRY_FILE) {
-        return jerry_create_boolean(true);
-    } else {
-        return jerry_create_boolean(false);
-    }
+    ZJS_GET_HANDLE(this, fs_stats_t, stats, FS_STATS);
+    return jerry_create_boolean(stats->entry.type == FS_DIR_ENTRY_FILE);
 }
 
 static jerry_value_t is_directory(const jerry_value_t function_obj,
@@ -161,38 +159,25 @@ static jerry_value_t is_directory(const jerry_value_t function_obj,
                                   const jerry_value_t argv[],
                                   const jerry_length_t argc)
 {
-    struct fs_dirent* entry;
-
-    if (!jerry_get_object_native_handle(this, (uintptr_t*)&entry)) {
-        return zjs_error("native handle not found");
-    }
-    if (entry->type == FS_DIR_ENTRY_DIR) {
-        return jerry_create_boolean(true);
-    } else {
-        return jerry_create_boolean(false);
-    }
+    ZJS_GET_HANDLE(this, fs_stats_t, stats, FS_STATS);
+    return jerry_create_boolean(stats->entry.type == FS_DIR_ENTRY_DIR);
 }
 
 static void free_stats(const uintptr_t native)
 {
-    struct zfs_dirent* entry = (struct zfs_dirent*)native;
-    if (entry) {
-        zjs_free(entry);
-    }
+    zjs_free((fs_stats_t *)native);
 }
 
 static jerry_value_t create_stats_obj(struct fs_dirent* entry)
 {
-
-    jerry_value_t stats_obj = jerry_create_object();
-
-    struct fs_dirent* new_entry = zjs_malloc(sizeof(struct fs_dirent));
-    if (!new_entry) {
+    fs_stats_t* stats = zjs_malloc(sizeof(fs_stats_t));
+    if (!stats) {
         return zjs_error("malloc failed");
     }
-    memcpy(new_entry, entry, sizeof(struct fs_dirent));
+    memcpy(&stats->entry, entry, sizeof(struct fs_dirent));
 
-    jerry_set_object_native_handle(stats_obj, (uintptr_t)new_entry, free_stats);
+    jerry_value_t stats_obj = jerry_create_object();
+    zjs_wrap(stats_obj, &stats->native, ZJS_CLASS_FS_STATS, free_stats);
 
     zjs_obj_add_function(stats_obj, is_file, "isFile");
     zjs_obj_add_function(stats_obj, is_directory, "isDirectory");
@@ -434,12 +419,18 @@ static jerry_value_t zjs_read(const jerry_value_t function_obj,
     }
 
     zjs_buffer_t* buffer = zjs_buffer_find(argv[1]);
+    if (!buffer) {
+        return TYPE_ERROR("expected buffer");
+    }
     double offset = jerry_get_number_value(argv[2]);
     double length = jerry_get_number_value(argv[3]);
 
     if (offset < 0 || length < 0) {
         return invalid_args();
     }
+    if (zjs_buffer_is_readonly(buffer)) {
+        return zjs_error("buffer is read-only");
+    }
     if (offset >= buffer->bufsize) {
         return zjs_error("offset overflows buffer");
     }
@@ -548,6 +539,9 @@ static jerry_value_t zjs_write(const jerry_value_t function_obj,
     }
 
     zjs_buffer_t* buffer = zjs_buffer_find(argv[1]);
+    if (!buffer) {
+        return TYPE_ERROR("expected buffer");
+    }
 
     switch (optcount) {
     case 3:
@@ -958,6 +952,9 @@ static jerry_value_t zjs_write_file(const jerry_value_t function_obj,
         length = size;
     } else {
         zjs_buffer_t* buffer = zjs_buffer_find(argv[1]);
+        if (!buffer) {
+            return TYPE_ERROR("expected buffer or string");
+        }
         data = buffer->buffer;
         length = buffer->bufsize;
         is_buf = 1;
@@ -5,6 +5,7 @@
 #include <zephyr.h>
 #include <gpio.h>
 #include <misc/util.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -34,13 +35,21 @@ static const char *ZJS_PULL_DOWN = "down";
 
 static struct device *zjs_gpio_dev[GPIO_DEV_COUNT];
 
+// longest busy wait allowed between the steps of a port sequence, since it
+//   stalls everything else
+#ifndef ZJS_GPIO_SEQUENCE_MAX_DELAY
+#define ZJS_GPIO_SEQUENCE_MAX_DELAY 10000
+#endif
+
 static jerry_value_t zjs_gpio_pin_prototype;
+static jerry_value_t zjs_gpio_port_prototype;
 
 void (*zjs_gpio_convert_pin)(uint32_t orig, int *dev, int *pin) =
     zjs_default_convert_pin;
 
 // Handle for GPIO input pins, passed around between ISR/C callbacks
 typedef struct gpio_handle {
+    zjs_native_t native;
     struct gpio_callback callback;  // Callback structure for zephyr
     uint32_t pin;                   // Pin associated with this handle
     struct device *port;            // Pin's port
@@ -53,6 +62,24 @@ typedef struct gpio_handle {
     bool closed;
 } gpio_handle_t;
 
+// Handle for GPIO ports, which read and write several pins of one device
+typedef struct gpio_port_handle {
+    zjs_native_t native;
+    struct device *port;
+    uint32_t pins;                  // mask of the pins openPort configured
+    uint32_t active_low;            // mask of the pins that are active low
+    bool output;
+    bool by_pin;                    // driver lacks port access, go pin by pin
+    bool closed;
+} gpio_port_handle_t;
+
+// one write of a port sequence
+typedef struct gpio_step {
+    uint32_t mask;
+    uint32_t levels;
+    uint32_t delay;                 // microseconds to wait after the write
+} gpio_step_t;
+
 static jerry_value_t lookup_pin(const jerry_value_t pin_obj,
                                 struct device **port, int *pin)
 {
@@ -108,7 +135,8 @@ static void zjs_gpio_c_callback(void *h, void *args)
         ERR_PRINT("unexpected callback after close");
         return;
     }
-    jerry_value_t onchange_func = zjs_get_property(handle->pin_obj, "onchange");
+    jerry_value_t onchange_func = jerry_get_property(handle->pin_obj,
+                                                     ZJS_PROP(onchange));
 
     // If pin.onChange exists, call it
     if (jerry_value_is_function(onchange_func)) {
@@ -116,7 +144,7 @@ static void zjs_gpio_c_callback(void *h, void *args)
         uint32_t val = 0;
         memcpy(&val, args, 4);
         // Put the boolean GPIO trigger value in the object
-        zjs_obj_add_boolean(event, val, "value");
+        zjs_obj_add_boolean_prop(event, val, ZJS_PROP(value));
 
         // Call the JS callback
         jerry_call_function(onchange_func, ZJS_UNDEFINED, &event, 1);
@@ -155,28 +183,18 @@ static jerry_value_t zjs_gpio_pin_read(const jerry_value_t function_obj,
 {
     // requires: this is a GPIOPin object from zjs_gpio_open, takes no args
     //  effects: reads a logical value from the pin and returns it in ret_val_p
-    uintptr_t ptr;
-    if (jerry_get_object_native_handle(this, &ptr)) {
-        gpio_handle_t *handle = (gpio_handle_t *)ptr;
-        if (handle->closed) {
-            return zjs_error("zjs_gpio_pin_read: pin closed");
-        }
+    ZJS_GET_HANDLE(this, gpio_handle_t, handle, GPIO_PIN);
+    if (handle->closed) {
+        return zjs_error("zjs_gpio_pin_read: pin closed");
     }
 
-    int newpin;
-    struct device *gpiodev;
-    jerry_value_t status = lookup_pin(this, &gpiodev, &newpin);
-    if (!jerry_value_is_undefined(status))
-        return status;
-    jerry_release_value(status);
-
     bool activeLow = false;
     zjs_obj_get_boolean(this, "activeLow", &activeLow);
 
     uint32_t value;
-    int rval = gpio_pin_read(gpiodev, newpin, &value);
+    int rval = gpio_pin_read(handle->port, handle->pin, &value);
     if (rval) {
-        ERR_PRINT("PIN: #%d\n", newpin);
+        ERR_PRINT("PIN: #%d\n", handle->pin);
         return zjs_error("zjs_gpio_pin_read: reading from GPIO");
     }
 
@@ -199,32 +217,22 @@ static jerry_value_t zjs_gpio_pin_write(const jerry_value_t function_obj,
     // args: pin value
     ZJS_VALIDATE_ARGS(Z_BOOL);
 
-    uintptr_t ptr;
-    if (jerry_get_object_native_handle(this, &ptr)) {
-        gpio_handle_t *handle = (gpio_handle_t *)ptr;
-        if (handle->closed) {
-            return zjs_error("zjs_gpio_pin_write: pin closed");
-        }
+    ZJS_GET_HANDLE(this, gpio_handle_t, handle, GPIO_PIN);
+    if (handle->closed) {
+        return zjs_error("zjs_gpio_pin_write: pin closed");
     }
 
     bool logical = jerry_get_boolean_value(argv[0]);
 
-    int newpin;
-    struct device *gpiodev;
-    jerry_value_t status = lookup_pin(this, &gpiodev, &newpin);
-    if (!jerry_value_is_undefined(status))
-        return status;
-    jerry_release_value(status);
-
     bool activeLow = false;
     zjs_obj_get_boolean(this, "activeLow", &activeLow);
 
     uint32_t value = 0;
     if ((logical && !activeLow) || (!logical && activeLow))
         value = 1;
-    int rval = gpio_pin_write(gpiodev, newpin, value);
+    int rval = gpio_pin_write(handle->port, handle->pin, value);
     if (rval) {
-        ERR_PRINT("GPIO: #%d!n", newpin);
+        ERR_PRINT("GPIO: #%d!n", handle->pin);
         return zjs_error("zjs_gpio_pin_write: error writing to GPIO");
     }
 
@@ -243,17 +251,12 @@ static jerry_value_t zjs_gpio_pin_close(const jerry_value_t function_obj,
                                         const jerry_value_t argv[],
                                         const jerry_length_t argc)
 {
-    uintptr_t ptr;
-    if (jerry_get_object_native_handle(this, &ptr)) {
-        gpio_handle_t *handle = (gpio_handle_t *)ptr;
-        if (handle->closed)
-            return zjs_error("zjs_gpio_pin_close: already closed");
-
-        zjs_gpio_close(handle);
-        return ZJS_UNDEFINED;
-    }
+    ZJS_GET_HANDLE(this, gpio_handle_t, handle, GPIO_PIN);
+    if (handle->closed)
+        return zjs_error("zjs_gpio_pin_close: already closed");
 
-    return zjs_error("zjs_gpio_pin_close: no native handle");
+    zjs_gpio_close(handle);
+    return ZJS_UNDEFINED;
 }
 
 static void zjs_gpio_free_cb(const uintptr_t native)
@@ -377,6 +380,10 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
     jerry_release_value(pin);
 
     gpio_handle_t *handle = zjs_malloc(sizeof(gpio_handle_t));
+    if (!handle) {
+        jerry_release_value(pinobj);
+        return zjs_error("zjs_gpio_open: out of memory");
+    }
     memset(handle, 0, sizeof(gpio_handle_t));
     handle->pin = newpin;
     handle->pin_obj = async ? jerry_acquire_value(pinobj) : pinobj;
@@ -384,7 +391,7 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
     handle->callbackId = -1;
 
     // Set the native handle so we can free it when close() is called
-    jerry_set_object_native_handle(pinobj, (uintptr_t)handle, zjs_gpio_free_cb);
+    zjs_wrap(pinobj, &handle->native, ZJS_CLASS_GPIO_PIN, zjs_gpio_free_cb);
 
     if (!dirOut) {
         // Zephyr ISR callback init
@@ -395,6 +402,7 @@ static jerry_value_t zjs_gpio_open(const jerry_value_t function_obj,
 
         // Register a C callback (will be called after the ISR is called)
         handle->callbackId = zjs_add_c_callback(handle, zjs_gpio_c_callback);
+        zjs_set_callback_source(handle->callbackId, "gpio", "onchange");
 
         if (!strcmp(edge, ZJS_EDGE_BOTH)) {
             handle->edge_both = 1;
@@ -444,6 +452,340 @@ static jerry_value_t zjs_gpio_open_async(const jerry_value_t function_obj,
     return zjs_gpio_open(function_obj, this, argv, argc, true);
 }
 
+static uint32_t get_mask(jerry_value_t value)
+{
+    // requires: value is a number
+    //  effects: returns it as 32 pin bits; masks built with JS bitwise
+    //             operators are signed, so bit 31 arrives as a negative number
+    return (uint32_t)(int64_t)jerry_get_number_value(value);
+}
+
+static int port_read(gpio_port_handle_t *handle, uint32_t *levels)
+{
+    // effects: reads the levels of the port's pins into the matching bits of
+    //            *levels, with one driver call if the driver supports it;
+    //            returns 0 on success or a driver error
+    if (!handle->by_pin) {
+        int rval = gpio_port_read(handle->port, levels);
+        if (rval != -ENOTSUP) {
+            return rval;
+        }
+        handle->by_pin = true;
+    }
+
+    uint32_t bits = 0;
+    for (uint32_t left = handle->pins; left; left &= left - 1) {
+        int pin = __builtin_ctz(left);
+        uint32_t value;
+        int rval = gpio_pin_read(handle->port, pin, &value);
+        if (rval) {
+            return rval;
+        }
+        if (value) {
+            bits |= 1u << pin;
+        }
+    }
+    *levels = bits;
+    return 0;
+}
+
+static int port_write(gpio_port_handle_t *handle, uint32_t mask,
+                      uint32_t levels)
+{
+    // requires: mask only has bits of the port's pins
+    //  effects: drives the pins in mask to the matching bits of levels, with
+    //             one read-modify-write of the whole port if the driver
+    //             supports it, so the other pins of the device keep their
+    //             levels; returns 0 on success or a driver error
+    if (!handle->by_pin) {
+        // keep an ISR from writing the port between the read and the write;
+        //   the driver is called with interrupts locked, so this only suits
+        //   SoC GPIO drivers, not expanders that sleep on a bus transfer
+        unsigned int key = irq_lock();
+        uint32_t current;
+        int rval = gpio_port_read(handle->port, &current);
+        if (!rval) {
+            rval = gpio_port_write(handle->port,
+                                   (current & ~mask) | (levels & mask));
+        }
+        irq_unlock(key);
+        if (rval != -ENOTSUP) {
+            return rval;
+        }
+        handle->by_pin = true;
+    }
+
+    for (uint32_t left = mask; left; left &= left - 1) {
+        int pin = __builtin_ctz(left);
+        int rval = gpio_pin_write(handle->port, pin, (levels >> pin) & 1);
+        if (rval) {
+            return rval;
+        }
+    }
+    return 0;
+}
+
+static jerry_value_t zjs_gpio_port_read(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    // requires: this is a GPIOPort object from zjs_gpio_open_port, takes no
+    //             args
+    //  effects: returns the logical values of all the port's pins as a
+    //             mask, with a bit set for each active pin; signed like the
+    //             result of JS bitwise operators, so pin 31 reads as 1 << 31
+    ZJS_GET_HANDLE(this, gpio_port_handle_t, handle, GPIO_PORT);
+    if (handle->closed) {
+        return zjs_error("zjs_gpio_port_read: port closed");
+    }
+
+    uint32_t levels;
+    if (port_read(handle, &levels)) {
+        return zjs_error("zjs_gpio_port_read: reading from GPIO");
+    }
+    uint32_t mask = (levels ^ handle->active_low) & handle->pins;
+    return jerry_create_number((int32_t)mask);
+}
+
+static jerry_value_t zjs_gpio_port_write(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // requires: this is a GPIOPort object from zjs_gpio_open_port, takes two
+    //             args, a mask of the pins to write and a mask with the
+    //             logical values for them (bit set = active)
+    //  effects: writes the pins in the mask together, leaving the others
+
+    // args: pin mask, values
+    ZJS_VALIDATE_ARGS(Z_NUMBER, Z_NUMBER);
+
+    ZJS_GET_HANDLE(this, gpio_port_handle_t, handle, GPIO_PORT);
+    if (handle->closed) {
+        return zjs_error("zjs_gpio_port_write: port closed");
+    }
+    if (!handle->output) {
+        return zjs_error("zjs_gpio_port_write: port is not an output");
+    }
+
+    uint32_t mask = get_mask(argv[0]);
+    if (mask & ~handle->pins) {
+        return RANGE_ERROR("mask has pins the port doesn't own");
+    }
+
+    uint32_t levels = get_mask(argv[1]) ^ handle->active_low;
+    if (port_write(handle, mask, levels)) {
+        return zjs_error("zjs_gpio_port_write: error writing to GPIO");
+    }
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t zjs_gpio_port_sequence(const jerry_value_t function_obj,
+                                            const jerry_value_t this,
+                                            const jerry_value_t argv[],
+                                            const jerry_length_t argc)
+{
+    // requires: this is a GPIOPort object from zjs_gpio_open_port, takes one
+    //             arg, an array of steps of three numbers each: a mask of the
+    //             pins to write, their logical values as for write, and the
+    //             microseconds to wait after the write
+    //  effects: validates all the steps, then performs them back to back
+
+    // args: steps
+    ZJS_VALIDATE_ARGS(Z_ARRAY);
+
+    ZJS_GET_HANDLE(this, gpio_port_handle_t, handle, GPIO_PORT);
+    if (handle->closed) {
+        return zjs_error("zjs_gpio_port_sequence: port closed");
+    }
+    if (!handle->output) {
+        return zjs_error("zjs_gpio_port_sequence: port is not an output");
+    }
+
+    uint32_t len = jerry_get_array_length(argv[0]);
+    if (len % 3) {
+        return RANGE_ERROR("expected three numbers per step");
+    }
+    uint32_t count = len / 3;
+    if (!count) {
+        return ZJS_UNDEFINED;
+    }
+
+    // convert the steps up front so the writes run without gaps from the VM
+    gpio_step_t *steps = zjs_malloc(count * sizeof(gpio_step_t));
+    if (!steps) {
+        return zjs_error("zjs_gpio_port_sequence: out of memory");
+    }
+    jerry_value_t error = ZJS_UNDEFINED;
+    for (uint32_t i = 0; i < len; i++) {
+        jerry_value_t item = jerry_get_property_by_index(argv[0], i);
+        bool valid = jerry_value_is_number(item);
+        uint32_t num = valid ? get_mask(item) : 0;
+        jerry_release_value(item);
+        if (!valid) {
+            error = TYPE_ERROR("sequence steps must be numbers");
+            break;
+        }
+
+        gpio_step_t *step = &steps[i / 3];
+        if (i % 3 == 0) {
+            if (num & ~handle->pins) {
+                error = RANGE_ERROR("mask has pins the port doesn't own");
+                break;
+            }
+            step->mask = num;
+        } else if (i % 3 == 1) {
+            step->levels = num ^ handle->active_low;
+        } else {
+            if (num > ZJS_GPIO_SEQUENCE_MAX_DELAY) {
+                error = RANGE_ERROR("sequence delay too long");
+                break;
+            }
+            step->delay = num;
+        }
+    }
+
+    if (jerry_value_is_undefined(error)) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (port_write(handle, steps[i].mask, steps[i].levels)) {
+                ERR_PRINT("failed at step %u\n", i);
+                error = zjs_error("zjs_gpio_port_sequence: error writing to "
+                                  "GPIO");
+                break;
+            }
+            if (steps[i].delay) {
+                k_busy_wait(steps[i].delay);
+            }
+        }
+    }
+    zjs_free(steps);
+    return error;
+}
+
+static jerry_value_t zjs_gpio_port_close(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    ZJS_GET_HANDLE(this, gpio_port_handle_t, handle, GPIO_PORT);
+    if (handle->closed)
+        return zjs_error("zjs_gpio_port_close: already closed");
+
+    handle->closed = true;
+    return ZJS_UNDEFINED;
+}
+
+static void zjs_gpio_port_free_cb(const uintptr_t native)
+{
+    zjs_free((gpio_port_handle_t *)native);
+}
+
+static jerry_value_t zjs_gpio_open_port(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    // requires: arg 0 is an object with these members: pins (mask of pins),
+    //             port (GPIO device name or index, defaults to 0), direction
+    //             (defaults to "out"), activeLow (mask, defaults to 0),
+    //             pull (defaults to "none")
+    //  effects: configures the pins and returns a GPIOPort object for them
+
+    // args: initialization object
+    ZJS_VALIDATE_ARGS(Z_OBJECT);
+
+    jerry_value_t data = argv[0];
+
+    jerry_value_t value = zjs_get_property(data, "pins");
+    bool valid = jerry_value_is_number(value);
+    uint32_t pins = valid ? get_mask(value) : 0;
+    jerry_release_value(value);
+    if (!pins) {
+        return zjs_error("zjs_gpio_open_port: missing pins mask");
+    }
+
+    uint32_t active_low = 0;
+    value = zjs_get_property(data, "activeLow");
+    if (jerry_value_is_number(value)) {
+        active_low = get_mask(value) & pins;
+    }
+    jerry_release_value(value);
+
+    struct device *gpiodev = NULL;
+    char name[32];
+    uint32_t index = 0;
+    if (zjs_obj_get_string(data, "port", name, sizeof(name))) {
+        // Zephyr's device name for the port, e.g. GPIO_0
+        gpiodev = device_get_binding(name);
+    } else {
+        zjs_obj_get_uint32(data, "port", &index);
+        if (index < GPIO_DEV_COUNT) {
+            gpiodev = zjs_gpio_dev[index];
+        }
+    }
+    if (!gpiodev) {
+        return zjs_error("zjs_gpio_open_port: cannot find GPIO device");
+    }
+
+    bool dirOut = true;
+    const int BUFLEN = 10;
+    char buffer[BUFLEN];
+    if (zjs_obj_get_string(data, "direction", buffer, BUFLEN)) {
+        if (!strcmp(buffer, ZJS_DIR_IN))
+            dirOut = false;
+    }
+
+    // active low is handled here rather than with GPIO_POL_INV, so port
+    //   reads and writes of raw levels stay consistent across drivers
+    int flags = dirOut ? GPIO_DIR_OUT : GPIO_DIR_IN;
+    const char *pull = ZJS_PULL_NONE;
+    if (zjs_obj_get_string(data, "pull", buffer, BUFLEN)) {
+        if (!strcmp(buffer, ZJS_PULL_UP)) {
+            pull = ZJS_PULL_UP;
+            flags |= GPIO_PUD_PULL_UP;
+        }
+        else if (!strcmp(buffer, ZJS_PULL_DOWN)) {
+            pull = ZJS_PULL_DOWN;
+            flags |= GPIO_PUD_PULL_DOWN;
+        }
+    }
+    if (pull == ZJS_PULL_NONE)
+        flags |= GPIO_PUD_NORMAL;
+
+    // configure just these pins; gpio_port_configure would take all 32
+    for (uint32_t left = pins; left; left &= left - 1) {
+        int pin = __builtin_ctz(left);
+        int rval = gpio_pin_configure(gpiodev, pin, flags);
+        if (rval) {
+            ERR_PRINT("GPIO: #%d (RVAL: %d)\n", pin, rval);
+            return zjs_error("zjs_gpio_open_port: error opening GPIO pin");
+        }
+    }
+
+    gpio_port_handle_t *handle = zjs_malloc(sizeof(gpio_port_handle_t));
+    if (!handle) {
+        return zjs_error("zjs_gpio_open_port: out of memory");
+    }
+    memset(handle, 0, sizeof(gpio_port_handle_t));
+    handle->port = gpiodev;
+    handle->pins = pins;
+    handle->active_low = active_low;
+    handle->output = dirOut;
+
+    // create the GPIOPort object
+    jerry_value_t portobj = jerry_create_object();
+    jerry_set_prototype(portobj, zjs_gpio_port_prototype);
+    zjs_obj_add_readonly_number(portobj, pins, "pins");
+    zjs_obj_add_readonly_number(portobj, active_low, "activeLow");
+    zjs_obj_add_string(portobj, dirOut ? ZJS_DIR_OUT : ZJS_DIR_IN,
+                       "direction");
+    zjs_obj_add_string(portobj, pull, "pull");
+    zjs_wrap(portobj, &handle->native, ZJS_CLASS_GPIO_PORT,
+             zjs_gpio_port_free_cb);
+    return portobj;
+}
+
 jerry_value_t zjs_gpio_init()
 {
     // effects: finds the GPIO driver and returns the GPIO JS object
@@ -467,16 +809,29 @@ jerry_value_t zjs_gpio_init()
     zjs_gpio_pin_prototype = jerry_create_object();
     zjs_obj_add_functions(zjs_gpio_pin_prototype, array);
 
+    // create GPIO port prototype object
+    zjs_native_func_t port_array[] = {
+        { zjs_gpio_port_read, "read" },
+        { zjs_gpio_port_write, "write" },
+        { zjs_gpio_port_sequence, "sequence" },
+        { zjs_gpio_port_close, "close" },
+        { NULL, NULL }
+    };
+    zjs_gpio_port_prototype = jerry_create_object();
+    zjs_obj_add_functions(zjs_gpio_port_prototype, port_array);
+
     // create GPIO object
     jerry_value_t gpio_obj = jerry_create_object();
     zjs_obj_add_function(gpio_obj, zjs_gpio_open_sync, "open");
     zjs_obj_add_function(gpio_obj, zjs_gpio_open_async, "openAsync");
+    zjs_obj_add_function(gpio_obj, zjs_gpio_open_port, "openPort");
     return gpio_obj;
 }
 
 void zjs_gpio_cleanup()
 {
     jerry_release_value(zjs_gpio_pin_prototype);
+    jerry_release_value(zjs_gpio_port_prototype);
 }
 
 #endif // BUILD_MODULE_GPIO
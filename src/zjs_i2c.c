@@ -155,6 +155,9 @@ static jerry_value_t zjs_i2c_write(const jerry_value_t function_obj,
 
     if (dataBuf != NULL) {
         if (register_addr != 0) {
+            if (zjs_buffer_is_readonly(dataBuf)) {
+                return zjs_error("zjs_i2c_write: data buffer is read-only");
+            }
             // If the user supplied a register address, add it to the beginning
             // of the buffer, as that's where i2c_write will expect it.
             dataBuf->buffer[0] = (uint8_t)register_addr;
@@ -24,6 +24,14 @@ uint8_t zjs_port_timer_test(zjs_port_timer_t* timer);
 
 uint32_t zjs_port_timer_get_uptime(void);
 
+// free running high resolution counter, only differences between two readings
+//   are meaningful; on Linux it counts nanoseconds
+typedef uint64_t zjs_port_cycles_t;
+
+zjs_port_cycles_t zjs_port_get_cycles(void);
+
+#define zjs_port_cycles_to_ns(c) ((uint64_t)(c))
+
 #define ZJS_TICKS_NONE          0
 #define CONFIG_SYS_CLOCK_TICKS_PER_SEC 100
 #define zjs_sleep usleep
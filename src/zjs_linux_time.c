@@ -42,3 +42,12 @@ uint32_t zjs_port_timer_get_uptime(void)
 
     return (1000 * now.tv_sec) + (now.tv_nsec / 1000000);
 }
+
+zjs_port_cycles_t zjs_port_get_cycles(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
@@ -0,0 +1,254 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifdef BUILD_MODULE_UART
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+// ZJS includes
+#include "zjs_linux_uart.h"
+#include "zjs_util.h"
+
+struct device {
+    int fd;                 // pty master, non-blocking
+    int slave_fd;           // held open so the master never sees a hangup
+    int wake[2];            // pipe to rouse the thread after an irq change
+    pthread_t thread;
+    pthread_mutex_t lock;   // held while the handler runs
+    uart_irq_callback_t cb;
+    bool running;
+    bool rx_enabled;
+    bool tx_enabled;
+    bool rx_ready;          // state for the current call of the handler
+    bool tx_ready;
+};
+
+static struct device uart0;
+static bool uart0_open = false;
+static const char *link_path = NULL;
+
+static bool in_isr(struct device *dev)
+{
+    // the handler calls the irq functions too, with the lock already held
+    return pthread_equal(pthread_self(), dev->thread);
+}
+
+static void irq_set(struct device *dev, bool *flag, bool on)
+{
+    bool isr = in_isr(dev);
+    if (!isr) {
+        pthread_mutex_lock(&dev->lock);
+    }
+    *flag = on;
+    if (!isr) {
+        pthread_mutex_unlock(&dev->lock);
+        // poll again with the new events
+        char c = 0;
+        if (write(dev->wake[1], &c, 1) < 0) {
+            DBG_PRINT("failed to wake UART thread\n");
+        }
+    }
+}
+
+static void *irq_thread(void *arg)
+{
+    struct device *dev = (struct device *)arg;
+    while (1) {
+        pthread_mutex_lock(&dev->lock);
+        bool running = dev->running;
+        short events = (dev->rx_enabled ? POLLIN : 0) |
+                       (dev->tx_enabled ? POLLOUT : 0);
+        pthread_mutex_unlock(&dev->lock);
+        if (!running) {
+            break;
+        }
+
+        struct pollfd fds[2] = {
+            { dev->fd, events, 0 },
+            { dev->wake[0], POLLIN, 0 }
+        };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ERR_PRINT("UART poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            char buf[16];
+            while (read(dev->wake[0], buf, sizeof(buf)) > 0);
+        }
+
+        // the "interrupt"
+        pthread_mutex_lock(&dev->lock);
+        dev->rx_ready = dev->rx_enabled && (fds[0].revents & POLLIN);
+        dev->tx_ready = dev->tx_enabled && (fds[0].revents & POLLOUT);
+        if (dev->cb && (dev->rx_ready || dev->tx_ready)) {
+            dev->cb(dev);
+        }
+        dev->rx_ready = dev->tx_ready = false;
+        pthread_mutex_unlock(&dev->lock);
+    }
+    return NULL;
+}
+
+static bool uart_open(struct device *dev)
+{
+    memset(dev, 0, sizeof(struct device));
+    dev->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (dev->fd < 0 || grantpt(dev->fd) || unlockpt(dev->fd)) {
+        ERR_PRINT("unable to create pty for UART\n");
+        goto fail_fd;
+    }
+
+    // raw bytes both ways, as on a real UART
+    const char *name = ptsname(dev->fd);
+    dev->slave_fd = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+    if (dev->slave_fd < 0) {
+        ERR_PRINT("unable to open pty for UART\n");
+        goto fail_fd;
+    }
+    struct termios tio;
+    if (!tcgetattr(dev->slave_fd, &tio)) {
+        cfmakeraw(&tio);
+        tcsetattr(dev->slave_fd, TCSANOW, &tio);
+    }
+
+    if (pipe(dev->wake)) {
+        goto fail_slave;
+    }
+    fcntl(dev->wake[0], F_SETFL, O_NONBLOCK);
+
+    pthread_mutex_init(&dev->lock, NULL);
+    dev->running = true;
+    if (pthread_create(&dev->thread, NULL, irq_thread, dev)) {
+        ERR_PRINT("unable to start UART thread\n");
+        goto fail_pipe;
+    }
+
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(name, link_path)) {
+            ERR_PRINT("unable to link %s to %s\n", link_path, name);
+        }
+    }
+    ZJS_PRINT("UART_0 is %s\n", link_path ? link_path : name);
+    return true;
+
+fail_pipe:
+    pthread_mutex_destroy(&dev->lock);
+    close(dev->wake[0]);
+    close(dev->wake[1]);
+fail_slave:
+    close(dev->slave_fd);
+fail_fd:
+    if (dev->fd >= 0) {
+        close(dev->fd);
+    }
+    return false;
+}
+
+struct device *device_get_binding(char *name)
+{
+    if (strcmp(name, "UART_0")) {
+        return NULL;
+    }
+    if (!uart0_open) {
+        if (!uart_open(&uart0)) {
+            return NULL;
+        }
+        uart0_open = true;
+    }
+    return &uart0;
+}
+
+int uart_fifo_read(struct device *dev, uint8_t *rx_data, const int size)
+{
+    ssize_t len = read(dev->fd, rx_data, size);
+    return len > 0 ? len : 0;
+}
+
+int uart_fifo_fill(struct device *dev, const uint8_t *tx_data, int size)
+{
+    ssize_t len = write(dev->fd, tx_data, size);
+    return len > 0 ? len : 0;
+}
+
+void uart_irq_rx_enable(struct device *dev)
+{
+    irq_set(dev, &dev->rx_enabled, true);
+}
+
+void uart_irq_rx_disable(struct device *dev)
+{
+    irq_set(dev, &dev->rx_enabled, false);
+}
+
+void uart_irq_tx_enable(struct device *dev)
+{
+    irq_set(dev, &dev->tx_enabled, true);
+}
+
+void uart_irq_tx_disable(struct device *dev)
+{
+    irq_set(dev, &dev->tx_enabled, false);
+}
+
+int uart_irq_rx_ready(struct device *dev)
+{
+    return dev->rx_ready;
+}
+
+int uart_irq_tx_ready(struct device *dev)
+{
+    return dev->tx_ready;
+}
+
+int uart_irq_is_pending(struct device *dev)
+{
+    return dev->rx_ready || dev->tx_ready;
+}
+
+int uart_irq_update(struct device *dev)
+{
+    return 1;
+}
+
+void uart_irq_callback_set(struct device *dev, uart_irq_callback_t cb)
+{
+    pthread_mutex_lock(&dev->lock);
+    dev->cb = cb;
+    pthread_mutex_unlock(&dev->lock);
+}
+
+void zjs_linux_uart_set_link(const char *path)
+{
+    link_path = path;
+}
+
+void zjs_linux_uart_close(struct device *dev)
+{
+    if (dev != &uart0 || !uart0_open) {
+        return;
+    }
+    irq_set(dev, &dev->running, false);
+    pthread_join(dev->thread, NULL);
+    pthread_mutex_destroy(&dev->lock);
+    close(dev->wake[0]);
+    close(dev->wake[1]);
+    close(dev->slave_fd);
+    close(dev->fd);
+    if (link_path) {
+        unlink(link_path);
+    }
+    uart0_open = false;
+}
+
+#endif  // BUILD_MODULE_UART
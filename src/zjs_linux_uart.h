@@ -0,0 +1,56 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_linux_uart_h__
+#define __zjs_linux_uart_h__
+
+// The subset of the Zephyr interrupt-driven UART API that zjs_uart.c uses,
+//   backed on Linux by a pseudo-terminal. A thread stands in for the UART
+//   interrupt: it waits for the pty to become readable or, while the TX
+//   interrupt is enabled, writable, and then calls the handler. The handler
+//   runs with a lock held that the irq enable/disable calls also take, so
+//   like a real ISR it never overlaps them.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct device;
+
+typedef void (*uart_irq_callback_t)(struct device *dev);
+
+/**
+ * Get the UART with the given Zephyr device name; "UART_0" is the only one.
+ *   The pty is created the first time and its name printed.
+ *
+ * @param name  Device name
+ * @return The device, or NULL if there is no such UART or the pty failed
+ */
+struct device *device_get_binding(char *name);
+
+int uart_fifo_read(struct device *dev, uint8_t *rx_data, const int size);
+int uart_fifo_fill(struct device *dev, const uint8_t *tx_data, int size);
+void uart_irq_rx_enable(struct device *dev);
+void uart_irq_rx_disable(struct device *dev);
+void uart_irq_tx_enable(struct device *dev);
+void uart_irq_tx_disable(struct device *dev);
+int uart_irq_rx_ready(struct device *dev);
+int uart_irq_tx_ready(struct device *dev);
+int uart_irq_is_pending(struct device *dev);
+int uart_irq_update(struct device *dev);
+void uart_irq_callback_set(struct device *dev, uart_irq_callback_t cb);
+
+/**
+ * Make a symlink to the pty at path when the UART is opened, so a test
+ *   harness can find it, e.g. with --uart-pty.
+ *
+ * @param path  Where to create the link
+ */
+void zjs_linux_uart_set_link(const char *path);
+
+/**
+ * Stop the interrupt thread and close the pty.
+ *
+ * @param dev  Device from device_get_binding
+ */
+void zjs_linux_uart_close(struct device *dev);
+
+#endif  // __zjs_linux_uart_h__
@@ -23,6 +23,9 @@
 #include "zjs_sensor.h"
 #endif
 #include "zjs_timers.h"
+#ifdef BUILD_MODULE_UART
+#include "zjs_uart.h"
+#endif
 #include "zjs_util.h"
 #ifdef BUILD_MODULE_OCF
 #include "zjs_ocf_common.h"
@@ -30,6 +33,12 @@
 #ifdef BUILD_MODULE_TEST_PROMISE
 #include "zjs_test_promise.h"
 #endif
+#ifdef BUILD_MODULE_TEST_BUFFER
+#include "zjs_test_buffer.h"
+#endif
+#ifdef ZJS_WATCHDOG
+#include "zjs_watchdog.h"
+#endif
 
 #ifndef ZJS_LINUX_BUILD
 #include "zjs_aio.h"
@@ -38,7 +47,6 @@
 #include "zjs_grove_lcd.h"
 #include "zjs_i2c.h"
 #include "zjs_pwm.h"
-#include "zjs_uart.h"
 #include "zjs_fs.h"
 #ifdef CONFIG_BOARD_ARDUINO_101
 #include "zjs_a101_pins.h"
@@ -96,10 +104,11 @@ module_t zjs_modules_array[] = {
     { "k64f_pins", zjs_k64f_init },
 #endif
 #endif // QEMU_BUILD
+#endif // ZJS_LINUX_BUILD
 #ifdef BUILD_MODULE_UART
+    // on Linux, backed by a pty
     { "uart", zjs_uart_init, zjs_uart_cleanup },
 #endif
-#endif // ZJS_LINUX_BUILD
 #ifdef BUILD_MODULE_DGRAM
     { "dgram", zjs_dgram_init, zjs_dgram_cleanup },
 #endif
@@ -112,8 +121,14 @@ module_t zjs_modules_array[] = {
 #ifdef BUILD_MODULE_OCF
     { "ocf", zjs_ocf_init },
 #endif
+#ifdef ZJS_WATCHDOG
+    { "watchdog", zjs_watchdog_init, zjs_watchdog_cleanup },
+#endif
 #ifdef BUILD_MODULE_TEST_PROMISE
-    { "test_promise", zjs_test_promise_init }
+    { "test_promise", zjs_test_promise_init },
+#endif
+#ifdef BUILD_MODULE_TEST_BUFFER
+    { "test_buffer", zjs_test_buffer_init },
 #endif
 };
 
@@ -9,7 +9,7 @@
 
 #include "jerry-api.h"
 
-#define NUM_SERVICE_ROUTINES 3
+#define NUM_SERVICE_ROUTINES 4
 
 /**
  * Service routine function type
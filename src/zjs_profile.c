@@ -0,0 +1,160 @@
+// Copyright (c) 2017, Intel Corporation.
+#ifdef ZJS_PROFILE_NATIVE
+
+#include <string.h>
+
+#ifndef ZJS_LINUX_BUILD
+#include "zjs_zephyr_port.h"
+#else
+#include "zjs_linux_port.h"
+#endif
+
+// ZJS includes
+#ifdef BUILD_MODULE_BUFFER
+#include "zjs_buffer.h"
+#endif
+#include "zjs_profile.h"
+#include "zjs_util.h"
+
+// running total of bytes requested with zjs_malloc
+uint32_t zjs_profile_alloc_bytes = 0;
+
+typedef struct profile_entry {
+    jerry_external_handler_t func;
+    const char *name;
+    uint32_t calls;
+    uint32_t bytes;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    struct profile_entry *next;
+} profile_entry_t;
+
+static profile_entry_t *profile_list = NULL;
+
+static profile_entry_t *profile_get_entry(void *func, const char *name)
+{
+    // effects: returns the entry for func registered as name, creating it if
+    //            this is the first registration; modules that add the same
+    //            functions to every object they create share one entry
+    profile_entry_t *entry = profile_list;
+    while (entry) {
+        if (entry->func == func && entry->name == name) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+
+    entry = zjs_malloc(sizeof(profile_entry_t));
+    if (!entry) {
+        return NULL;
+    }
+    memset(entry, 0, sizeof(profile_entry_t));
+    entry->func = func;
+    entry->name = name;
+    entry->next = profile_list;
+    profile_list = entry;
+    return entry;
+}
+
+static jerry_value_t profile_handler(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    uintptr_t ptr;
+    if (!jerry_get_object_native_handle(function_obj, &ptr) || !ptr) {
+        return zjs_error("profile_handler: native function not found");
+    }
+    profile_entry_t *entry = (profile_entry_t *)ptr;
+
+    // time and bytes include any profiled functions called from this one
+    uint32_t bytes = zjs_profile_alloc_bytes;
+    zjs_port_cycles_t start = zjs_port_get_cycles();
+    jerry_value_t rval = entry->func(function_obj, this, argv, argc);
+    zjs_port_cycles_t cycles = zjs_port_get_cycles() - start;
+
+    uint64_t ns = zjs_port_cycles_to_ns(cycles);
+    entry->calls++;
+    entry->bytes += zjs_profile_alloc_bytes - bytes;
+    entry->total_ns += ns;
+    if (ns > entry->max_ns) {
+        entry->max_ns = ns;
+    }
+    return rval;
+}
+
+jerry_value_t zjs_profile_wrap_function(void *func, const char *name)
+{
+    profile_entry_t *entry = profile_get_entry(func, name);
+    if (!entry) {
+        // fall back to an unprofiled function rather than losing the API
+        return jerry_create_external_function(func);
+    }
+
+    jerry_value_t jfunc = jerry_create_external_function(profile_handler);
+    if (jerry_value_is_function(jfunc)) {
+        jerry_set_object_native_handle(jfunc, (uintptr_t)entry, NULL);
+    }
+    return jfunc;
+}
+
+void zjs_profile_report(uint32_t top)
+{
+    // selection by total time, starting below the previous pick each pass
+    //   so the list itself never has to be reordered
+    uint32_t count = 0;
+    profile_entry_t *last = NULL;
+
+    ZJS_PRINT("\nNative call profile:\n");
+    ZJS_PRINT("%-32s %10s %12s %10s %10s\n", "FUNCTION", "CALLS", "TOTAL_US",
+              "MAX_US", "BYTES");
+    while (top == 0 || count < top) {
+        profile_entry_t *best = NULL;
+        bool past_last = (last == NULL);
+        for (profile_entry_t *entry = profile_list; entry;
+             entry = entry->next) {
+            if (entry == last) {
+                // entries equal to the last pick only qualify after it
+                past_last = true;
+                continue;
+            }
+            if (!entry->calls) {
+                continue;
+            }
+            if (last && (entry->total_ns > last->total_ns ||
+                         (entry->total_ns == last->total_ns && !past_last))) {
+                // already printed
+                continue;
+            }
+            if (!best || entry->total_ns > best->total_ns) {
+                best = entry;
+            }
+        }
+        if (!best) {
+            break;
+        }
+        ZJS_PRINT("%-32s %10u %12u %10u %10u\n", best->name, best->calls,
+                  (uint32_t)(best->total_ns / 1000),
+                  (uint32_t)(best->max_ns / 1000), best->bytes);
+        last = best;
+        count++;
+    }
+    if (!count) {
+        ZJS_PRINT("no native functions called\n");
+    }
+#ifdef BUILD_MODULE_BUFFER
+    zjs_buffer_print_stats();
+#endif
+}
+
+void zjs_profile_reset()
+{
+    for (profile_entry_t *entry = profile_list; entry; entry = entry->next) {
+        entry->calls = 0;
+        entry->bytes = 0;
+        entry->total_ns = 0;
+        entry->max_ns = 0;
+    }
+}
+
+#endif  // ZJS_PROFILE_NATIVE
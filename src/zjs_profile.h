@@ -0,0 +1,31 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_profile_h__
+#define __zjs_profile_h__
+
+// Native call profiler, enabled with PROFILE=on. Every function registered
+//   through zjs_obj_add_function is wrapped so that its call count, time spent
+//   and bytes allocated with zjs_malloc are recorded.
+
+#include "jerry-api.h"
+
+/**
+ * Create a JS function that calls func and records its cost under name.
+ *
+ * @param func  Native handler, a jerry_external_handler_t
+ * @param name  Name to report the function under, must be a static string
+ * @return A new function object (which must be released) or an error value
+ */
+jerry_value_t zjs_profile_wrap_function(void *func, const char *name);
+
+/**
+ * Print the most expensive native functions, ordered by total time.
+ *
+ * @param top  Maximum number of functions to print, 0 prints them all
+ */
+void zjs_profile_report(uint32_t top);
+
+/** Reset the counters of every profiled function to zero. */
+void zjs_profile_reset();
+
+#endif  // __zjs_profile_h__
@@ -7,6 +7,7 @@
 #include "zjs_callbacks.h"
 
 typedef struct zjs_promise {
+    zjs_native_t native;
     zjs_callback_id then_id;    // Callback ID for then JS callback
     zjs_callback_id catch_id;   // Callback ID for catch JS callback
     void* user_handle;
@@ -16,9 +17,11 @@ typedef struct zjs_promise {
 zjs_promise_t *new_promise(void)
 {
     zjs_promise_t *new = zjs_malloc(sizeof(zjs_promise_t));
-    memset(new, 0, sizeof(zjs_promise_t));
-    new->catch_id = -1;
-    new->then_id = -1;
+    if (new) {
+        memset(new, 0, sizeof(zjs_promise_t));
+        new->catch_id = -1;
+        new->then_id = -1;
+    }
     return new;
 }
 
@@ -42,9 +45,8 @@ static jerry_value_t promise_resolve(const jerry_value_t function_obj,
     // args: callback
     ZJS_VALIDATE_ARGS(Z_FUNCTION);
 
-    zjs_promise_t *handle = NULL;
-    jerry_value_t promise_obj = zjs_get_property(this, "promise");
-    jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
+    jerry_value_t promise_obj = jerry_get_property(this, ZJS_PROP(promise));
+    zjs_promise_t *handle = zjs_unwrap(promise_obj, ZJS_CLASS_PROMISE);
     jerry_release_value(promise_obj);
 
     if (!handle) {
@@ -90,7 +92,7 @@ void zjs_make_promise(jerry_value_t obj, zjs_post_promise_func post,
     zjs_obj_add_function(obj, promise_then, "then");
     zjs_obj_add_function(obj, promise_catch, "catch");
 
-    jerry_set_object_native_handle(promise_obj, (uintptr_t)new, NULL);
+    zjs_wrap(promise_obj, &new->native, ZJS_CLASS_PROMISE, NULL);
 
     new->user_handle = handle;
     new->post = post;
@@ -104,10 +106,12 @@ void zjs_make_promise(jerry_value_t obj, zjs_post_promise_func post,
                                           obj,
                                           new,
                                           post_promise);
+    zjs_set_callback_source(new->then_id, "promise", "then");
+    zjs_set_callback_source(new->catch_id, "promise", "catch");
 
     // Add the "promise" object to the object passed as a property, because the
     // object being made to a promise may already have a native handle.
-    zjs_obj_add_object(obj, promise_obj, "promise");
+    jerry_set_property(obj, ZJS_PROP(promise), promise_obj);
     jerry_release_value(promise_obj);
 
     DBG_PRINT("created promise, obj=%lu, promise=%p, handle=%p\n", obj, new,
@@ -116,16 +120,8 @@ void zjs_make_promise(jerry_value_t obj, zjs_post_promise_func post,
 
 void zjs_fulfill_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
 {
-    zjs_promise_t *handle = NULL;
-    jerry_value_t promise_obj = zjs_get_property(obj, "promise");
-
-    if (!jerry_value_is_object(promise_obj)) {
-        jerry_release_value(promise_obj);
-        ERR_PRINT("'promise' not found in object %lu\n", obj);
-        return;
-    }
-
-    jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
+    jerry_value_t promise_obj = jerry_get_property(obj, ZJS_PROP(promise));
+    zjs_promise_t *handle = zjs_unwrap(promise_obj, ZJS_CLASS_PROMISE);
     jerry_release_value(promise_obj);
     if (handle) {
         zjs_signal_callback(handle->then_id, argv,
@@ -134,22 +130,14 @@ void zjs_fulfill_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
         DBG_PRINT("fulfilling promise, obj=%lu, then_id=%d, argv=%p, nargs=%lu\n",
                   obj, handle->then_id, argv, argc);
     } else {
-        ERR_PRINT("native handle not found\n");
+        ERR_PRINT("'promise' not found in object %lu\n", obj);
     }
 }
 
 void zjs_reject_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
 {
-    zjs_promise_t *handle = NULL;
-    jerry_value_t promise_obj = zjs_get_property(obj, "promise");
-
-    if (!jerry_value_is_object(promise_obj)) {
-        jerry_release_value(promise_obj);
-        ERR_PRINT("'promise' not found in object %lu\n", obj);
-        return;
-    }
-
-    jerry_get_object_native_handle(promise_obj, (uintptr_t*)&handle);
+    jerry_value_t promise_obj = jerry_get_property(obj, ZJS_PROP(promise));
+    zjs_promise_t *handle = zjs_unwrap(promise_obj, ZJS_CLASS_PROMISE);
     jerry_release_value(promise_obj);
     if (handle) {
         zjs_signal_callback(handle->catch_id, argv,
@@ -158,6 +146,6 @@ void zjs_reject_promise(jerry_value_t obj, jerry_value_t argv[], uint32_t argc)
         DBG_PRINT("rejecting promise, obj=%lu, catch_id=%d, argv=%p, nargs=%lu\n",
                   obj, handle->catch_id, argv, argc);
     } else {
-        ERR_PRINT("native handle not found\n");
+        ERR_PRINT("'promise' not found in object %lu\n", obj);
     }
 }
@@ -0,0 +1,452 @@
+// Copyright (c) 2017, Intel Corporation.
+#ifdef ZJS_RECORD
+
+#include <string.h>
+
+#ifndef ZJS_LINUX_BUILD
+#include <zephyr.h>
+#include "zjs_zephyr_port.h"
+#else
+#include "zjs_linux_port.h"
+#include "zjs_modules.h"
+#include "zjs_script.h"
+#endif
+
+// ZJS includes
+#ifdef BUILD_MODULE_BUFFER
+#include "zjs_buffer.h"
+#endif
+#include "zjs_record.h"
+#include "zjs_util.h"
+
+#define RECORD_HEADER_SIZE      10
+#define RECORD_TYPE_C           0
+#define RECORD_TYPE_JS          1
+
+// tags for JS arguments; numbers are followed by a double, strings and
+//   buffers by a uint16 length and the bytes
+#define ARG_UNDEFINED           0
+#define ARG_NULL                1
+#define ARG_FALSE               2
+#define ARG_TRUE                3
+#define ARG_NUMBER              4
+#define ARG_STRING              5
+#define ARG_BUFFER              6
+#define ARG_OBJECT              7   // other objects, replayed as {}
+
+// longest string or buffer argument kept, longer ones are truncated
+#define MAX_ARG_BYTES           512
+
+static uint8_t record_buf[ZJS_RECORD_BUF_SIZE];
+static uint32_t record_len = 0;
+static uint32_t record_count = 0;
+static uint32_t record_dropped = 0;
+static bool recording = false;
+static bool suspended = false;
+
+// time is accumulated between records so that the 32-bit cycle counter on
+//   Zephyr only has to cover the gap between two signals
+static zjs_port_cycles_t last_cycles;
+static uint64_t record_time_ns = 0;
+
+static void put_u16(uint8_t *ptr, uint16_t val)
+{
+    ptr[0] = val & 0xff;
+    ptr[1] = val >> 8;
+}
+
+static void put_u32(uint8_t *ptr, uint32_t val)
+{
+    put_u16(ptr, val & 0xffff);
+    put_u16(ptr + 2, val >> 16);
+}
+
+static uint16_t get_u16(const uint8_t *ptr)
+{
+    return ptr[0] | (ptr[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *ptr)
+{
+    return get_u16(ptr) | ((uint32_t)get_u16(ptr + 2) << 16);
+}
+
+void zjs_record_start()
+{
+    record_len = 0;
+    record_count = 0;
+    record_dropped = 0;
+    record_time_ns = 0;
+    last_cycles = zjs_port_get_cycles();
+    recording = true;
+}
+
+void zjs_record_suspend(bool suspend)
+{
+    suspended = suspend;
+}
+
+static uint32_t js_arg_size(jerry_value_t arg)
+{
+    // returns: bytes needed to log arg, including its tag
+    if (jerry_value_is_number(arg)) {
+        return 1 + sizeof(double);
+    }
+    if (jerry_value_is_string(arg)) {
+        uint32_t len = jerry_get_string_size(arg);
+        return 3 + (len > MAX_ARG_BYTES ? MAX_ARG_BYTES : len);
+    }
+#ifdef BUILD_MODULE_BUFFER
+    zjs_buffer_t *buf = zjs_buffer_find(arg);
+    if (buf) {
+        uint32_t len = buf->bufsize;
+        return 3 + (len > MAX_ARG_BYTES ? MAX_ARG_BYTES : len);
+    }
+#endif
+    return 1;
+}
+
+static uint8_t *write_js_arg(uint8_t *ptr, jerry_value_t arg)
+{
+    // requires: ptr has js_arg_size(arg) bytes available
+    //  effects: logs arg at ptr and returns the end of what was written
+    if (jerry_value_is_number(arg)) {
+        double num = jerry_get_number_value(arg);
+        *ptr++ = ARG_NUMBER;
+        memcpy(ptr, &num, sizeof(double));
+        return ptr + sizeof(double);
+    }
+    if (jerry_value_is_string(arg)) {
+        uint32_t len = js_arg_size(arg) - 3;
+        jerry_size_t size = len;
+        char *str = zjs_alloc_from_jstring(arg, &size);
+        *ptr++ = ARG_STRING;
+        put_u16(ptr, len);
+        // the space is already reserved, so pad if the copy came up short
+        memset(ptr + 2, 0, len);
+        if (str) {
+            memcpy(ptr + 2, str, size < len ? size : len);
+            zjs_free(str);
+        }
+        return ptr + 2 + len;
+    }
+#ifdef BUILD_MODULE_BUFFER
+    zjs_buffer_t *buf = zjs_buffer_find(arg);
+    if (buf) {
+        uint32_t len = js_arg_size(arg) - 3;
+        *ptr++ = ARG_BUFFER;
+        put_u16(ptr, len);
+        memcpy(ptr + 2, buf->buffer, len);
+        return ptr + 2 + len;
+    }
+#endif
+    if (jerry_value_is_boolean(arg)) {
+        *ptr++ = jerry_get_boolean_value(arg) ? ARG_TRUE : ARG_FALSE;
+    } else if (jerry_value_is_null(arg)) {
+        *ptr++ = ARG_NULL;
+    } else if (jerry_value_is_object(arg)) {
+        *ptr++ = ARG_OBJECT;
+    } else {
+        *ptr++ = ARG_UNDEFINED;
+    }
+    return ptr;
+}
+
+// INTERRUPT SAFE FUNCTION for C callbacks: No JerryScript VM or allocs!
+void zjs_record_signal(zjs_callback_id id, bool is_js, const void *args,
+                       uint32_t size)
+{
+    // interrupts keep being recorded while the main thread is suspended
+    if (!recording || (is_js && suspended)) {
+        return;
+    }
+
+    const jerry_value_t *values = (const jerry_value_t *)args;
+    uint32_t argc = 0;
+    uint32_t payload = size;
+    if (is_js) {
+        // JS callbacks are only signaled from the main thread
+        argc = size / sizeof(jerry_value_t);
+        payload = 0;
+        for (int i = 0; i < argc; i++) {
+            payload += js_arg_size(values[i]);
+        }
+    }
+
+#ifndef ZJS_LINUX_BUILD
+    unsigned int key = irq_lock();
+#endif
+    uint8_t *ptr = NULL;
+    if (record_len + RECORD_HEADER_SIZE + payload <= ZJS_RECORD_BUF_SIZE &&
+        payload <= UINT16_MAX && argc <= UINT8_MAX) {
+        zjs_port_cycles_t now = zjs_port_get_cycles();
+        zjs_port_cycles_t cycles = now - last_cycles;
+        record_time_ns += zjs_port_cycles_to_ns(cycles);
+        last_cycles = now;
+
+        ptr = record_buf + record_len;
+        record_len += RECORD_HEADER_SIZE + payload;
+        record_count++;
+        put_u32(ptr, (uint32_t)(record_time_ns / 1000));
+        put_u16(ptr + 4, (uint16_t)id);
+        ptr[6] = is_js ? RECORD_TYPE_JS : RECORD_TYPE_C;
+        ptr[7] = argc;
+        put_u16(ptr + 8, payload);
+        ptr += RECORD_HEADER_SIZE;
+    } else {
+        record_dropped++;
+    }
+#ifndef ZJS_LINUX_BUILD
+    irq_unlock(key);
+#endif
+    if (!ptr) {
+        return;
+    }
+
+    // space is reserved, so the payload can be filled in without the lock
+    if (is_js) {
+        for (int i = 0; i < argc; i++) {
+            ptr = write_js_arg(ptr, values[i]);
+        }
+    } else if (size) {
+        memcpy(ptr, args, size);
+    }
+}
+
+static void write_file_header(uint8_t *header)
+{
+    memcpy(header, "ZJSR", 4);
+    header[4] = ZJS_RECORD_VERSION;
+    header[5] = header[6] = header[7] = 0;
+}
+
+void zjs_record_dump()
+{
+    // print in short lines so console buffers don't overflow
+    const int BYTES_PER_LINE = 32;
+    uint8_t header[8];
+    write_file_header(header);
+
+    ZJS_PRINT("recorded %u signals in %u bytes, %u dropped\n", record_count,
+              record_len, record_dropped);
+    ZJS_PRINT("zjsrec ");
+    for (int i = 0; i < sizeof(header); i++) {
+        ZJS_PRINT("%02x", header[i]);
+    }
+    ZJS_PRINT("\n");
+    for (uint32_t i = 0; i < record_len; i++) {
+        if (i % BYTES_PER_LINE == 0) {
+            ZJS_PRINT("zjsrec ");
+        }
+        ZJS_PRINT("%02x", record_buf[i]);
+        if (i % BYTES_PER_LINE == BYTES_PER_LINE - 1 || i == record_len - 1) {
+            ZJS_PRINT("\n");
+        }
+    }
+}
+
+#ifdef ZJS_LINUX_BUILD
+int zjs_record_save(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ERR_PRINT("could not open %s for writing\n", path);
+        return 1;
+    }
+
+    uint8_t header[8];
+    write_file_header(header);
+    int ok = fwrite(header, sizeof(header), 1, f) == 1 &&
+        (!record_len || fwrite(record_buf, record_len, 1, f) == 1);
+    fclose(f);
+    if (!ok) {
+        ERR_PRINT("error writing %s\n", path);
+        return 1;
+    }
+
+    ZJS_PRINT("recorded %u signals to %s, %u dropped\n", record_count, path,
+              record_dropped);
+    return 0;
+}
+
+// most records delivered in one pass of the main loop when not paced
+#define REPLAY_BURST            4
+
+typedef struct replay {
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t pos;
+    uint32_t speed;
+    zjs_port_cycles_t start;
+    uint32_t delivered;
+    uint32_t skipped;
+} replay_t;
+
+static replay_t replay;
+
+static const uint8_t *read_js_arg(const uint8_t *ptr, const uint8_t *end,
+                                  jerry_value_t *arg)
+{
+    // effects: decodes one logged JS argument into *arg, which the caller must
+    //            release; returns the next argument or NULL if malformed
+    *arg = ZJS_UNDEFINED;
+    if (ptr >= end) {
+        return NULL;
+    }
+    uint8_t tag = *ptr++;
+    switch (tag) {
+    case ARG_UNDEFINED:
+        return ptr;
+    case ARG_NULL:
+        *arg = jerry_create_null();
+        return ptr;
+    case ARG_FALSE:
+    case ARG_TRUE:
+        *arg = jerry_create_boolean(tag == ARG_TRUE);
+        return ptr;
+    case ARG_OBJECT:
+        *arg = jerry_create_object();
+        return ptr;
+    case ARG_NUMBER: {
+        double num;
+        if (ptr + sizeof(double) > end) {
+            return NULL;
+        }
+        memcpy(&num, ptr, sizeof(double));
+        *arg = jerry_create_number(num);
+        return ptr + sizeof(double);
+    }
+    case ARG_STRING:
+    case ARG_BUFFER: {
+        if (ptr + 2 > end) {
+            return NULL;
+        }
+        uint16_t len = get_u16(ptr);
+        ptr += 2;
+        if (ptr + len > end) {
+            return NULL;
+        }
+        if (tag == ARG_STRING) {
+            *arg = jerry_create_string_sz((const jerry_char_t *)ptr, len);
+        }
+#ifdef BUILD_MODULE_BUFFER
+        else {
+            *arg = zjs_buffer_create(len);
+            zjs_buffer_t *buf = zjs_buffer_find(*arg);
+            if (buf) {
+                memcpy(buf->buffer, ptr, len);
+            }
+        }
+#endif
+        return ptr + len;
+    }
+    default:
+        return NULL;
+    }
+}
+
+static void replay_record(zjs_callback_id id, uint8_t type, uint8_t argc,
+                          const uint8_t *payload, uint16_t size)
+{
+    bool is_js;
+    if (!zjs_callback_exists(id, &is_js) ||
+        is_js != (type == RECORD_TYPE_JS)) {
+        DBG_PRINT("replay: no matching callback %d, skipping\n", id);
+        replay.skipped++;
+        return;
+    }
+
+    if (!is_js) {
+        // copy to aligned words, the ring buffer reads whole words
+        uint32_t data[(size + 3) / 4];
+        memset(data, 0, sizeof(data));
+        memcpy(data, payload, size);
+        zjs_signal_callback(id, data, size);
+        replay.delivered++;
+        return;
+    }
+
+    jerry_value_t argv[argc];
+    const uint8_t *ptr = payload;
+    const uint8_t *end = payload + size;
+    int count = 0;
+    while (count < argc && ptr) {
+        ptr = read_js_arg(ptr, end, &argv[count++]);
+    }
+    if (ptr) {
+        // the callback module acquires its own copies
+        zjs_signal_callback(id, argv, argc * sizeof(jerry_value_t));
+        replay.delivered++;
+    } else {
+        ERR_PRINT("replay: malformed arguments for callback %d\n", id);
+        replay.skipped++;
+    }
+    for (int i = 0; i < count; i++) {
+        jerry_release_value(argv[i]);
+    }
+}
+
+static uint8_t replay_routine(void *handle)
+{
+    if (!replay.data) {
+        return 0;
+    }
+
+    uint64_t elapsed_us = zjs_port_cycles_to_ns(zjs_port_get_cycles() -
+                                                replay.start) / 1000;
+    int burst = 0;
+    while (replay.pos + RECORD_HEADER_SIZE <= replay.len) {
+        const uint8_t *ptr = replay.data + replay.pos;
+        uint32_t time_us = get_u32(ptr);
+        uint16_t size = get_u16(ptr + 8);
+        if (replay.pos + RECORD_HEADER_SIZE + size > replay.len) {
+            ERR_PRINT("replay: log is truncated\n");
+            replay.pos = replay.len;
+            break;
+        }
+        if (replay.speed ? time_us > elapsed_us * replay.speed :
+            burst >= REPLAY_BURST) {
+            // not due yet
+            return 1;
+        }
+
+        replay_record((int16_t)get_u16(ptr + 4), ptr[6], ptr[7],
+                      ptr + RECORD_HEADER_SIZE, size);
+        replay.pos += RECORD_HEADER_SIZE + size;
+        burst++;
+    }
+
+    ZJS_PRINT("replay: delivered %u signals, skipped %u\n", replay.delivered,
+              replay.skipped);
+    zjs_free_script((const char *)replay.data - 8);
+    replay.data = NULL;
+    return 1;
+}
+
+int zjs_record_replay(const char *path, uint32_t speed)
+{
+    const char *file;
+    uint32_t len;
+    if (zjs_read_script((char *)path, &file, &len)) {
+        ERR_PRINT("could not read replay log %s\n", path);
+        return 1;
+    }
+    if (len < 8 || memcmp(file, "ZJSR", 4) ||
+        file[4] != ZJS_RECORD_VERSION) {
+        ERR_PRINT("%s is not a version %u replay log\n", path,
+                  ZJS_RECORD_VERSION);
+        zjs_free_script(file);
+        return 1;
+    }
+
+    memset(&replay, 0, sizeof(replay_t));
+    replay.data = (const uint8_t *)file + 8;
+    replay.len = len - 8;
+    replay.speed = speed;
+    replay.start = zjs_port_get_cycles();
+    zjs_register_service_routine(NULL, replay_routine);
+    return 0;
+}
+#endif  // ZJS_LINUX_BUILD
+
+#endif  // ZJS_RECORD
@@ -0,0 +1,76 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_record_h__
+#define __zjs_record_h__
+
+// Event loop input recorder, enabled with RECORD=on. Callbacks signaled from
+//   outside of JS (interrupts, driver threads and service routines) are logged
+//   with their arguments and a timestamp so jslinux can replay them later.
+//
+// Log format, all fields little-endian:
+//   header:  "ZJSR", uint8 version, 3 bytes reserved
+//   record:  uint32 time in us since recording started, int16 callback id,
+//            uint8 type (0 = C, 1 = JS), uint8 JS argc, uint16 payload size,
+//            payload
+//   C payload is the raw argument bytes; each JS argument is a one byte tag
+//   followed by its value (see zjs_record.c)
+
+#include "jerry-api.h"
+#include "zjs_callbacks.h"
+
+#define ZJS_RECORD_VERSION      1
+
+// bytes of RAM kept for the log; recording stops when it fills up
+#ifndef ZJS_RECORD_BUF_SIZE
+#define ZJS_RECORD_BUF_SIZE     4096
+#endif
+
+/** Start recording, timestamps are relative to this call. */
+void zjs_record_start();
+
+/**
+ * Temporarily ignore JS callback signals, e.g. ones the script raises itself.
+ *
+ * @param suspend  true to stop recording, false to continue
+ */
+void zjs_record_suspend(bool suspend);
+
+/**
+ * Log a callback signal. May be called from an interrupt for C callbacks.
+ *
+ * @param id     Callback ID being signaled
+ * @param is_js  True if args are jerry_value_t arguments of a JS callback
+ * @param args   Arguments given to zjs_signal_callback
+ * @param size   Size of args in bytes
+ */
+void zjs_record_signal(zjs_callback_id id, bool is_js, const void *args,
+                       uint32_t size);
+
+/**
+ * Print the log to the console as hex lines starting with "zjsrec ", which
+ *   can be turned back into a binary log with xxd -r -p.
+ */
+void zjs_record_dump();
+
+#ifdef ZJS_LINUX_BUILD
+/**
+ * Write the log to a file.
+ *
+ * @param path  File to write
+ * @return 0 on success, nonzero on error
+ */
+int zjs_record_save(const char *path);
+
+/**
+ * Replay a log from a file into the event loop. Records are delivered from
+ *   a service routine, so the callbacks must have been registered by then.
+ *
+ * @param path   File to read
+ * @param speed  Pace multiplier, 1 for the original timing; 0 delivers the
+ *                 records back to back as fast as the loop services them
+ * @return 0 on success, nonzero on error
+ */
+int zjs_record_replay(const char *path, uint32_t speed);
+#endif
+
+#endif  // __zjs_record_h__
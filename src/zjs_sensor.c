@@ -31,6 +31,7 @@ enum sensor_state {
 };
 
 typedef struct sensor_handle {
+    zjs_native_t native;
     zjs_callback_id onchange_cb_id;
     zjs_callback_id onstart_cb_id;
     zjs_callback_id onstop_cb_id;
@@ -49,9 +50,10 @@ static sensor_handle_t *zjs_sensor_alloc_handle(enum sensor_channel channel)
 {
     size_t size = sizeof(sensor_handle_t);
     sensor_handle_t *handle = zjs_malloc(size);
-    if (handle) {
-        memset(handle, 0, size);
+    if (!handle) {
+        return NULL;
     }
+    memset(handle, 0, size);
 
     // append to the list
     sensor_handle_t **head = NULL;
@@ -88,16 +90,11 @@ static void zjs_sensor_free_handles(sensor_handle_t *handle)
 
 static sensor_handle_t *zjs_sensor_get_handle(jerry_value_t obj)
 {
-    uintptr_t ptr;
-    sensor_handle_t *handle = NULL;
-    if (jerry_get_object_native_handle(obj, &ptr)) {
-        handle = (sensor_handle_t *)ptr;
-        if (handle) {
-            return handle;
-        }
+    sensor_handle_t *handle = zjs_unwrap(obj, ZJS_CLASS_SENSOR);
+    if (!handle) {
+        ERR_PRINT("cannot find handle");
     }
-    ERR_PRINT("cannot find handle");
-    return NULL;
+    return handle;
 }
 
 static bool zjs_sensor_ipm_send_sync(zjs_ipm_message_t* send,
@@ -189,9 +186,9 @@ static void zjs_sensor_set_state(jerry_value_t obj, enum sensor_state state)
         ERR_PRINT("invalid state\n");
         return;
     }
-    zjs_obj_add_readonly_string(obj, state_str, "state");
+    zjs_obj_add_readonly_string_prop(obj, state_str, ZJS_PROP(state));
 
-    jerry_value_t func = zjs_get_property(obj, "onstatechange");
+    jerry_value_t func = jerry_get_property(obj, ZJS_PROP(onstatechange));
     if (jerry_value_is_function(func)) {
         // if onstatechange exists, call it
         jerry_value_t new_state = jerry_create_string(state_str);
@@ -203,7 +200,7 @@ static void zjs_sensor_set_state(jerry_value_t obj, enum sensor_state state)
 
     if (old_state == SENSOR_STATE_ACTIVATING &&
         state == SENSOR_STATE_ACTIVATED) {
-        func = zjs_get_property(obj, "onactivate");
+        func = jerry_get_property(obj, ZJS_PROP(onactivate));
         if (jerry_value_is_function(func)) {
             // if onactivate exists, call it
             zjs_callback_id id = zjs_add_callback_once(func, obj, NULL, NULL);
@@ -226,14 +223,15 @@ static void zjs_sensor_update_reading(jerry_value_t obj,
         double x = ((double*)reading)[0];
         double y = ((double*)reading)[1];
         double z = ((double*)reading)[2];
-        zjs_obj_add_readonly_number(reading_obj, x, "x");
-        zjs_obj_add_readonly_number(reading_obj, y, "y");
-        zjs_obj_add_readonly_number(reading_obj, z, "z");
+        zjs_obj_add_readonly_number_prop(reading_obj, x, ZJS_PROP(x));
+        zjs_obj_add_readonly_number_prop(reading_obj, y, ZJS_PROP(y));
+        zjs_obj_add_readonly_number_prop(reading_obj, z, ZJS_PROP(z));
         break;
     case SENSOR_CHAN_LIGHT: ;
         // reading is a ptr to double
         double d = *((double*)reading);
-        zjs_obj_add_readonly_number(reading_obj, d, "illuminance");
+        zjs_obj_add_readonly_number_prop(reading_obj, d,
+                                         ZJS_PROP(illuminance));
         break;
 
     default:
@@ -242,12 +240,12 @@ static void zjs_sensor_update_reading(jerry_value_t obj,
         return;
     }
 
-    zjs_set_property(obj, "reading", reading_obj);
-    jerry_value_t func = zjs_get_property(obj, "onchange");
+    jerry_set_property(obj, ZJS_PROP(reading), reading_obj);
+    jerry_value_t func = jerry_get_property(obj, ZJS_PROP(onchange));
     if (jerry_value_is_function(func)) {
         jerry_value_t event = jerry_create_object();
         // if onchange exists, call it
-        zjs_set_property(event, "reading", reading_obj);
+        jerry_set_property(event, ZJS_PROP(reading), reading_obj);
         jerry_value_t rval = jerry_call_function(func, obj, &event, 1);
         if (jerry_value_has_error_flag(rval)) {
             ERR_PRINT("calling onchange\n");
@@ -264,16 +262,16 @@ static void zjs_sensor_trigger_error(jerry_value_t obj,
                                      const char *error_message)
 {
     zjs_sensor_set_state(obj, SENSOR_STATE_ERRORED);
-    jerry_value_t func = zjs_get_property(obj, "onerror");
+    jerry_value_t func = jerry_get_property(obj, ZJS_PROP(onerror));
     if (jerry_value_is_function(func)) {
         // if onerror exists, call it
         jerry_value_t event = jerry_create_object();
         jerry_value_t error_obj = jerry_create_object();
         jerry_value_t name_val = jerry_create_string(error_name);
         jerry_value_t message_val = jerry_create_string(error_message);
-        zjs_set_property(error_obj, "name", name_val);
-        zjs_set_property(error_obj, "message", message_val);
-        zjs_set_property(event, "error", error_obj);
+        jerry_set_property(error_obj, ZJS_PROP(name), name_val);
+        jerry_set_property(error_obj, ZJS_PROP(message), message_val);
+        jerry_set_property(event, ZJS_PROP(error), error_obj);
         zjs_callback_id id = zjs_add_callback_once(func, obj, NULL, NULL);
         zjs_signal_callback(id, &event, 1);
         jerry_release_value(name_val);
@@ -497,7 +495,7 @@ static jerry_value_t zjs_sensor_create(const jerry_value_t function_obj,
                                        enum sensor_channel channel)
 {
     // args: [initialization object]
-    char *expect = Z_OPTIONAL Z_OBJECT;
+    zjs_ztype_t expect = Z_OPTIONAL Z_OBJECT;
     if (channel == SENSOR_CHAN_LIGHT) {
         // arg is required for AmbientLightSensor
         expect = Z_OBJECT;
@@ -561,6 +559,10 @@ static jerry_value_t zjs_sensor_create(const jerry_value_t function_obj,
     jerry_set_prototype(sensor_obj, zjs_sensor_prototype);
 
     sensor_handle_t* handle = zjs_sensor_alloc_handle(channel);
+    if (!handle) {
+        jerry_release_value(sensor_obj);
+        return zjs_error("zjs_sensor_create: out of memory");
+    }
     handle->onchange_cb_id = zjs_add_c_callback(handle, zjs_sensor_onchange_c_callback);
     handle->onstart_cb_id = zjs_add_c_callback(handle, zjs_sensor_onstart_c_callback);
     handle->onstop_cb_id = zjs_add_c_callback(handle, zjs_sensor_onstop_c_callback);
@@ -569,8 +571,8 @@ static jerry_value_t zjs_sensor_create(const jerry_value_t function_obj,
     handle->sensor_obj = jerry_acquire_value(sensor_obj);
 
     // watch for the object getting garbage collected, and clean up
-    jerry_set_object_native_handle(sensor_obj, (uintptr_t)handle,
-                                   zjs_sensor_callback_free);
+    zjs_wrap(sensor_obj, &handle->native, ZJS_CLASS_SENSOR,
+             zjs_sensor_callback_free);
 
     return sensor_obj;
 }
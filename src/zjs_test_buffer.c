@@ -0,0 +1,76 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifdef BUILD_MODULE_TEST_BUFFER
+
+#include "zjs_buffer.h"
+#include "zjs_common.h"
+#include "zjs_util.h"
+
+// bytes for Buffers that view memory the module owns, as a driver's ROM
+//   table or DMA buffer would be
+static const uint8_t test_table[] = { 0xde, 0xad, 0xbe, 0xef, 1, 2, 3, 4 };
+static uint8_t test_external[8];
+static uint32_t test_releases = 0;
+
+static void release_external(void *ptr, void *ctx)
+{
+    if (ptr != test_external || ctx != &test_releases) {
+        ERR_PRINT("Release hook called with wrong memory!!!\n");
+        return;
+    }
+    test_releases++;
+}
+
+static jerry_value_t test_wrap_const(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    // effects: returns a read-only Buffer over test_table
+    return zjs_buffer_wrap_const(test_table, sizeof(test_table));
+}
+
+static jerry_value_t test_wrap_external(const jerry_value_t function_obj,
+                                        const jerry_value_t this,
+                                        const jerry_value_t argv[],
+                                        const jerry_length_t argc)
+{
+    // effects: resets test_external to 0..7 and returns a writable Buffer
+    //            over it that counts its release in test_releases
+    for (int i = 0; i < sizeof(test_external); i++) {
+        test_external[i] = i;
+    }
+    return zjs_buffer_wrap_external(test_external, sizeof(test_external),
+                                    release_external, &test_releases, false);
+}
+
+static jerry_value_t test_get_releases(const jerry_value_t function_obj,
+                                       const jerry_value_t this,
+                                       const jerry_value_t argv[],
+                                       const jerry_length_t argc)
+{
+    return jerry_create_number(test_releases);
+}
+
+static jerry_value_t test_gc(const jerry_value_t function_obj,
+                             const jerry_value_t this,
+                             const jerry_value_t argv[],
+                             const jerry_length_t argc)
+{
+    // effects: collects unreachable objects now, so their free callbacks run
+    jerry_gc();
+    return ZJS_UNDEFINED;
+}
+
+jerry_value_t zjs_test_buffer_init(void)
+{
+    jerry_value_t test = jerry_create_object();
+    zjs_obj_add_function(test, test_wrap_const, "wrapConst");
+    zjs_obj_add_function(test, test_wrap_external, "wrapExternal");
+    zjs_obj_add_function(test, test_get_releases, "releases");
+    zjs_obj_add_function(test, test_gc, "gc");
+
+    return test;
+}
+
+#endif  // BUILD_MODULE_TEST_BUFFER
@@ -0,0 +1,3 @@
+// Copyright (c) 2017, Intel Corporation.
+
+jerry_value_t zjs_test_buffer_init();
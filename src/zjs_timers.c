@@ -16,8 +16,12 @@
 // ZJS includes
 #include "zjs_util.h"
 #include "zjs_callbacks.h"
+#ifdef ZJS_RECORD
+#include "zjs_record.h"
+#endif
 
 typedef struct zjs_timer {
+    zjs_native_t native;
     zjs_port_timer_t timer;
     jerry_value_t *argv;
     uint32_t argc;
@@ -81,8 +85,10 @@ static zjs_timer_t *add_timer(uint32_t interval,
 
     if (tm->repeat) {
         tm->callback_id = zjs_add_callback(callback, this, tm, NULL);
+        zjs_set_callback_source(tm->callback_id, "timer", "interval");
     } else {
         tm->callback_id = zjs_add_callback_once(callback, this, tm, NULL);
+        zjs_set_callback_source(tm->callback_id, "timer", "timeout");
     }
 
     zjs_timer_t **pnext = &zjs_timers;
@@ -150,13 +156,14 @@ static jerry_value_t add_timer_helper(const jerry_value_t function_obj,
 
     uint32_t interval = (uint32_t)(jerry_get_number_value(argv[1]));
     jerry_value_t callback = argv[0];
-    jerry_value_t timer_obj = jerry_create_object();
 
     zjs_timer_t *handle = add_timer(interval, callback, this, repeat,
                                     argc - 2, argv);
-    if (handle->callback_id == -1)
+    if (!handle || handle->callback_id == -1)
         return zjs_error("native_set_interval_handler: timer alloc failed");
-    jerry_set_object_native_handle(timer_obj, (uintptr_t)handle, NULL);
+
+    jerry_value_t timer_obj = jerry_create_object();
+    zjs_wrap(timer_obj, &handle->native, ZJS_CLASS_TIMER, NULL);
 
     return timer_obj;
 }
@@ -197,11 +204,9 @@ static jerry_value_t native_clear_interval_handler(const jerry_value_t function_
     // FIXME: timers should be ints, not objects!
     ZJS_VALIDATE_ARGS(Z_OBJECT);
 
-    jerry_value_t timer_obj = argv[0];
-    zjs_timer_t *handle;
-
-    if (!jerry_get_object_native_handle(timer_obj, (uintptr_t*)&handle)) {
-        return zjs_error("native_clear_interval_handler(): native handle not found");
+    zjs_timer_t *handle = zjs_unwrap(argv[0], ZJS_CLASS_TIMER);
+    if (!handle) {
+        return TYPE_ERROR("native_clear_interval_handler: expected timer");
     }
 
     if (!delete_timer(handle->callback_id))
@@ -228,8 +233,15 @@ uint8_t zjs_timers_process_events()
             // timer has expired, signal the callback
             DBG_PRINT("signaling timer. id=%d, argv=%p, argc=%lu\n",
                     tm->callback_id, tm->argv, tm->argc);
+#ifdef ZJS_RECORD
+            // timers are recreated by the script itself on replay
+            zjs_record_suspend(true);
+#endif
             zjs_signal_callback(tm->callback_id, tm->argv,
                                 tm->argc * sizeof(jerry_value_t));
+#ifdef ZJS_RECORD
+            zjs_record_suspend(false);
+#endif
 
             // reschedule or remove timer
             if (tm->repeat) {
@@ -2,16 +2,17 @@
 
 #ifdef BUILD_MODULE_UART
 
+#include "string.h"
+
+#ifndef ZJS_LINUX_BUILD
 #include <zephyr.h>
 #include <device.h>
 #include <uart.h>
 
-#include "string.h"
-
-#ifndef ZJS_LINUX_BUILD
 #include "zjs_zephyr_port.h"
 #else
 #include "zjs_linux_port.h"
+#include "zjs_linux_uart.h"
 #endif
 #include "zjs_common.h"
 #include "zjs_util.h"
@@ -19,6 +20,8 @@
 #include "zjs_callbacks.h"
 #include "zjs_event.h"
 #include "zjs_buffer.h"
+#include "zjs_framer.h"
+#include "zjs_modules.h"
 
 static jerry_value_t zjs_uart_prototype;
 
@@ -27,16 +30,69 @@ typedef struct {
     const char* port;
 } uart_dev_map;
 
-// Struct used to hold pointers to the onread function,
-// string data, and callback ID so everything can be
-// properly cleaned up after the callback is made
+// bytes received and not yet given to JS, must be a power of 2; at 115200
+//   baud this covers about 20ms of the main loop not getting to run
+#ifndef ZJS_UART_RX_RING_SIZE
+#define ZJS_UART_RX_RING_SIZE   256
+#endif
+
+#if ZJS_UART_RX_RING_SIZE & (ZJS_UART_RX_RING_SIZE - 1)
+#error "ZJS_UART_RX_RING_SIZE must be a power of 2"
+#endif
+
+#define RX_MASK     (ZJS_UART_RX_RING_SIZE - 1)
+
+// orders accesses to the ring and write queue against the ISR's; on Linux
+//   the ISR is a thread of the pty backend, so it needs a real fence
+#ifdef ZJS_LINUX_BUILD
+#define ISR_BARRIER()   __sync_synchronize()
+#else
+#define ISR_BARRIER()   __asm__ __volatile__("" ::: "memory")
+#endif
+
+// longest frame a framer keeps unless setFramer is given maxLength
+#define UART_FRAME_DEFAULT_MAX  256
+
+// queued bytes above which writableNeedDrain is set until a 'drain' event
+#ifndef ZJS_UART_TX_HIGH_WATER
+#define ZJS_UART_TX_HIGH_WATER  1024
+#endif
+
+// A write waiting to go out. The ISR sends straight from the Buffer, which
+//   the node keeps alive, and only advances tx_current and sent. It leaves
+//   tx_current on the last node once that is sent, so the main loop can
+//   always append to the list without racing it.
+typedef struct tx_node {
+    jerry_value_t buf_obj;
+    jerry_value_t promise;
+    const uint8_t *data;
+    uint32_t len;
+    volatile uint32_t sent;
+    bool resolved;
+    struct tx_node *volatile next;
+} tx_node_t;
+
+// The ISR is the only writer of rx_tail and rx_overruns and the main loop
+//   the only writer of rx_head, so the ring needs no locking. The indices run
+//   freely and are masked on access.
 typedef struct {
     jerry_value_t uart_obj;
-    jerry_value_t buf_obj;
-    char* buf;
-    uint32_t size;
     uint32_t min;
     uint32_t max;
+    volatile uint32_t rx_head;
+    volatile uint32_t rx_tail;
+    volatile uint32_t rx_overruns;  // bytes lost because the ring was full
+    uint32_t rx_reported;           // overruns already sent to JS
+    uint8_t rx_ring[ZJS_UART_RX_RING_SIZE];
+    zjs_framer_t *framer;           // splits received data into frames
+    zjs_framer_t *framer_retired;   // replaced while it was calling back
+    bool framing;                   // a framer is calling back
+    tx_node_t *tx_first;            // oldest write not yet freed
+    tx_node_t *tx_last;
+    tx_node_t *volatile tx_current; // write the ISR is sending
+    uint32_t tx_queued;             // bytes of writes not yet resolved
+    uint32_t tx_high_water;
+    bool tx_need_drain;
 } uart_handle;
 
 static uart_dev_map device_map[] = {
@@ -47,20 +103,13 @@ static uart_dev_map device_map[] = {
 #endif
 };
 
-#define UART_BUFFER_INITIAL_SIZE    16
+#define UART_READ_INITIAL_MAX      16
 
+// The UART API's do not let you add a "handle" that is available when the
+// ISR is called. For this reason we must make it global.
 static uart_handle* handle = NULL;
 static struct device* uart_dev = NULL;
-
-// This is the CB ID for the C callback. This should not have to be a
-// global ID but the UART API's do not let you add a "handle" that is
-// available when the ISR is called. For this reason we must make it global.
-// Other modules would include this handle when setting up the ISR e.g. GPIO
-static zjs_callback_id read_id = -1;
-// TX interrupt handled
-static volatile bool tx = false;
-// RX interrupt handled
-static volatile bool rx = false;
+static bool service_registered = false;
 
 static jerry_value_t make_uart_error(const char* name, const char* msg)
 {
@@ -86,38 +135,251 @@ static jerry_value_t make_uart_error(const char* name, const char* msg)
 static uart_handle* new_uart_handle(void)
 {
     uart_handle* h = zjs_malloc(sizeof(uart_handle));
+    if (!h) {
+        return NULL;
+    }
     memset(h, 0, sizeof(uart_handle));
 
     h->min = 1;
-    h->max = UART_BUFFER_INITIAL_SIZE;
-    h->buf = zjs_malloc(UART_BUFFER_INITIAL_SIZE);
-    h->size = 0;
-    memset(h->buf, 0, UART_BUFFER_INITIAL_SIZE);
-
+    h->max = UART_READ_INITIAL_MAX;
+    h->tx_high_water = ZJS_UART_TX_HIGH_WATER;
     return h;
 }
 
-static void post_event(void* h)
+static void rx_copy(uart_handle *h, uint8_t *dst, uint32_t len)
 {
-    jerry_release_value(handle->buf_obj);
+    // requires: len is at most the bytes in the ring
+    //  effects: moves len bytes from the head of the ring to dst
+    ISR_BARRIER();
+    uint32_t offset = h->rx_head & RX_MASK;
+    uint32_t first = ZJS_UART_RX_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(dst, h->rx_ring + offset, first);
+    memcpy(dst + first, h->rx_ring, len - first);
+    ISR_BARRIER();
+    h->rx_head += len;
 }
 
-static void uart_c_callback(void* h, void* args)
+static void uart_frame(void *ctx, const uint8_t *frame, uint32_t len)
 {
-    if (!handle) {
-        DBG_PRINT("UART handle not found\n");
+    uart_handle *h = (uart_handle *)ctx;
+    jerry_value_t buf_obj = zjs_buffer_create(len);
+    zjs_buffer_t* buffer = zjs_buffer_find(buf_obj);
+    if (!buffer) {
+        ERR_PRINT("out of memory, dropping UART frame\n");
+        jerry_release_value(buf_obj);
         return;
     }
-    if (handle->size >= handle->min) {
-        handle->buf_obj = zjs_buffer_create(handle->size);
-        zjs_buffer_t* buffer = zjs_buffer_find(handle->buf_obj);
+    memcpy(buffer->buffer, frame, len);
+    zjs_trigger_event_now(h->uart_obj, "frame", &buf_obj, 1, NULL, NULL);
+    jerry_release_value(buf_obj);
+}
+
+static void uart_frame_error(void *ctx, uint8_t error)
+{
+    uart_handle *h = (uart_handle *)ctx;
+    const char *reason = "encoding";
+    if (error == ZJS_FRAME_OVERFLOW) {
+        reason = "overflow";
+    } else if (error == ZJS_FRAME_CRC) {
+        reason = "crc";
+    }
+    jerry_value_t str = jerry_create_string((const jerry_char_t *)reason);
+    zjs_trigger_event_now(h->uart_obj, "frameerror", &str, 1, NULL, NULL);
+    jerry_release_value(str);
+}
+
+static void rx_frame(uart_handle *h)
+{
+    // effects: feeds everything in the ring to the framer, straight from the
+    //            ring since the ISR won't touch it until rx_head moves on
+    uint32_t avail = h->rx_tail - h->rx_head;
+    uint32_t offset = h->rx_head & RX_MASK;
+    uint32_t first = ZJS_UART_RX_RING_SIZE - offset;
+    if (first > avail) {
+        first = avail;
+    }
+
+    // a frame listener may replace the framer, which then can't be freed
+    //   until it returns; whatever it was given goes with it
+    zjs_framer_t *framer = h->framer;
+    h->framing = true;
+    ISR_BARRIER();
+    zjs_framer_push(framer, h->rx_ring + offset, first);
+    if (first < avail && h->framer == framer) {
+        zjs_framer_push(framer, h->rx_ring, avail - first);
+    }
+    h->framing = false;
+    ISR_BARRIER();
+    h->rx_head += avail;
 
-        memcpy(buffer->buffer, args, handle->size);
+    if (h->framer_retired) {
+        zjs_framer_free(h->framer_retired);
+        h->framer_retired = NULL;
+    }
+}
 
-        zjs_trigger_event_now(handle->uart_obj, "read", &handle->buf_obj, 1, post_event, NULL);
+static uint8_t rx_service(uart_handle *h)
+{
+    // effects: gives JS the bytes the ISR has put in the ring, as frames if
+    //            there is a framer or else in Buffers of min to max bytes,
+    //            and reports any bytes lost since last time
+    uint8_t serviced = 0;
+    uint32_t overruns = h->rx_overruns;
+    if (overruns != h->rx_reported) {
+        jerry_value_t args[2] = {
+            jerry_create_number(overruns - h->rx_reported),
+            jerry_create_number(overruns)
+        };
+        h->rx_reported = overruns;
+        zjs_trigger_event_now(h->uart_obj, "overrun", args, 2, NULL, NULL);
+        jerry_release_value(args[0]);
+        jerry_release_value(args[1]);
+        serviced = 1;
+    }
 
-        handle->size = 0;
+    if (h->framer) {
+        if (h->rx_tail != h->rx_head) {
+            rx_frame(h);
+            serviced = 1;
+        }
+        return serviced;
+    }
+
+    // bound the batches per pass so a fast sender can't starve timers
+    for (int i = 0; i < ZJS_UART_RX_RING_SIZE / UART_READ_INITIAL_MAX; i++) {
+        uint32_t avail = h->rx_tail - h->rx_head;
+        if (!avail || avail < h->min) {
+            break;
+        }
+        uint32_t len = avail < h->max ? avail : h->max;
+
+        // small reads come from the buffer slab pools
+        jerry_value_t buf_obj = zjs_buffer_create(len);
+        zjs_buffer_t* buffer = zjs_buffer_find(buf_obj);
+        if (!buffer) {
+            // leave the data in the ring; if memory stays short, the ISR
+            //   counts what it can't store as overruns
+            ERR_PRINT("out of memory, delaying UART data\n");
+            jerry_release_value(buf_obj);
+            break;
+        }
+        rx_copy(h, buffer->buffer, len);
+        zjs_trigger_event_now(h->uart_obj, "read", &buf_obj, 1, NULL, NULL);
+        jerry_release_value(buf_obj);
+        serviced = 1;
+    }
+    return serviced;
+}
+
+static void tx_free(tx_node_t *node)
+{
+    jerry_release_value(node->buf_obj);
+    jerry_release_value(node->promise);
+    zjs_free(node);
+}
+
+static uint8_t tx_service(uart_handle *h)
+{
+    // effects: fulfills the promises of writes the ISR has finished, frees
+    //            the ones it has moved past, and emits 'drain' once the
+    //            queue empties after passing the high-water mark
+    uint8_t serviced = 0;
+    tx_node_t *current = h->tx_current;
+    for (tx_node_t *node = h->tx_first; node; node = node->next) {
+        if (node->sent < node->len) {
+            break;
+        }
+        if (!node->resolved) {
+            node->resolved = true;
+            h->tx_queued -= node->len;
+            zjs_fulfill_promise(node->promise, NULL, 0);
+            serviced = 1;
+        }
+        if (node == current) {
+            break;
+        }
+    }
+
+    while (h->tx_first && h->tx_first != current) {
+        tx_node_t *node = h->tx_first;
+        h->tx_first = node->next;
+        tx_free(node);
+    }
+
+    if (!h->tx_queued && h->tx_need_drain) {
+        h->tx_need_drain = false;
+        zjs_obj_add_boolean(h->uart_obj, false, "writableNeedDrain");
+        zjs_trigger_event_now(h->uart_obj, "drain", NULL, 0, NULL, NULL);
+        serviced = 1;
+    }
+    return serviced;
+}
+
+static uint8_t uart_service(void *unused)
+{
+    uart_handle *h = handle;
+    if (!h) {
+        return 0;
+    }
+    uint8_t serviced = rx_service(h);
+    if (tx_service(h)) {
+        serviced = 1;
     }
+    return serviced;
+}
+
+static void tx_fill(struct device *dev, uart_handle *h)
+{
+    // effects: fills the FIFO from the queued writes, and turns the TX
+    //            interrupt off once there is nothing left to send
+    tx_node_t *node = h->tx_current;
+    while (node) {
+        uint32_t sent = node->sent;
+        if (sent < node->len) {
+            sent += uart_fifo_fill(dev, node->data + sent, node->len - sent);
+            node->sent = sent;
+            if (sent < node->len) {
+                // the FIFO is full
+                return;
+            }
+        }
+        if (!node->next) {
+            break;
+        }
+        node = node->next;
+        ISR_BARRIER();
+        h->tx_current = node;
+    }
+    uart_irq_tx_disable(dev);
+}
+
+static void rx_fill(struct device *dev, uart_handle *h)
+{
+    // effects: reads the FIFO straight into the ring until it is empty,
+    //            counting bytes that don't fit as overruns
+    uint32_t len;
+    do {
+        uint32_t tail = h->rx_tail;
+        uint32_t space = ZJS_UART_RX_RING_SIZE - (tail - h->rx_head);
+        if (space) {
+            // contiguous space up to the end of the ring
+            uint32_t offset = tail & RX_MASK;
+            uint32_t chunk = ZJS_UART_RX_RING_SIZE - offset;
+            if (chunk > space) {
+                chunk = space;
+            }
+            len = uart_fifo_read(dev, h->rx_ring + offset, chunk);
+            ISR_BARRIER();
+            h->rx_tail = tail + len;
+        } else {
+            uint8_t discard[16];
+            len = uart_fifo_read(dev, discard, sizeof(discard));
+            h->rx_overruns += len;
+        }
+    } while (len);
 }
 
 static void uart_irq_handler(struct device *dev)
@@ -129,30 +391,23 @@ static void uart_irq_handler(struct device *dev)
     }
 
     if (uart_irq_tx_ready(dev)) {
-        tx = true;
+        if (handle) {
+            tx_fill(dev, handle);
+        } else {
+            uart_irq_tx_disable(dev);
+        }
     }
 
     if (uart_irq_rx_ready(dev)) {
-        uint32_t len = uart_fifo_read(dev, handle->buf, handle->max);
-        rx = true;
-        handle->buf[len] = '\0';
-        handle->size = len;
-        zjs_signal_callback(read_id, handle->buf, len);
+        if (handle) {
+            rx_fill(dev, handle);
+        } else {
+            uint8_t discard[16];
+            while (uart_fifo_read(dev, discard, sizeof(discard)));
+        }
     }
 }
 
-static int write_data(struct device *dev, const char *buf, int len)
-{
-    uart_irq_tx_enable(dev);
-
-    tx = false;
-    int bytes = uart_fifo_fill(dev, buf, len);
-    while (tx == false);
-
-    uart_irq_tx_disable(dev);
-    return bytes;
-}
-
 static jerry_value_t uart_write(const jerry_value_t function_obj,
                                 const jerry_value_t this,
                                 const jerry_value_t argv[],
@@ -169,18 +424,43 @@ static jerry_value_t uart_write(const jerry_value_t function_obj,
     jerry_value_t promise = jerry_create_object();
     zjs_make_promise(promise, NULL, NULL);
 
-    int wrote = write_data(uart_dev, (const char*)buffer->buffer,
-                           buffer->bufsize);
-    if (wrote == buffer->bufsize) {
-        zjs_fulfill_promise(promise, NULL, 0);
-    }
-    else {
-        jerry_value_t error = make_uart_error("WriteError",
-                "incomplete write");
+    tx_node_t *node = zjs_malloc(sizeof(tx_node_t));
+    if (!node) {
+        jerry_value_t error = make_uart_error("WriteError", "out of memory");
         zjs_reject_promise(promise, &error, 1);
         jerry_release_value(error);
+        return promise;
+    }
+
+    // the Buffer is sent as it is when its turn comes, without a copy
+    node->buf_obj = jerry_acquire_value(argv[0]);
+    node->promise = jerry_acquire_value(promise);
+    node->data = buffer->buffer;
+    node->len = buffer->bufsize;
+    node->sent = 0;
+    node->resolved = false;
+    node->next = NULL;
+
+    uart_handle *h = handle;
+    ISR_BARRIER();
+    if (h->tx_last) {
+        h->tx_last->next = node;
+    } else {
+        h->tx_first = node;
+    }
+    h->tx_last = node;
+    if (!h->tx_current) {
+        h->tx_current = node;
+    }
+
+    h->tx_queued += node->len;
+    if (h->tx_queued >= h->tx_high_water && !h->tx_need_drain) {
+        h->tx_need_drain = true;
+        zjs_obj_add_boolean(h->uart_obj, true, "writableNeedDrain");
     }
 
+    // the TX-ready interrupt fires right away if there is room in the FIFO
+    uart_irq_tx_enable(uart_dev);
     return promise;
 }
 
@@ -195,27 +475,90 @@ static jerry_value_t uart_set_read_range(const jerry_value_t function_obj,
     uint32_t min = jerry_get_number_value(argv[0]);
     uint32_t max = jerry_get_number_value(argv[1]);
 
-    if (handle->buf) {
-        void* old = handle->buf;
-        handle->buf = zjs_malloc(max);
-        memcpy(handle->buf, old, handle->size);
-        handle->buf[handle->size] = '\0';
-        zjs_free(old);
-        //if (handle->size >= min) {
-        //    jerry_value_t data = jerry_create_string((const jerry_char_t *)handle->buf);
-        //    zjs_trigger_event(handle->uart_obj, "read", &data, 1, NULL, NULL);
-        //}
-    } else {
-        handle->buf = zjs_malloc(max);
-        memset(handle->buf, 0, max);
-        handle->size = 0;
+    // a read can't wait for more than the ring holds
+    if (min < 1 || min > max || min > ZJS_UART_RX_RING_SIZE) {
+        return RANGE_ERROR("invalid read range");
     }
+
     handle->min = min;
     handle->max = max;
 
     return ZJS_UNDEFINED;
 }
 
+static jerry_value_t uart_set_framer(const jerry_value_t function_obj,
+                                     const jerry_value_t this,
+                                     const jerry_value_t argv[],
+                                     const jerry_length_t argc)
+{
+    // args: [options]
+    ZJS_VALIDATE_ARGS(Z_OPTIONAL Z_OBJECT Z_NULL);
+
+    zjs_framer_t *framer = NULL;
+    if (argc > 0 && jerry_value_is_object(argv[0])) {
+        jerry_value_t options = argv[0];
+        zjs_framer_config_t config;
+        memset(&config, 0, sizeof(config));
+        config.delimiter = '\n';
+        config.prefix_size = 2;
+        config.max_size = UART_FRAME_DEFAULT_MAX;
+
+        char type[12];
+        if (!zjs_obj_get_string(options, "type", type, sizeof(type))) {
+            return TYPE_ERROR("framer type required");
+        }
+        if (!strcmp(type, "delimiter")) {
+            config.type = ZJS_FRAMER_DELIMITER;
+        } else if (!strcmp(type, "fixed")) {
+            config.type = ZJS_FRAMER_FIXED;
+        } else if (!strcmp(type, "length")) {
+            config.type = ZJS_FRAMER_LENGTH;
+        } else if (!strcmp(type, "slip")) {
+            config.type = ZJS_FRAMER_SLIP;
+        } else if (!strcmp(type, "cobs")) {
+            config.type = ZJS_FRAMER_COBS;
+        } else {
+            return TYPE_ERROR("unknown framer type");
+        }
+
+        // the delimiter may be a byte value or a one character string
+        uint32_t num;
+        char delimiter[2];
+        if (zjs_obj_get_uint32(options, "delimiter", &num)) {
+            config.delimiter = num;
+        } else if (zjs_obj_get_string(options, "delimiter", delimiter,
+                                      sizeof(delimiter))) {
+            config.delimiter = delimiter[0];
+        }
+        if (zjs_obj_get_uint32(options, "prefixSize", &num)) {
+            config.prefix_size = num;
+        }
+        zjs_obj_get_boolean(options, "littleEndian", &config.little_endian);
+        zjs_obj_get_boolean(options, "crc", &config.crc16);
+        // a fixed frame is always maxLength bytes, so length means the same
+        if (zjs_obj_get_uint32(options, "maxLength", &num) ||
+            (config.type == ZJS_FRAMER_FIXED &&
+             zjs_obj_get_uint32(options, "length", &num))) {
+            config.max_size = num;
+        }
+
+        framer = zjs_framer_create(&config, uart_frame, uart_frame_error,
+                                   handle);
+        if (!framer) {
+            return RANGE_ERROR("invalid framer options");
+        }
+    }
+
+    if (handle->framing && !handle->framer_retired) {
+        // this is the framer calling back, free it once it returns
+        handle->framer_retired = handle->framer;
+    } else {
+        zjs_framer_free(handle->framer);
+    }
+    handle->framer = framer;
+    return ZJS_UNDEFINED;
+}
+
 static jerry_value_t uart_init(const jerry_value_t function_obj,
                                const jerry_value_t this,
                                const jerry_value_t argv[],
@@ -225,8 +568,8 @@ static jerry_value_t uart_init(const jerry_value_t function_obj,
     ZJS_VALIDATE_ARGS(Z_OBJECT);
 
     int i;
-    int baud = 115200;
 #ifdef CONFIG_UART_LINE_CTRL
+    int baud = 115200;
     int ret, dtr;
 #endif
     jerry_value_t promise = jerry_create_object();
@@ -251,12 +594,17 @@ static jerry_value_t uart_init(const jerry_value_t function_obj,
         return promise;
     }
 
+#ifdef CONFIG_UART_LINE_CTRL
     jerry_value_t baud_val = zjs_get_property(argv[0], "baud");
 
     if (jerry_value_is_number(baud_val)) {
         baud = (int)jerry_get_number_value(baud_val);
     }
     jerry_release_value(baud_val);
+#endif
+
+    uint32_t high_water = ZJS_UART_TX_HIGH_WATER;
+    zjs_obj_get_uint32(argv[0], "highWaterMark", &high_water);
 
     for (i = 0; i < (sizeof(device_map) / sizeof(device_map[0])); ++i) {
         // FIXME: we allowed 16-char string above but are only looking at 4?
@@ -319,22 +667,33 @@ static jerry_value_t uart_init(const jerry_value_t function_obj,
     }
     DBG_PRINT("baudrate set successfully: %ld\n", baud);
 #endif
+    // JerryScript object initialization, before the ISR can look at it
+    uart_handle *h = new_uart_handle();
+    if (!h) {
+        jerry_value_t error = make_uart_error("InternalError",
+                "out of memory");
+        zjs_reject_promise(promise, &error, 1);
+        jerry_release_value(error);
+        return promise;
+    }
+    h->uart_obj = jerry_create_object();
+    h->tx_high_water = high_water;
+    zjs_make_event(h->uart_obj, zjs_uart_prototype);
+    zjs_obj_add_boolean(h->uart_obj, false, "writableNeedDrain");
+    handle = h;
+
+    if (!service_registered) {
+        zjs_register_service_routine(NULL, uart_service);
+        service_registered = true;
+    }
+
     // Set the interrupt handler
     uart_irq_callback_set(uart_dev, uart_irq_handler);
 
     uart_irq_rx_enable(uart_dev);
 
-    // JerryScript object initialization
-    handle = new_uart_handle();
-
-    handle->uart_obj = jerry_create_object();
-
-    zjs_make_event(handle->uart_obj, zjs_uart_prototype);
-
     zjs_fulfill_promise(promise, &handle->uart_obj, 1);
 
-    read_id = zjs_add_c_callback(handle, uart_c_callback);
-
     return promise;
 }
 
@@ -343,6 +702,7 @@ jerry_value_t zjs_uart_init()
     zjs_native_func_t array[] = {
         { uart_write, "write" },
         { uart_set_read_range, "setReadRange" },
+        { uart_set_framer, "setFramer" },
         { NULL, NULL }
     };
     zjs_uart_prototype = jerry_create_object();
@@ -355,6 +715,25 @@ jerry_value_t zjs_uart_init()
 
 void zjs_uart_cleanup()
 {
+    if (handle) {
+        uart_irq_rx_disable(uart_dev);
+        uart_irq_tx_disable(uart_dev);
+        while (handle->tx_first) {
+            tx_node_t *node = handle->tx_first;
+            handle->tx_first = node->next;
+            tx_free(node);
+        }
+        zjs_framer_free(handle->framer);
+        jerry_release_value(handle->uart_obj);
+        zjs_free(handle);
+        handle = NULL;
+    }
+#ifdef ZJS_LINUX_BUILD
+    if (uart_dev) {
+        zjs_linux_uart_close(uart_dev);
+        uart_dev = NULL;
+    }
+#endif
     jerry_release_value(zjs_uart_prototype);
 }
 
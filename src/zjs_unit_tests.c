@@ -2,7 +2,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "zjs_binlog.h"
+#include "zjs_codec.h"
+#include "zjs_framer.h"
 #include "zjs_util.h"
 
 static int passed = 0;
@@ -39,6 +43,326 @@ static void test_hex_to_byte()
     zjs_assert(check_hex_to_byte("Aa", 0xaa), "hex to byte: Aa");
 }
 
+// Test zjs_find_byte, zjs_find_bytes and zjs_compare_bytes functions
+
+static void test_byte_kernels()
+{
+    // offset by one so the word loops start unaligned
+    uint8_t data[40];
+    for (int i = 0; i < sizeof(data); i++) {
+        data[i] = i + 1;
+    }
+    const uint8_t *buf = data + 1;
+    uint32_t len = sizeof(data) - 1;
+
+    zjs_assert(zjs_find_byte(buf, len, 2) == buf, "find byte: first");
+    zjs_assert(zjs_find_byte(buf, len, 40) == buf + 38, "find byte: last");
+    zjs_assert(zjs_find_byte(buf, len, 23) == buf + 21, "find byte: middle");
+    zjs_assert(zjs_find_byte(buf, len, 1) == NULL, "find byte: missing");
+    zjs_assert(zjs_find_byte(buf, 21, 23) == NULL, "find byte: past len");
+    zjs_assert(zjs_find_byte(buf, 0, 2) == NULL, "find byte: empty");
+
+    uint8_t needle[] = { 20, 21, 22 };
+    uint8_t missing[] = { 20, 22 };
+    zjs_assert(zjs_find_bytes(buf, len, needle, 3) == buf + 18,
+               "find bytes: middle");
+    zjs_assert(zjs_find_bytes(buf, len, missing, 2) == NULL,
+               "find bytes: missing");
+    zjs_assert(zjs_find_bytes(buf, 20, needle, 3) == NULL,
+               "find bytes: past len");
+    zjs_assert(zjs_find_bytes(buf, len, needle, 0) == buf,
+               "find bytes: empty needle");
+
+    uint8_t copy[40];
+    memcpy(copy, data, sizeof(data));
+    zjs_assert(zjs_compare_bytes(data, copy, 40) == 0, "compare bytes: equal");
+    copy[37] = 0;
+    zjs_assert(zjs_compare_bytes(data, copy, 40) == 1, "compare bytes: after");
+    zjs_assert(zjs_compare_bytes(copy, data, 40) == -1,
+               "compare bytes: before");
+    zjs_assert(zjs_compare_bytes(copy, data, 37) == 0,
+               "compare bytes: before difference");
+    copy[2] = 0xff;
+    zjs_assert(zjs_compare_bytes(data, copy, 40) == -1,
+               "compare bytes: unsigned order");
+}
+
+// Test hex, base64 and UTF-8 codecs
+
+static int check_base64(const char *text, const char *b64)
+{
+    uint32_t len = strlen(text);
+    char encoded[32];
+    uint8_t decoded[32];
+    zjs_base64_encode((const uint8_t *)text, len, encoded);
+    uint32_t size = ZJS_BASE64_ENCODED_SIZE(len);
+    if (size != strlen(b64) || memcmp(encoded, b64, size))
+        return 0;
+    if (zjs_base64_decoded_size(b64, size) != len)
+        return 0;
+    return zjs_base64_decode(b64, size, decoded) == len &&
+           !memcmp(decoded, text, len);
+}
+
+static void test_codecs()
+{
+    uint8_t bytes[] = { 0x00, 0x7f, 0xab, 0xff };
+    char hex[8];
+    uint8_t out[8];
+    zjs_hex_encode(bytes, 4, hex);
+    zjs_assert(!memcmp(hex, "007fabff", 8), "hex encode");
+    zjs_assert(zjs_hex_decode("007FabfF", 8, out) == 4 && !memcmp(out, bytes, 4),
+               "hex decode: mixed case");
+    zjs_assert(zjs_hex_decode("007", 3, out) == -1, "hex decode: odd length");
+    zjs_assert(zjs_hex_decode("0g", 2, out) == -1, "hex decode: invalid char");
+
+    zjs_assert(check_base64("", ""), "base64: empty");
+    zjs_assert(check_base64("f", "Zg=="), "base64: one byte");
+    zjs_assert(check_base64("fo", "Zm8="), "base64: two bytes");
+    zjs_assert(check_base64("foo", "Zm9v"), "base64: three bytes");
+    zjs_assert(check_base64("foobar", "Zm9vYmFy"), "base64: six bytes");
+    zjs_assert(zjs_base64_decode("Zm8", 3, out) == 2 && out[1] == 'o',
+               "base64 decode: unpadded");
+    zjs_assert(zjs_base64_decode("-_8=", 4, out) == 2 && out[0] == 0xfb &&
+               out[1] == 0xff, "base64 decode: url safe");
+    zjs_assert(zjs_base64_decode("Zm9v!A==", 8, out) == -1,
+               "base64 decode: invalid char");
+    zjs_assert(zjs_base64_decode("Zm9vY", 5, out) == -1,
+               "base64 decode: invalid length");
+
+    const uint8_t ascii[] = "plain";
+    const uint8_t bmp[] = { 'a', 0xc3, 0xa9, 0xe2, 0x82, 0xac };
+    const uint8_t astral[] = { 0xf0, 0x9f, 0x98, 0x80 };
+    const uint8_t cesu[] = { 0xed, 0xa0, 0xbd, 0xed, 0xb8, 0x80 };
+    const uint8_t bad[] = { 'a', 0xc0, 0xaf, 0xe2, 0x82 };
+    uint8_t conv[16];
+    zjs_assert(zjs_utf8_is_cesu8(ascii, 5), "utf8: ascii passes");
+    zjs_assert(zjs_utf8_is_cesu8(bmp, 6), "utf8: BMP passes");
+    zjs_assert(zjs_utf8_is_cesu8(cesu, 6), "utf8: surrogate pair passes");
+    zjs_assert(!zjs_utf8_is_cesu8(astral, 4), "utf8: astral needs converting");
+    zjs_assert(!zjs_utf8_is_cesu8(bad, 5), "utf8: invalid needs converting");
+    zjs_assert(zjs_utf8_to_cesu8(astral, 4, NULL) == 6 &&
+               zjs_utf8_to_cesu8(astral, 4, conv) == 6 &&
+               !memcmp(conv, "\xed\xa0\xbd\xed\xb8\x80", 6),
+               "utf8: astral to surrogate pair");
+    // overlong C0 AF is two invalid bytes, the truncated E2 82 one more
+    zjs_assert(zjs_utf8_to_cesu8(bad, 5, conv) == 10 && conv[0] == 'a' &&
+               !memcmp(conv + 1, "\xef\xbf\xbd", 3),
+               "utf8: invalid replaced");
+}
+
+// Test zjs_crc16 and the framers in zjs_framer.c
+
+typedef struct frames {
+    uint8_t data[64];   // frames, each followed by '|'
+    uint32_t len;
+    uint32_t errors;
+    uint8_t last_error;
+} frames_t;
+
+static void collect_frame(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    frames_t *frames = (frames_t *)ctx;
+    if (frames->len + len + 1 <= sizeof(frames->data)) {
+        memcpy(frames->data + frames->len, frame, len);
+        frames->len += len;
+        frames->data[frames->len++] = '|';
+    }
+}
+
+static void collect_error(void *ctx, uint8_t error)
+{
+    frames_t *frames = (frames_t *)ctx;
+    frames->errors++;
+    frames->last_error = error;
+}
+
+// expected frames as a literal, which may contain NULs
+#define FRAMES(str)  str, sizeof(str) - 1
+
+static int check_framer(zjs_framer_config_t *config, const char *input,
+                        uint32_t len, const char *expected, uint32_t exp_len,
+                        uint32_t errors)
+{
+    // checks the frames from input pushed whole, and then a byte at a time
+    for (int bytewise = 0; bytewise < 2; bytewise++) {
+        frames_t frames;
+        memset(&frames, 0, sizeof(frames));
+        zjs_framer_t *framer = zjs_framer_create(config, collect_frame,
+                                                 collect_error, &frames);
+        if (!framer) {
+            return 0;
+        }
+        if (bytewise) {
+            for (uint32_t i = 0; i < len; i++) {
+                zjs_framer_push(framer, (const uint8_t *)input + i, 1);
+            }
+        } else {
+            zjs_framer_push(framer, (const uint8_t *)input, len);
+        }
+        zjs_framer_free(framer);
+        if (frames.len != exp_len ||
+            memcmp(frames.data, expected, exp_len) ||
+            frames.errors != errors) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_framers()
+{
+    zjs_assert(zjs_crc16((const uint8_t *)"123456789", 9,
+                         ZJS_CRC16_INIT) == 0x29b1, "crc16: check value");
+
+    zjs_framer_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.type = ZJS_FRAMER_DELIMITER;
+    config.delimiter = '\n';
+    config.max_size = 8;
+    zjs_assert(check_framer(&config, "ab\n\ncd\nef", 10, FRAMES("ab|cd|"), 0),
+               "framer: delimiter, partial frame kept");
+    zjs_assert(check_framer(&config, "0123456789\nok\n", 14, FRAMES("ok|"), 1),
+               "framer: delimiter overflow drops one frame");
+
+    config.type = ZJS_FRAMER_FIXED;
+    config.max_size = 3;
+    zjs_assert(check_framer(&config, "abcdefgh", 8, FRAMES("abc|def|"), 0),
+               "framer: fixed");
+
+    config.type = ZJS_FRAMER_LENGTH;
+    config.prefix_size = 2;
+    config.max_size = 4;
+    zjs_assert(check_framer(&config, "\0\2ab\0\0\0\5xxxxx\0\1c", 17,
+                            FRAMES("ab||c|"), 1),
+               "framer: length prefix, big-endian, skips oversize frame");
+    config.little_endian = true;
+    zjs_assert(check_framer(&config, "\3\0abc", 5, FRAMES("abc|"), 0),
+               "framer: length prefix, little-endian");
+
+    config.type = ZJS_FRAMER_SLIP;
+    config.max_size = 8;
+    zjs_assert(check_framer(&config, "\xc0" "a\xdb\xdc\xdb\xdd" "b\xc0\xc0"
+                            "x\xdbyz\xc0" "ok\xc0", 17,
+                            FRAMES("a\xc0\xdb" "b|ok|"), 1),
+               "framer: SLIP escapes, bad escape drops frame");
+
+    config.type = ZJS_FRAMER_COBS;
+    zjs_assert(check_framer(&config, "\3ab\2c\1\0\4x\0", 10, FRAMES("ab\0c\0|"), 1),
+               "framer: COBS zeros restored, truncated block dropped");
+
+    // "hi" followed by its CRC, then the same with a flipped bit
+    uint16_t crc = zjs_crc16((const uint8_t *)"hi", 2, ZJS_CRC16_INIT);
+    char input[] = { 'h', 'i', crc >> 8, crc & 0xff, '\n',
+                     'h', 'i', crc >> 8, (crc & 0xff) ^ 1, '\n' };
+    config.type = ZJS_FRAMER_DELIMITER;
+    config.crc16 = true;
+    zjs_assert(check_framer(&config, input, sizeof(input), FRAMES("hi|"), 1),
+               "framer: CRC checked and stripped");
+
+    config.type = ZJS_FRAMER_LENGTH;
+    config.prefix_size = 3;
+    zjs_assert(!zjs_framer_create(&config, collect_frame, NULL, NULL),
+               "framer: invalid prefix size rejected");
+}
+
+// Test the binary console log decoder
+
+static uint32_t binlog_frame(uint8_t *out, const uint8_t *record, uint32_t len)
+{
+    // frames and escapes a record the way console.log sends it
+    uint32_t n = 0;
+    out[n++] = ZJS_BINLOG_START;
+    for (uint32_t i = 0; i < len; i++) {
+        if (ZJS_BINLOG_ESCAPED(record[i])) {
+            out[n++] = ZJS_BINLOG_ESC;
+            out[n++] = record[i] ^ ZJS_BINLOG_ESC_XOR;
+        } else {
+            out[n++] = record[i];
+        }
+    }
+    out[n++] = ZJS_BINLOG_END;
+    return n;
+}
+
+static int check_binlog(const uint8_t *stream, uint32_t len,
+                        const char *expected, uint32_t errors)
+{
+    // decodes stream after adding a CR before each LF, as the Zephyr UART
+    //   console does
+    uint8_t crlf[512];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        if (stream[i] == '\n') {
+            crlf[n++] = '\r';
+        }
+        crlf[n++] = stream[i];
+    }
+
+    char *text = NULL;
+    size_t size = 0;
+    FILE *in = fmemopen(crlf, n, "r");
+    FILE *out = open_memstream(&text, &size);
+    uint32_t result = zjs_binlog_decode(in, out);
+    fclose(in);
+    fclose(out);
+    int ok = result == errors && !strcmp(text, expected);
+    free(text);
+    return ok;
+}
+
+static void test_binlog()
+{
+    // 8.625f and 3.625 have LF and CR bytes in their encodings
+    float f = 8.625;
+    double d = 3.625;
+    uint8_t reset[] = { ZJS_BINLOG_RESET, ZJS_BINLOG_VERSION };
+    uint8_t log1[64] = {
+        ZJS_BINLOG_LOG,
+        ZJS_BINLOG_INT, 10,                 // 5, zigzag encoded
+        ZJS_BINLOG_INT, 13,                 // -7
+        ZJS_BINLOG_INT, 0xd0, 0x0f,         // 1000
+        ZJS_BINLOG_FLOAT, 0, 0, 0, 0,
+        ZJS_BINLOG_DOUBLE, 0, 0, 0, 0, 0, 0, 0, 0,
+        ZJS_BINLOG_ATOM_DEF, 0, 5, 'l', 'a', 'b', 'e', 'l',
+        ZJS_BINLOG_ATOM, 0,
+        ZJS_BINLOG_ARRAY, 2, ZJS_BINLOG_INT, 2, ZJS_BINLOG_STRING, 1, 'x'
+    };
+    uint32_t log1_len = 39;
+    memcpy(log1 + 9, &f, sizeof(f));
+    memcpy(log1 + 14, &d, sizeof(d));
+    uint8_t log2[] = {
+        ZJS_BINLOG_LOG,
+        ZJS_BINLOG_ATOM, 0,
+        ZJS_BINLOG_STRING, 10,
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9'
+    };
+
+    uint8_t stream[256];
+    uint32_t len = 0;
+    memcpy(stream, "boot\n", 5);
+    len += 5;
+    len += binlog_frame(stream + len, reset, sizeof(reset));
+    len += binlog_frame(stream + len, log1, log1_len);
+    len += binlog_frame(stream + len, log2, sizeof(log2));
+    memcpy(stream + len, "done\n", 5);
+    len += 5;
+
+    const char *expected = "boot\r\n"
+                           "5 -7 1000 8.625000 3.625000 label label [1, \"x\"]\n"
+                           "label 0123456789\n"
+                           "done\r\n";
+    zjs_assert(check_binlog(stream, len, expected, 0),
+               "binlog: values, atoms and arrays decoded through CR LF");
+
+    // a line ending a console adds inside a record is skipped
+    uint32_t split = len - 5 - sizeof(log2);
+    memmove(stream + split + 1, stream + split, len - split);
+    stream[split] = '\n';
+    zjs_assert(check_binlog(stream, len + 1, expected, 0),
+               "binlog: raw line ending inside a record skipped");
+}
+
 // Test zjs_default_convert_pin function
 
 static void test_default_convert_pin()
@@ -90,6 +414,10 @@ static void test_compress_32()
 void zjs_run_unit_tests()
 {
     test_hex_to_byte();
+    test_byte_kernels();
+    test_codecs();
+    test_framers();
+    test_binlog();
     test_default_convert_pin();
     test_compress_32();
 
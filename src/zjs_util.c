@@ -3,7 +3,11 @@
 #include <string.h>
 
 // ZJS includes
+#include "zjs_console.h"
 #include "zjs_util.h"
+#ifdef ZJS_PROFILE_NATIVE
+#include "zjs_profile.h"
+#endif
 
 void zjs_set_property(const jerry_value_t obj, const char *str,
                       const jerry_value_t prop)
@@ -35,6 +39,54 @@ bool zjs_delete_property(const jerry_value_t obj, const char *name)
     return rval;
 }
 
+#define ZJS_PROP_INIT(id, str) str,
+static const char *prop_strings[ZJS_PROP_COUNT] = {
+    ZJS_PROP_NAMES(ZJS_PROP_INIT)
+};
+#undef ZJS_PROP_INIT
+
+jerry_value_t zjs_prop_names[ZJS_PROP_COUNT];
+
+void zjs_init_prop_names()
+{
+    for (int i = 0; i < ZJS_PROP_COUNT; i++) {
+        zjs_prop_names[i] =
+            jerry_create_string((const jerry_char_t *)prop_strings[i]);
+    }
+}
+
+void zjs_cleanup_prop_names()
+{
+    for (int i = 0; i < ZJS_PROP_COUNT; i++) {
+        jerry_release_value(zjs_prop_names[i]);
+        zjs_prop_names[i] = 0;
+    }
+}
+
+void zjs_wrap(jerry_value_t obj, zjs_native_t *native, uint8_t class_id,
+              jerry_object_free_callback_t free_cb)
+{
+    native->magic = ZJS_NATIVE_MAGIC;
+    native->class_id = class_id;
+    jerry_set_object_native_handle(obj, (uintptr_t)native, free_cb);
+}
+
+void *zjs_unwrap(jerry_value_t obj, uint8_t class_id)
+{
+    // effects: returns obj's native struct if it was attached by zjs_wrap
+    //            with class_id, otherwise NULL; closed handles that were
+    //            cleared to NULL also return NULL
+    uintptr_t handle;
+    if (!jerry_get_object_native_handle(obj, &handle) || !handle) {
+        return NULL;
+    }
+    zjs_native_t *native = (zjs_native_t *)handle;
+    if (native->magic != ZJS_NATIVE_MAGIC || native->class_id != class_id) {
+        return NULL;
+    }
+    return native;
+}
+
 void zjs_obj_add_functions(jerry_value_t obj, zjs_native_func_t *funcs)
 {
     // requires: obj is an existing JS object
@@ -51,9 +103,17 @@ void zjs_obj_add_boolean(jerry_value_t obj, bool flag, const char *name)
     // requires: obj is an existing JS object
     //  effects: creates a new field in parent named name, set to value
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
-    jerry_value_t jbool = jerry_create_boolean(flag);
-    jerry_set_property(obj, jname, jbool);
+    zjs_obj_add_boolean_prop(obj, flag, jname);
     jerry_release_value(jname);
+}
+
+void zjs_obj_add_boolean_prop(jerry_value_t obj, bool flag,
+                              jerry_value_t name)
+{
+    // requires: obj is an existing JS object, name is a string
+    //  effects: creates a new field in parent named name, set to value
+    jerry_value_t jbool = jerry_create_boolean(flag);
+    jerry_set_property(obj, name, jbool);
     jerry_release_value(jbool);
 }
 
@@ -67,7 +127,11 @@ void zjs_obj_add_function(jerry_value_t obj, void *func, const char *name)
     //   released before we return, but in a loop of 25k buffer creates there
     //   seemed to be no memory leak. Reconsider with future intelligence.
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+#ifdef ZJS_PROFILE_NATIVE
+    jerry_value_t jfunc = zjs_profile_wrap_function(func, name);
+#else
     jerry_value_t jfunc = jerry_create_external_function(func);
+#endif
     if (jerry_value_is_function(jfunc)) {
         jerry_set_property(obj, jname, jfunc);
     }
@@ -102,6 +166,15 @@ void zjs_obj_add_readonly_string(jerry_value_t obj, const char *str,
     // requires: obj is an existing JS object
     //  effects: creates a new readonly field in parent named name, set to str
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+    zjs_obj_add_readonly_string_prop(obj, str, jname);
+    jerry_release_value(jname);
+}
+
+void zjs_obj_add_readonly_string_prop(jerry_value_t obj, const char *str,
+                                      jerry_value_t name)
+{
+    // requires: obj is an existing JS object, name is a string
+    //  effects: creates a new readonly field in parent named name, set to str
     jerry_property_descriptor_t pd;
     jerry_init_property_descriptor_fields(&pd);
     pd.is_writable_defined = true;
@@ -110,9 +183,8 @@ void zjs_obj_add_readonly_string(jerry_value_t obj, const char *str,
     pd.is_configurable = true;
     pd.is_value_defined = true;
     pd.value = jerry_create_string((const jerry_char_t *)str);
-    jerry_define_own_property(obj, jname, &pd);
+    jerry_define_own_property(obj, name, &pd);
     jerry_free_property_descriptor_fields(&pd);
-    jerry_release_value(jname);
 }
 
 void zjs_obj_add_number(jerry_value_t obj, double num, const char *name)
@@ -132,14 +204,22 @@ void zjs_obj_add_readonly_number(jerry_value_t obj, double num,
     // requires: obj is an existing JS object
     //  effects: creates a new readonly field in parent named name, set to num
     jerry_value_t jname = jerry_create_string((const jerry_char_t *)name);
+    zjs_obj_add_readonly_number_prop(obj, num, jname);
+    jerry_release_value(jname);
+}
+
+void zjs_obj_add_readonly_number_prop(jerry_value_t obj, double num,
+                                      jerry_value_t name)
+{
+    // requires: obj is an existing JS object, name is a string
+    //  effects: creates a new readonly field in parent named name, set to num
     jerry_property_descriptor_t pd;
     jerry_init_property_descriptor_fields(&pd);
     pd.is_writable = false;
     pd.is_value_defined = true;
     pd.value = jerry_create_number(num);
-    jerry_define_own_property(obj, jname, &pd);
+    jerry_define_own_property(obj, name, &pd);
     jerry_free_property_descriptor_fields(&pd);
-    jerry_release_value(jname);
 }
 
 bool zjs_obj_get_boolean(jerry_value_t obj, const char *name, bool *flag)
@@ -285,6 +365,80 @@ bool zjs_hex_to_byte(const char *buf, uint8_t *byte)
     return true;
 }
 
+// true if any byte of word is zero
+#define HAS_ZERO_BYTE(word) (((word) - 0x01010101) & ~(word) & 0x80808080)
+
+const uint8_t *zjs_find_byte(const uint8_t *buf, uint32_t len, uint8_t byte)
+{
+    // check bytes up to a word boundary, then four at a time by xoring with
+    //   the byte repeated so a match becomes a zero byte
+    while (len && ((uintptr_t)buf & (sizeof(uint32_t) - 1))) {
+        if (*buf == byte)
+            return buf;
+        buf++;
+        len--;
+    }
+
+    uint32_t repeated = byte * 0x01010101;
+    while (len >= sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, buf, sizeof(word));
+        word ^= repeated;
+        if (HAS_ZERO_BYTE(word))
+            break;
+        buf += sizeof(word);
+        len -= sizeof(word);
+    }
+
+    while (len--) {
+        if (*buf == byte)
+            return buf;
+        buf++;
+    }
+    return NULL;
+}
+
+const uint8_t *zjs_find_bytes(const uint8_t *buf, uint32_t len,
+                              const uint8_t *needle, uint32_t nlen)
+{
+    if (!nlen)
+        return buf;
+
+    const uint8_t *end = buf + len;
+    while (nlen <= end - buf) {
+        // find candidates by their first byte, then check the rest
+        const uint8_t *match = zjs_find_byte(buf, end - buf - nlen + 1,
+                                             needle[0]);
+        if (!match)
+            return NULL;
+        if (!zjs_compare_bytes(match + 1, needle + 1, nlen - 1))
+            return match;
+        buf = match + 1;
+    }
+    return NULL;
+}
+
+int zjs_compare_bytes(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    // skip equal words, then find the differing byte to order by
+    while (len >= sizeof(uint32_t)) {
+        uint32_t wa, wb;
+        memcpy(&wa, a, sizeof(wa));
+        memcpy(&wb, b, sizeof(wb));
+        if (wa != wb)
+            break;
+        a += sizeof(wa);
+        b += sizeof(wb);
+        len -= sizeof(wa);
+    }
+
+    for (; len; len--, a++, b++) {
+        if (*a != *b)
+            return *a < *b ? -1 : 1;
+    }
+    return 0;
+}
+
 void zjs_default_convert_pin(uint32_t orig, int *dev, int *pin) {
     // effects: reads top three bits of the bottom byte of orig and writes them
     //            to dev and the bottom five bits and writes them to pin; thus
@@ -343,6 +497,9 @@ void zjs_print_error_message(jerry_value_t error)
 {
     const char *uncaught = "Uncaught exception: ";
 
+    // print after any buffered console output from before the error
+    zjs_console_flush();
+
     uint32_t size;
     char* message = NULL;
     jerry_value_t err_name = zjs_get_property(error, "name");
@@ -385,17 +542,10 @@ void zjs_print_error_message(jerry_value_t error)
     }
 }
 
-bool zjs_true(const jerry_value_t value)
-{
-    // return true for any value
-    return true;
-}
-
 typedef bool (*zjs_type_test)(const jerry_value_t);
 
-// NOTE: These must match the order of Z_ANY to Z_UNDEFINED in zjs_util.h
-zjs_type_test zjs_type_map[] = {
-    zjs_true,
+// NOTE: These must match the order of the ZJS_TYPE_* bits in zjs_util.h
+static const zjs_type_test zjs_type_map[] = {
     jerry_value_is_array,
     jerry_value_is_boolean,
     jerry_value_is_function,
@@ -406,65 +556,47 @@ zjs_type_test zjs_type_map[] = {
     jerry_value_is_undefined
 };
 
-static int zjs_validate_arg(const char *expectation, jerry_value_t arg)
-{
-    // requires: If this argument is optional, first char of expectation must
-    //             be '?'; then additional chars are one of "abflnosu", meaning
-    //             array, boolean, float, nul(l), number, object, string or
-    //             undefined, and it must be null-terminated.
-    //  effects: returns a value from enum above
-    bool optional = false;
-    int index = 0;
-    if (expectation[0] == Z_OPTIONAL[0]) {
-        optional = true;
-        ++index;
-    }
-
-    while (expectation[index] != '\0') {
-        // NOTE: This relies on Z_ANY to Z_UNDEFINED being consecutive and
-        //   Z_UNDEFINED being the last one
-        int type_index = expectation[index] - Z_ANY[0];
-        if (type_index < 0 || type_index > Z_UNDEFINED[0]) {
-            ERR_PRINT("invalid argument type: '%c'", expectation[index]);
-            return ZJS_INTERNAL_ERROR;
-        }
-
-        if (zjs_type_map[type_index](arg)) {
-            return optional ? ZJS_VALID_OPTIONAL : ZJS_VALID_REQUIRED;
+static bool zjs_type_matches(zjs_ztype_t expect, const jerry_value_t arg)
+{
+    // effects: returns true if arg has one of the types in expect; JerryScript
+    //            has no call that returns a value's type, so only the types
+    //            expected are tested, usually just one
+    if (expect & ZJS_TYPE_ANY) {
+        return true;
+    }
+    expect &= ~ZJS_TYPE_OPTIONAL;
+    while (expect) {
+        int bit = __builtin_ctz(expect);
+        if (zjs_type_map[bit](arg)) {
+            return true;
         }
-
-        ++index;
+        expect &= expect - 1;
     }
-
-    return optional ? ZJS_SKIP_OPTIONAL : ZJS_INVALID_ARG;
+    return false;
 }
 
-int zjs_validate_args(const char *expectations[], const jerry_length_t argc,
-                      const jerry_value_t argv[])
+int zjs_validate_args(const zjs_ztype_t expectations[],
+                      const jerry_length_t argc, const jerry_value_t argv[])
 {
     // effects: returns number of optional arguments found, or a negative
     //            number on error
     int expect_index = 0, arg_index = 0, opt_args = 0;
-    while (expectations[expect_index] != NULL && arg_index < argc) {
-        int rval = zjs_validate_arg(expectations[expect_index],
-                                    argv[arg_index]);
-        switch (rval) {
-        case ZJS_VALID_OPTIONAL:
-            ++opt_args;
-        case ZJS_VALID_REQUIRED:
+    while (expectations[expect_index] && arg_index < argc) {
+        zjs_ztype_t expect = expectations[expect_index++];
+        if (zjs_type_matches(expect, argv[arg_index])) {
             ++arg_index;
-        case ZJS_SKIP_OPTIONAL:
-            ++expect_index;
-            break;
-
-        default:
-            return rval;
+            if (expect & ZJS_TYPE_OPTIONAL) {
+                ++opt_args;
+            }
+        } else if (!(expect & ZJS_TYPE_OPTIONAL)) {
+            return ZJS_INVALID_ARG;
         }
+        // else skip this optional expectation and try the next one
     }
 
     // check for any more required args
-    while (expectations[expect_index] != NULL) {
-        if (expectations[expect_index][0] != '?')
+    while (expectations[expect_index]) {
+        if (!(expectations[expect_index] & ZJS_TYPE_OPTIONAL))
             return ZJS_INSUFFICIENT_ARGS;
         ++expect_index;
     }
@@ -11,18 +11,26 @@
 
 #define ZJS_UNDEFINED jerry_create_undefined()
 
+#ifdef ZJS_PROFILE_NATIVE
+// bytes requested so far, sampled around each native call by zjs_profile.c
+extern uint32_t zjs_profile_alloc_bytes;
+#define ZJS_COUNT_ALLOC(sz) (zjs_profile_alloc_bytes += (sz))
+#else
+#define ZJS_COUNT_ALLOC(sz) ((void)0)
+#endif
+
 #ifdef ZJS_LINUX_BUILD
 #include <stdlib.h>
-#define zjs_malloc(sz) malloc(sz)
+#define zjs_malloc(sz) ({size_t zjs_sz = (sz); ZJS_COUNT_ALLOC(zjs_sz); malloc(zjs_sz);})
 #define zjs_free(ptr) free((void *)ptr)
 #else
 #ifdef ZJS_TRACE_MALLOC
 #include <zephyr.h>
-#define zjs_malloc(sz) ({void *zjs_ptr = k_malloc(sz); ZJS_PRINT("%s:%d: allocating %lu bytes (%p)\n", __func__, __LINE__, (uint32_t)sz, zjs_ptr); zjs_ptr;})
+#define zjs_malloc(sz) ({size_t zjs_sz = (sz); void *zjs_ptr = k_malloc(zjs_sz); ZJS_COUNT_ALLOC(zjs_sz); ZJS_PRINT("%s:%d: allocating %lu bytes (%p)\n", __func__, __LINE__, (unsigned long)zjs_sz, zjs_ptr); zjs_ptr;})
 #define zjs_free(ptr) (ZJS_PRINT("%s:%d: freeing %p\n", __func__, __LINE__, ptr), k_free(ptr))
 #else
 #include <zephyr.h>
-#define zjs_malloc(sz) k_malloc(sz)
+#define zjs_malloc(sz) ({size_t zjs_sz = (sz); ZJS_COUNT_ALLOC(zjs_sz); k_malloc(zjs_sz);})
 #define zjs_free(ptr) k_free(ptr)
 #endif  // ZJS_TRACE_MALLOC
 #endif  // ZJS_LINUX_BUILD
@@ -32,6 +40,113 @@ void zjs_set_property(const jerry_value_t obj, const char *str,
 jerry_value_t zjs_get_property (const jerry_value_t obj, const char *str);
 bool zjs_delete_property(const jerry_value_t obj, const char *str);
 
+// properties whose names start with \377 can't be reached from JS
+#ifdef DEBUG_BUILD
+#define HIDDEN_PROP(n) n
+#else
+#define HIDDEN_PROP(n) "\377" n
+#endif
+
+// Property names used on hot paths. They are created once at startup by
+//   zjs_init_prop_names() and held until zjs_cleanup_prop_names(), so looking
+//   one up with ZJS_PROP(name) doesn't create and free a string each time.
+#define ZJS_PROP_NAMES(X)                       \
+    X(error,            "error")                \
+    X(event,            HIDDEN_PROP("event"))   \
+    X(illuminance,      "illuminance")          \
+    X(message,          "message")              \
+    X(name,             "name")                 \
+    X(onactivate,       "onactivate")           \
+    X(onchange,         "onchange")             \
+    X(onerror,          "onerror")              \
+    X(onstatechange,    "onstatechange")        \
+    X(promise,          "promise")              \
+    X(reading,          "reading")              \
+    X(state,            "state")                \
+    X(value,            "value")                \
+    X(x,                "x")                    \
+    X(y,                "y")                    \
+    X(z,                "z")
+
+#define ZJS_PROP_ENUM(id, str) ZJS_PROP_##id,
+enum zjs_prop_id {
+    ZJS_PROP_NAMES(ZJS_PROP_ENUM)
+    ZJS_PROP_COUNT
+};
+#undef ZJS_PROP_ENUM
+
+extern jerry_value_t zjs_prop_names[ZJS_PROP_COUNT];
+
+// the interned name for id, e.g. jerry_get_property(obj, ZJS_PROP(onchange));
+//   it is owned by the table and must not be released
+#define ZJS_PROP(id) (zjs_prop_names[ZJS_PROP_##id])
+
+/** Create the ZJS_PROP() names, call right after jerry_init(). */
+void zjs_init_prop_names();
+
+/** Release the ZJS_PROP() names, call before jerry_cleanup(). */
+void zjs_cleanup_prop_names();
+
+// Classes of native structs attached to JS objects. Each such struct starts
+//   with a zjs_native_t naming its class, so zjs_unwrap() can tell in O(1)
+//   whether an object wraps the struct a native expects, rather than
+//   misreading e.g. a Buffer passed where a GPIO pin was expected. The magic
+//   byte makes it unlikely that an untagged handle from a module that hasn't
+//   been converted yet passes for a tagged one.
+#define ZJS_NATIVE_CLASSES(X)   \
+    X(BUFFER)                   \
+    X(DGRAM_SOCKET)             \
+    X(EVENT_EMITTER)            \
+    X(FS_STATS)                 \
+    X(GPIO_PIN)                 \
+    X(GPIO_PORT)                \
+    X(PROMISE)                  \
+    X(SENSOR)                   \
+    X(TIMER)
+
+#define ZJS_CLASS_ENUM(name) ZJS_CLASS_##name,
+enum zjs_native_class {
+    ZJS_CLASS_NONE,
+    ZJS_NATIVE_CLASSES(ZJS_CLASS_ENUM)
+    ZJS_CLASS_COUNT
+};
+#undef ZJS_CLASS_ENUM
+
+#define ZJS_NATIVE_MAGIC        0xa5
+
+typedef struct zjs_native {
+    uint8_t magic;
+    uint8_t class_id;
+} zjs_native_t;
+
+/**
+ * Attach a native struct to a JS object, tagged with its class.
+ *
+ * @param obj       Object to attach to
+ * @param native    First member of the struct to attach
+ * @param class_id  One of the ZJS_CLASS_* values
+ * @param free_cb   Called with the struct when obj is collected, may be NULL
+ */
+void zjs_wrap(jerry_value_t obj, zjs_native_t *native, uint8_t class_id,
+              jerry_object_free_callback_t free_cb);
+
+/**
+ * Get the native struct attached to a JS object by zjs_wrap.
+ *
+ * @param obj       Any JS value
+ * @param class_id  Expected ZJS_CLASS_* value
+ * @return The struct, or NULL if obj doesn't wrap one of class class_id
+ */
+void *zjs_unwrap(jerry_value_t obj, uint8_t class_id);
+
+// declares var, the native struct of class ZJS_CLASS_##class attached to obj,
+//   and returns a TypeError from the calling function if there isn't one
+#define ZJS_GET_HANDLE(obj, type, var, class)                           \
+    type *var = (type *)zjs_unwrap(obj, ZJS_CLASS_##class);             \
+    if (!var) {                                                         \
+        return TYPE_ERROR("expected " #class " object");                \
+    }
+
 typedef struct zjs_native_func {
     void *function;
     const char *name;
@@ -56,6 +171,14 @@ void zjs_obj_add_number(jerry_value_t obj, double num, const char *name);
 void zjs_obj_add_readonly_number(jerry_value_t obj, double num,
                                  const char *name);
 
+// variants of the above taking a property name such as ZJS_PROP(x)
+void zjs_obj_add_boolean_prop(jerry_value_t obj, bool flag,
+                              jerry_value_t name);
+void zjs_obj_add_readonly_string_prop(jerry_value_t obj, const char *str,
+                                      jerry_value_t name);
+void zjs_obj_add_readonly_number_prop(jerry_value_t obj, double num,
+                                      jerry_value_t name);
+
 bool zjs_obj_get_boolean(jerry_value_t obj, const char *name, bool *flag);
 bool zjs_obj_get_string(jerry_value_t obj, const char *name, char *buffer,
                         int len);
@@ -96,6 +219,38 @@ char *zjs_alloc_from_jstring(jerry_value_t jstr, jerry_size_t *maxlen);
 
 bool zjs_hex_to_byte(const char *buf, uint8_t *byte);
 
+// Byte kernels that work a word at a time, since the Zephyr minimal libc
+//   versions of memchr and memcmp go byte by byte
+
+/**
+ * Find the first occurrence of a byte.
+ *
+ * @param buf   Bytes to search
+ * @param len   Number of bytes in buf
+ * @param byte  Value to find
+ * @return Pointer to the byte within buf, or NULL if not found
+ */
+const uint8_t *zjs_find_byte(const uint8_t *buf, uint32_t len, uint8_t byte);
+
+/**
+ * Find the first occurrence of a sequence of bytes.
+ *
+ * @param buf     Bytes to search
+ * @param len     Number of bytes in buf
+ * @param needle  Bytes to find
+ * @param nlen    Number of bytes in needle, 0 matches at buf
+ * @return Pointer to the match within buf, or NULL if not found
+ */
+const uint8_t *zjs_find_bytes(const uint8_t *buf, uint32_t len,
+                              const uint8_t *needle, uint32_t nlen);
+
+/**
+ * Compare two byte ranges as unsigned bytes, like memcmp.
+ *
+ * @return -1, 0 or 1 as a sorts before, equal to or after b
+ */
+int zjs_compare_bytes(const uint8_t *a, const uint8_t *b, uint32_t len);
+
 void zjs_default_convert_pin(uint32_t orig, int *dev, int *pin);
 
 uint16_t zjs_compress_32_to_16(uint32_t num);
@@ -106,22 +261,41 @@ void zjs_print_error_message(jerry_value_t error);
 //
 // ztypes (for argument validation)
 //
+// Each ztype expands to a unary plus and a bit, so a space-separated list of
+//   them like Z_OPTIONAL Z_NUMBER is a constant sum of distinct bits, i.e. a
+//   bitmask built at compile time. Don't repeat a ztype within one argument.
+//
+
+typedef uint16_t zjs_ztype_t;
 
-// Z_OPTIONAL means the argument isn't required, this must come first if present
-#define Z_OPTIONAL  "?"
+// one bit per type test, in the order of zjs_type_map in zjs_util.c, plus
+//   ZJS_TYPE_OPTIONAL
+#define ZJS_TYPE_ARRAY      0x0001
+#define ZJS_TYPE_BOOL       0x0002
+#define ZJS_TYPE_FUNCTION   0x0004
+#define ZJS_TYPE_NULL       0x0008
+#define ZJS_TYPE_NUMBER     0x0010
+#define ZJS_TYPE_OBJECT     0x0020
+#define ZJS_TYPE_STRING     0x0040
+#define ZJS_TYPE_UNDEFINED  0x0080
+#define ZJS_TYPE_ANY        0x0100
+#define ZJS_TYPE_OPTIONAL   0x8000
+
+// Z_OPTIONAL means the argument isn't required
+#define Z_OPTIONAL  +ZJS_TYPE_OPTIONAL
 
 // Z_ANY matches any type (i.e. ignores it) - only makes sense for required arg
-#define Z_ANY       "a"
-
-// the rest all match specific type by calling jerry_value_is_* function
-#define Z_ARRAY     "b"
-#define Z_BOOL      "c"
-#define Z_FUNCTION  "d"
-#define Z_NULL      "e"
-#define Z_NUMBER    "f"
-#define Z_OBJECT    "g"
-#define Z_STRING    "h"
-#define Z_UNDEFINED "i"
+#define Z_ANY       +ZJS_TYPE_ANY
+
+// the rest all match a specific type
+#define Z_ARRAY     +ZJS_TYPE_ARRAY
+#define Z_BOOL      +ZJS_TYPE_BOOL
+#define Z_FUNCTION  +ZJS_TYPE_FUNCTION
+#define Z_NULL      +ZJS_TYPE_NULL
+#define Z_NUMBER    +ZJS_TYPE_NUMBER
+#define Z_OBJECT    +ZJS_TYPE_OBJECT
+#define Z_STRING    +ZJS_TYPE_STRING
+#define Z_UNDEFINED +ZJS_TYPE_UNDEFINED
 
 enum {
     ZJS_VALID_REQUIRED,
@@ -132,8 +306,17 @@ enum {
     ZJS_INSUFFICIENT_ARGS = -3
 };
 
-int zjs_validate_args(const char *expectations[], const jerry_length_t argc,
-                      const jerry_value_t argv[]);
+/**
+ * Check argv against expectations built from ztypes.
+ *
+ * @param expectations  One ztype mask per argument, terminated by 0
+ * @param argc          Number of arguments in argv
+ * @param argv          Arguments to check
+ * @return Number of optional args found, or ZJS_INVALID_ARG or
+ *           ZJS_INSUFFICIENT_ARGS
+ */
+int zjs_validate_args(const zjs_ztype_t expectations[],
+                      const jerry_length_t argc, const jerry_value_t argv[]);
 /**
  * Macro to validate existing argv based on a list of expected argument types.
  *
@@ -144,7 +327,8 @@ int zjs_validate_args(const char *expectations[], const jerry_length_t argc,
  * @param offset    Integer offset of arg in argv to start with (normally 0)
  * @param typestr   Each remaining comma-separated argument to the macro
  *                    corresponds to an argument in argv; each argument should
- *                    be a space-separated list of "ztypes" from defines above.
+ *                    be a space-separated list of "ztypes" from defines above,
+ *                    or a zjs_ztype_t variable holding one.
  *
  * Example: ZJS_VALIDATE_ARGS(Z_NUMBER, Z_OBJECT Z_NULL, Z_OPTIONAL Z_FUNCTION);
  * This requires argv[0] to be a number type, argv[1] to be an object type
@@ -153,7 +337,7 @@ int zjs_validate_args(const char *expectations[], const jerry_length_t argc,
  *   beyond what are specified are allowed and ignored.
  */
 #define ZJS_VALIDATE_ARGS_FULL(optcount, offset, ...)                   \
-    const char *zjs_expectations[] = { __VA_ARGS__, NULL };             \
+    const zjs_ztype_t zjs_expectations[] = { __VA_ARGS__, 0 };          \
     int optcount = zjs_validate_args(zjs_expectations, argc - offset,   \
                                      argv + offset);                    \
     if (optcount <= ZJS_INVALID_ARG) {                                  \
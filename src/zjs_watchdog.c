@@ -0,0 +1,256 @@
+// Copyright (c) 2017, Intel Corporation.
+#ifdef ZJS_WATCHDOG
+
+#include <string.h>
+
+#ifndef ZJS_LINUX_BUILD
+#include <zephyr.h>
+#include "zjs_zephyr_port.h"
+#define watchdog_uptime_ms  k_uptime_get_32
+#else
+#include <pthread.h>
+#include "zjs_linux_port.h"
+#define watchdog_uptime_ms  zjs_port_timer_get_uptime
+#endif
+
+// ZJS includes
+#ifdef BUILD_MODULE_EVENTS
+#include "zjs_event.h"
+#endif
+#include "zjs_util.h"
+#include "zjs_watchdog.h"
+
+// number of stalls remembered, must be a power of 2
+#define STALL_HISTORY           8
+#define STALL_NAME_SIZE         16
+
+typedef struct stall_record {
+    zjs_callback_id id;
+    const char *kind;
+    char name[STALL_NAME_SIZE];
+    uint32_t duration_us;
+    uint32_t time_ms;               // uptime when the dispatch started
+} stall_record_t;
+
+static uint32_t stall_budget_us = ZJS_STALL_BUDGET_MS * 1000;
+static stall_record_t stall_history[STALL_HISTORY];
+static uint32_t stall_count = 0;
+
+// the dispatch in progress; written by the main loop and read by the monitor
+//   thread on Linux, which only reports it once the loop is stuck
+static volatile uint8_t depth = 0;
+static volatile uint32_t dispatch_seq = 0;
+static stall_record_t current;
+static zjs_port_cycles_t current_start;
+
+static jerry_value_t watchdog_obj = 0;
+
+void zjs_watchdog_enter(zjs_callback_id id, const char *kind,
+                        const char *name)
+{
+    if (depth++) {
+        return;
+    }
+
+    // copy the name now, the callback may be freed before the dispatch ends
+    current.id = id;
+    current.kind = kind;
+    current.name[0] = '\0';
+    if (name) {
+        strncpy(current.name, name, STALL_NAME_SIZE - 1);
+        current.name[STALL_NAME_SIZE - 1] = '\0';
+    }
+    current.time_ms = watchdog_uptime_ms();
+    current_start = zjs_port_get_cycles();
+    dispatch_seq++;
+}
+
+static void print_record(const stall_record_t *record)
+{
+    ZJS_PRINT("  at %u ms: callback %d (%s%s%s) ran %u us\n",
+              record->time_ms, record->id, record->kind,
+              record->name[0] ? " " : "", record->name, record->duration_us);
+}
+
+#ifdef BUILD_MODULE_EVENTS
+static jerry_value_t create_stall_info(const stall_record_t *record)
+{
+    jerry_value_t info = jerry_create_object();
+    zjs_obj_add_number(info, record->id, "id");
+    zjs_obj_add_string(info, record->kind, "source");
+    zjs_obj_add_string(info, record->name, "name");
+    zjs_obj_add_number(info, (double)record->duration_us / 1000, "duration");
+    zjs_obj_add_number(info, record->time_ms, "time");
+    return info;
+}
+#endif
+
+void zjs_watchdog_leave()
+{
+    if (!depth || --depth) {
+        return;
+    }
+
+    zjs_port_cycles_t cycles = zjs_port_get_cycles() - current_start;
+    uint64_t us = zjs_port_cycles_to_ns(cycles) / 1000;
+    if (!stall_budget_us || us <= stall_budget_us) {
+        return;
+    }
+
+    stall_record_t *record = &stall_history[stall_count++ % STALL_HISTORY];
+    *record = current;
+    record->duration_us = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    DBG_PRINT("stall in callback %d, %lu us\n", record->id,
+              record->duration_us);
+
+#ifdef BUILD_MODULE_EVENTS
+    if (watchdog_obj && zjs_event_has_listeners(watchdog_obj, "stall")) {
+        jerry_value_t info = create_stall_info(record);
+        zjs_trigger_event(watchdog_obj, "stall", &info, 1, NULL, NULL);
+        jerry_release_value(info);
+    }
+#endif
+}
+
+void zjs_watchdog_set_budget(uint32_t ms)
+{
+    stall_budget_us = ms * 1000;
+}
+
+void zjs_watchdog_dump()
+{
+    uint32_t first = 0;
+    if (stall_count > STALL_HISTORY) {
+        first = stall_count - STALL_HISTORY;
+    }
+
+    ZJS_PRINT("%u callbacks ran over the %u ms budget%s\n", stall_count,
+              stall_budget_us / 1000, stall_count ? ", most recent:" : "");
+    for (uint32_t i = first; i < stall_count; i++) {
+        print_record(&stall_history[i % STALL_HISTORY]);
+    }
+}
+
+#ifdef ZJS_LINUX_BUILD
+static uint32_t hang_limit_ms = 0;
+static pthread_t monitor_thread;
+
+static void *monitor_loop(void *arg)
+{
+    uint32_t reported_seq = 0;
+    uint32_t poll_us = hang_limit_ms * 1000 / 4;
+    if (!poll_us) {
+        poll_us = 250;
+    }
+
+    while (1) {
+        usleep(poll_us);
+
+        // the main thread is the only writer and it is stuck in JS while a
+        //   hang is reported, so reading its state here is safe enough
+        uint32_t seq = dispatch_seq;
+        if (!depth || seq == reported_seq) {
+            continue;
+        }
+        uint32_t elapsed = watchdog_uptime_ms() - current.time_ms;
+        if (elapsed < hang_limit_ms || seq != dispatch_seq) {
+            continue;
+        }
+
+        reported_seq = seq;
+        ZJS_PRINT("\nwatchdog: event loop blocked for %u ms\n", elapsed);
+        ZJS_PRINT("  in callback %d (%s%s%s)\n", current.id, current.kind,
+                  current.name[0] ? " " : "", current.name);
+        zjs_watchdog_dump();
+        fflush(stdout);
+    }
+    return NULL;
+}
+
+int zjs_watchdog_start_monitor(uint32_t hang_ms)
+{
+    hang_limit_ms = hang_ms;
+    int ret = pthread_create(&monitor_thread, NULL, monitor_loop, NULL);
+    if (ret) {
+        ERR_PRINT("could not start watchdog monitor thread (%d)\n", ret);
+        return ret;
+    }
+    pthread_detach(monitor_thread);
+    return 0;
+}
+#endif
+
+#ifdef BUILD_MODULE_EVENTS
+static jerry_value_t watchdog_set_budget(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    // args: budget in milliseconds
+    ZJS_VALIDATE_ARGS(Z_NUMBER);
+
+    double ms = jerry_get_number_value(argv[0]);
+    if (ms < 0) {
+        return zjs_error("watchdog.setBudget: budget must not be negative");
+    }
+    zjs_watchdog_set_budget((uint32_t)ms);
+    return ZJS_UNDEFINED;
+}
+
+static jerry_value_t watchdog_get_stalls(const jerry_value_t function_obj,
+                                         const jerry_value_t this,
+                                         const jerry_value_t argv[],
+                                         const jerry_length_t argc)
+{
+    uint32_t first = 0;
+    if (stall_count > STALL_HISTORY) {
+        first = stall_count - STALL_HISTORY;
+    }
+
+    jerry_value_t array = jerry_create_array(stall_count - first);
+    for (uint32_t i = first; i < stall_count; i++) {
+        jerry_value_t info =
+            create_stall_info(&stall_history[i % STALL_HISTORY]);
+        jerry_set_property_by_index(array, i - first, info);
+        jerry_release_value(info);
+    }
+    return array;
+}
+
+static jerry_value_t watchdog_dump(const jerry_value_t function_obj,
+                                   const jerry_value_t this,
+                                   const jerry_value_t argv[],
+                                   const jerry_length_t argc)
+{
+    zjs_watchdog_dump();
+    return ZJS_UNDEFINED;
+}
+#endif
+
+jerry_value_t zjs_watchdog_init()
+{
+#ifdef BUILD_MODULE_EVENTS
+    zjs_native_func_t array[] = {
+        { watchdog_set_budget, "setBudget" },
+        { watchdog_get_stalls, "getStalls" },
+        { watchdog_dump, "dump" },
+        { NULL, NULL }
+    };
+    watchdog_obj = jerry_create_object();
+    zjs_obj_add_functions(watchdog_obj, array);
+    zjs_make_event(watchdog_obj, ZJS_UNDEFINED);
+    return jerry_acquire_value(watchdog_obj);
+#else
+    return zjs_error("watchdog module requires events");
+#endif
+}
+
+void zjs_watchdog_cleanup()
+{
+    if (watchdog_obj) {
+        jerry_release_value(watchdog_obj);
+        watchdog_obj = 0;
+    }
+}
+
+#endif  // ZJS_WATCHDOG
@@ -0,0 +1,56 @@
+// Copyright (c) 2017, Intel Corporation.
+
+#ifndef __zjs_watchdog_h__
+#define __zjs_watchdog_h__
+
+// Event loop stall watchdog, enabled with WATCHDOG=on. Every callback dispatch
+//   is timed and the ones that run over budget are recorded with the callback
+//   ID and the source that registered it.
+
+#include "jerry-api.h"
+#include "zjs_callbacks.h"
+
+// default time a single dispatch may take before it is recorded as a stall
+#ifndef ZJS_STALL_BUDGET_MS
+#define ZJS_STALL_BUDGET_MS     50
+#endif
+
+/**
+ * Mark the start of a callback dispatch. Nested dispatches are counted as
+ *   part of the outermost one.
+ *
+ * @param id    ID of the callback being called
+ * @param kind  Kind of source that registered it, e.g. "timer" or "event"
+ * @param name  Name within that kind, e.g. the event name; may be NULL
+ */
+void zjs_watchdog_enter(zjs_callback_id id, const char *kind,
+                        const char *name);
+
+/** Mark the end of the dispatch started by the last zjs_watchdog_enter. */
+void zjs_watchdog_leave();
+
+/**
+ * Change the stall budget.
+ *
+ * @param ms  Milliseconds a dispatch may take, 0 to stop recording stalls
+ */
+void zjs_watchdog_set_budget(uint32_t ms);
+
+/** Print the most recent stalls, oldest first. */
+void zjs_watchdog_dump();
+
+#ifdef ZJS_LINUX_BUILD
+/**
+ * Start a thread that reports when a single dispatch blocks the event loop
+ *   for longer than hang_ms, printing the dispatch and the stall history.
+ *
+ * @param hang_ms  Milliseconds after which the loop is considered hung
+ * @return 0 on success, nonzero if the thread could not be started
+ */
+int zjs_watchdog_start_monitor(uint32_t hang_ms);
+#endif
+
+jerry_value_t zjs_watchdog_init();
+void zjs_watchdog_cleanup();
+
+#endif  // __zjs_watchdog_h__
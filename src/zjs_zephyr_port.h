@@ -14,6 +14,12 @@
 #define ZJS_TICKS_NONE                  TICKS_NONE
 #define zjs_sleep                       k_sleep
 
+// free running hardware cycle counter, only differences between two readings
+//   are meaningful
+#define zjs_port_cycles_t               uint32_t
+#define zjs_port_get_cycles             k_cycle_get_32
+#define zjs_port_cycles_to_ns(c)        SYS_CLOCK_HW_CYCLES_TO_NS64(c)
+
 #define zjs_port_ring_buf ring_buf
 #define zjs_port_ring_buf_init sys_ring_buf_init
 #define zjs_port_ring_buf_get sys_ring_buf_get
@@ -0,0 +1,37 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Values for scripts/binlogtest, which checks that this script's output from
+// a CONSOLE_BINARY=on jslinux, decoded with --decode-log, matches the output
+// of a plain build. Integers stay within 32 bits, which the plain build
+// prints as integers, and doubles below 1e200, which it prints into a 256
+// byte buffer with %f.
+
+console.log("plain text", "and a second argument");
+
+// varints with LF (10) and CR (13) bytes once zigzag encoded or not
+console.log(5, -7, 10, 13, -10, 1000, 2147483647, -2147483648);
+console.log(0, -1, 127, 128, 16383, 16384);
+
+// floats and doubles, some with LF and CR bytes in their encodings
+console.log(8.625, 3.625, 0.5, -2.25, 0.1, 1e20, -1e-300);
+
+// atoms defined once then reused, including ones 10 and 13 bytes long
+var ten = "0123456789";
+var thirteen = "abcdefghijklm";
+for (var i = 0; i < 3; i++) {
+    console.log("label", ten, thirteen, "label", i);
+}
+
+// strings too long for an atom, and one too long to print
+console.log("a string that is longer than an atom can be");
+var long = "";
+for (var i = 0; i < 1100; i++) {
+    long += "x";
+}
+console.log(long);
+
+// arrays, nested arrays and other values
+console.log([1, -2, 3.5, "x", "label", true, null, undefined]);
+console.log([[1, 2], [3]], [], ["\n", "\r"]);
+console.log(true, false, null, undefined, {}, function () {});
+console.log("line\nbreak", "tab\tand\rreturn");
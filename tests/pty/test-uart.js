@@ -0,0 +1,126 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Testing the UART write queue and read path under jslinux, driven by
+// scripts/uarttest through the pty behind the uart module. Each
+// "uart step <name>" line tells the harness what to do next:
+//   read    - send "0123456789" ten times, in 10 byte chunks
+//   overrun - send 2000 bytes at once, while the main loop is blocked
+//   done    - check that the writes arrived as "a" x 40, "b" x 40, "c" x 40
+//             then "d" x 10
+
+var assert = require("Assert.js");
+var performance = require("performance");
+var board = require("uart");
+
+var HIGH_WATER = 64;
+var RING_SIZE = 256;
+var OVERRUN_SENT = 2000;
+
+function repeat(str, count) {
+    var result = "";
+    for (var i = 0; i < count; i++) {
+        result += str;
+    }
+    return result;
+}
+
+board.init({ port: "tty0", highWaterMark: HIGH_WATER }).then(function (uart) {
+    var step = "write";
+    var order = [];
+    var drains = 0;
+    var received = "";
+    var chunks = 0;
+    var badChunks = 0;
+    var overrunBytes = 0;
+    var overruns = 0;
+    var lost = 0;
+    var total = 0;
+
+    uart.setReadRange(1, 16);
+
+    uart.on("drain", function () {
+        drains++;
+    });
+
+    uart.on("read", function (data) {
+        if (step == "read") {
+            chunks++;
+            if (data.length < 1 || data.length > 16) {
+                badChunks++;
+            }
+            received += data.toString("ascii");
+            if (received.length >= 100) {
+                checkRead();
+            }
+        } else if (step == "overrun") {
+            overrunBytes += data.length;
+        }
+    });
+
+    uart.on("overrun", function (count, sum) {
+        overruns++;
+        lost += count;
+        total = sum;
+    });
+
+    function write(str, index) {
+        uart.write(new Buffer(str)).then(function () {
+            order.push(index);
+        });
+    }
+
+    // test write order, writableNeedDrain and drain
+    assert(uart.writableNeedDrain === false, "write: no drain needed at init");
+    write(repeat("a", 40), 0);
+    assert(!uart.writableNeedDrain, "write: below the high-water mark");
+    write(repeat("b", 40), 1);
+    assert(uart.writableNeedDrain, "write: need drain at the high-water mark");
+    write(repeat("c", 40), 2);
+
+    uart.once("drain", function () {
+        assert(!uart.writableNeedDrain, "write: drain clears writableNeedDrain");
+        assert(order.join() == "0,1,2",
+               "write: promises fulfilled in order before drain");
+
+        // a write below the high-water mark must not fire drain again
+        write(repeat("d", 10), 3);
+        setTimeout(function () {
+            assert(order.join() == "0,1,2,3", "write: small write fulfilled");
+            assert(drains == 1, "write: drain fired once");
+            assert(!uart.writableNeedDrain,
+                   "write: no drain needed after a small write");
+            step = "read";
+            console.log("uart step read");
+        }, 500);
+    });
+
+    function checkRead() {
+        assert(received == repeat("0123456789", 10), "read: bytes in order");
+        assert(chunks > 0 && badChunks == 0, "read: chunks within read range");
+        assert(overruns == 0, "read: no overrun");
+
+        // block the main loop so the receive buffer fills while the harness
+        //   sends more than it holds
+        step = "overrun";
+        console.log("uart step overrun");
+        var end = performance.now() + 1000;
+        while (performance.now() < end);
+
+        setTimeout(checkOverrun, 500);
+    }
+
+    function checkOverrun() {
+        assert(overruns > 0, "overrun: event fired");
+        assert(lost > 0 && lost == total, "overrun: lost matches total");
+        assert(overrunBytes == RING_SIZE,
+               "overrun: receive buffer delivered when full");
+        assert(overrunBytes + lost == OVERRUN_SENT,
+               "overrun: every byte delivered or counted as lost");
+        assert.result();
+        console.log("uart step done");
+    }
+}).catch(function (error) {
+    assert(false, "init: " + error.message);
+    assert.result();
+    console.log("uart step done");
+});
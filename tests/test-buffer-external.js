@@ -0,0 +1,72 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Testing Buffers over native memory, created by the test_buffer module with
+// zjs_buffer_wrap_const and zjs_buffer_wrap_external
+
+var assert = require("Assert.js");
+var test = require("test_buffer");
+
+// test read-only Buffer over a const table of de ad be ef 01 02 03 04
+var rom = test.wrapConst();
+assert(rom.length == 8, "wrapConst: length of the table");
+assert(rom.toString("hex") == "deadbeef01020304",
+       "wrapConst: reads see the table");
+assert(rom.readUInt32BE(0) == 0xdeadbeef, "wrapConst: readUInt32BE");
+assert(rom.readUInt16LE(4) == 0x0201, "wrapConst: readUInt16LE");
+
+var writes = [
+    ["writeUInt8", function () { rom.writeUInt8(0, 0); }],
+    ["writeInt16LE", function () { rom.writeInt16LE(0, 0); }],
+    ["writeUInt32BE", function () { rom.writeUInt32BE(0, 4); }],
+    ["writeFloatLE", function () { rom.writeFloatLE(0, 0); }],
+    ["writeDoubleBE", function () { rom.writeDoubleBE(0, 0); }],
+    ["writeUInt8Array", function () { rom.writeUInt8Array([0, 0], 2); }],
+    ["write", function () { rom.write("abcd"); }],
+    ["fill", function () { rom.fill(0); }],
+    ["copy", function () { new Buffer(8).copy(rom); }],
+    ["slice", function () { rom.slice(2, 6).writeUInt8(0, 0); }]
+];
+for (var i = 0; i < writes.length; i++) {
+    assert.throws(writes[i][1], "wrapConst: " + writes[i][0] + " throws");
+}
+assert(rom.toString("hex") == "deadbeef01020304",
+       "wrapConst: table unchanged after rejected writes");
+
+var copy = new Buffer(8);
+assert(rom.copy(copy) == 8 && copy.equals(rom),
+       "wrapConst: copy out of a read-only Buffer");
+
+// test writable Buffer over external memory with a release hook
+var ext = test.wrapExternal();
+assert(ext.toString("hex") == "0001020304050607",
+       "wrapExternal: reads see the external bytes");
+
+var slice = ext.slice(2, 6);
+ext.writeUInt8(0xff, 3);
+assert(slice.readUInt8(1) == 0xff, "wrapExternal: slice shares the memory");
+slice.fill(0xaa);
+assert(ext.toString("hex") == "0001aaaaaaaa0607",
+       "wrapExternal: writes through a slice");
+
+// the hook must wait for the slice, then run exactly once
+var releases = test.releases();
+ext = null;
+test.gc();
+assert(test.releases() == releases,
+       "wrapExternal: slice keeps the memory alive");
+assert(slice.readUInt32BE(0) == 0xaaaaaaaa,
+       "wrapExternal: slice readable after its parent is collected");
+
+slice = null;
+test.gc();
+assert(test.releases() == releases + 1,
+       "wrapExternal: release hook runs after the last view is collected");
+test.gc();
+assert(test.releases() == releases + 1, "wrapExternal: release hook runs once");
+
+rom = null;
+test.gc();
+assert(test.releases() == releases + 1,
+       "wrapConst: no release hook for a const table");
+
+assert.result();
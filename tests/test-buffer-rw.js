@@ -101,4 +101,72 @@ assert(buf.readUInt8(4) == 0xce && buf.readUInt8(5) == 0xfa &&
        buf.readUInt8(6) == 0xad && buf.readUInt8(7) == 0xbe,
        "writeUInt32LE: write long, offset 4");
 
+// test signed reads / writes
+buf.writeUInt32BE(0xfffe8000, 0);
+assert(buf.readInt8(0) == -1, "readInt8: negative byte");
+assert(buf.readInt16BE(0) == -2, "readInt16BE: negative short");
+assert(buf.readInt16LE(2) == 0x80, "readInt16LE: positive short");
+assert(buf.readInt16BE(2) == -32768, "readInt16BE: most negative short");
+assert(buf.readInt32BE(0) == -98304, "readInt32BE: negative long");
+buf.writeInt8(-128, 0);
+assert(buf.readUInt8(0) == 0x80, "writeInt8: negative byte");
+buf.writeInt16LE(-2, 0);
+assert(buf.readUInt16LE(0) == 0xfffe, "writeInt16LE: negative short");
+buf.writeInt32LE(-123456789, 4);
+assert(buf.readInt32LE(4) == -123456789, "writeInt32LE: round trip");
+assert(buf.readUInt32LE(4) == 4171510507, "writeInt32LE: two's complement");
+buf.writeUInt32BE(0xffffffff, 0);
+assert(buf.readUInt32BE(0) == 0xffffffff, "writeUInt32BE: all bits set");
+
+// test float / double
+buf.writeFloatBE(1.5, 0);
+assert(buf.readUInt32BE(0) == 0x3fc00000, "writeFloatBE: bit pattern");
+assert(buf.readFloatBE(0) == 1.5, "readFloatBE: round trip");
+buf.writeFloatLE(-0.25, 4);
+assert(buf.readFloatLE(4) == -0.25, "readFloatLE: round trip");
+assert(buf.readUInt8(7) == 0xbe, "writeFloatLE: sign byte last");
+buf.writeDoubleLE(Math.PI, 0);
+assert(buf.readDoubleLE(0) == Math.PI, "readDoubleLE: round trip");
+buf.writeDoubleBE(-1e300, 0);
+assert(buf.readDoubleBE(0) == -1e300, "readDoubleBE: round trip");
+assert(buf.readUInt8(0) == 0xfe, "writeDoubleBE: sign byte first");
+assert.throws(function () {
+    buf.readDoubleLE(1);
+}, "readDoubleLE: out of bounds");
+assert.throws(function () {
+    buf.writeFloatBE(1, 5);
+}, "writeFloatBE: out of bounds");
+
+// test bulk array reads / writes
+var samples = [-1, 2, -32768, 32767];
+assert(buf.writeInt16Array(samples, 0, 'BE') == 8,
+       "writeInt16Array: returns offset past last element");
+assert(buf.readInt16BE(4) == -32768, "writeInt16Array: big endian");
+var read = buf.readInt16Array(0, 4, 'BE');
+assert(read.length == 4, "readInt16Array: count");
+for (var i = 0; i < samples.length; i++) {
+    assert(read[i] == samples[i], "readInt16Array: element " + i);
+}
+buf.writeInt16Array([0x1234], 0);
+assert(buf.readUInt8(0) == 0x34, "writeInt16Array: little endian default");
+assert(buf.readUInt16Array(0, 1, 'LE')[0] == 0x1234,
+       "readUInt16Array: little endian");
+assert(buf.readUInt8Array(2, 2).length == 2, "readUInt8Array: count");
+buf.writeFloatArray([0.5, -2], 0, 'LE');
+var floats = buf.readFloatArray(0, 2, 'LE');
+assert(floats[0] == 0.5 && floats[1] == -2, "readFloatArray: round trip");
+buf.writeDoubleArray([6.25], 0, 'BE');
+assert(buf.readDoubleArray(0, 1, 'BE')[0] == 6.25,
+       "readDoubleArray: round trip");
+assert(buf.readInt32Array(0, 0).length == 0, "readInt32Array: zero count");
+assert.throws(function () {
+    buf.readInt16Array(2, 4);
+}, "readInt16Array: out of bounds");
+assert.throws(function () {
+    buf.writeUInt32Array([1, 2, 3], 0);
+}, "writeUInt32Array: out of bounds");
+assert.throws(function () {
+    buf.readInt16Array(0, 1, 'XE');
+}, "readInt16Array: invalid endian");
+
 assert.result();
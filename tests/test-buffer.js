@@ -81,8 +81,131 @@ assert(buff.toString('hex') === expected,
 
 assert.throws(function () {
     // unsupported encoding
-    buff.toString("utf8");
-}, "Error thrown when 'hex' is not given to toString()");
+    buff.toString("ucs2");
+}, "Error thrown when an unsupported encoding is given to toString()");
+
+// encodings
+var text = new Buffer("any carnal pleas");
+assert(text.toString('base64') === "YW55IGNhcm5hbCBwbGVhcw==",
+       "toString('base64'): padded");
+assert(new Buffer("YW55IGNhcm5hbCBwbGVhcw==", 'base64').toString('ascii') ===
+       "any carnal pleas", "Buffer(base64): decodes");
+assert(new Buffer("YW55", 'base64').length === 3, "Buffer(base64): length");
+assert(new Buffer("00ff7F", 'hex').toString('hex') === "00ff7f",
+       "Buffer(hex): round trip");
+assert(new Buffer([]).toString('hex') === "", "toString('hex'): empty");
+assert.throws(function () {
+    new Buffer("abc", 'hex');
+}, "Buffer(hex): odd length");
+assert.throws(function () {
+    new Buffer("Y!==", 'base64');
+}, "Buffer(base64): invalid char");
+assert.throws(function () {
+    new Buffer("abc", 'ucs2');
+}, "Buffer: unsupported encoding");
+
+var utf8 = new Buffer([0x68, 0xc3, 0xa9]);
+assert(utf8.toString('utf8') === "h\u00e9", "toString('utf8'): two byte char");
+assert(new Buffer("h\u00e9").equals(utf8), "Buffer(string): utf8 by default");
+assert(new Buffer([0x61, 0xff, 0x62]).toString('utf8') === "a\ufffdb",
+       "toString('utf8'): invalid byte replaced");
+assert(new Buffer([0xf0, 0x9f, 0x98, 0x80]).toString('utf8') ===
+       "\ud83d\ude00", "toString('utf8'): astral char");
+assert(new Buffer([0x61, 0xe9]).toString('ascii') === "ai",
+       "toString('ascii'): high bit dropped");
+
+var written = new Buffer(8);
+written.fill(0);
+assert(written.write("hi") === 2, "write: defaults to string length");
+assert(written.write("cafe", 2, 2, 'hex') === 2, "write: hex");
+assert(written.readUInt16BE(2) === 0xcafe, "write: hex bytes");
+assert(written.write("AQID", 4, 3, 'base64') === 3, "write: base64");
+assert(written.readUInt8(6) === 3, "write: base64 bytes");
+assert(written.write("AQID", 4, 1, 'base64') === 1, "write: partial base64");
+
+// slices share memory with the original buffer
+buff = new Buffer(8);
+for (var i = 0; i < 8; i++) {
+    buff.writeUInt8(i, i);
+}
+var slice = buff.slice(2, 6);
+assert(slice.length === 4, "slice: length of view");
+assert(slice.readUInt8(0) === 2, "slice: view starts at offset");
+assert(slice.toString('hex') === "02030405", "slice: toString of view");
+slice.writeUInt8(0xff, 1);
+assert(buff.readUInt8(3) === 0xff, "slice: write visible in original");
+buff.writeUInt8(0xee, 5);
+assert(slice.readUInt8(3) === 0xee, "slice: write visible in view");
+assert.throws(function () {
+    slice.readUInt8(4);
+}, "slice: read beyond view throws");
+assert.throws(function () {
+    slice.readUInt32BE(1);
+}, "slice: multi-byte read beyond view throws");
+
+assert(buff.slice(-2).toString('hex') === buff.slice(6, 8).toString('hex'),
+       "slice: negative start counts from end");
+assert(buff.slice(2, -5).length === 1, "slice: negative end counts from end");
+assert(buff.slice(5, 2).length === 0, "slice: end before start is empty");
+assert(buff.slice(0, 100).length === 8, "slice: end clamped to length");
+assert(buff.slice().length === 8, "slice: no args views whole buffer");
+assert(slice.slice(1, 2).readUInt8(0) === 0xff, "slice: slice of a slice");
+assert(buff.subarray(1, 3).length === 2, "subarray: alias of slice");
+
+// concat
+var a = new Buffer([1, 2, 3]);
+var b = new Buffer([4, 5]);
+var joined = Buffer.concat([a, b]);
+assert(joined.toString('hex') === "0102030405", "concat: joins buffers");
+assert(Buffer.concat([a, b], 4).toString('hex') === "01020304",
+       "concat: truncated to total length");
+assert(Buffer.concat([b], 4).toString('hex') === "04050000",
+       "concat: zero filled to total length");
+assert(Buffer.concat([]).length === 0, "concat: empty list");
+assert.throws(function () {
+    Buffer.concat([a, "b"]);
+}, "concat: non-Buffer in list");
+
+// copy
+var target = new Buffer([0, 0, 0, 0]);
+assert(a.copy(target, 1) === 3, "copy: returns bytes copied");
+assert(target.toString('hex') === "00010203", "copy: at target offset");
+assert(joined.copy(target, 0, 3) === 2, "copy: from source offset");
+assert(target.toString('hex') === "04050203", "copy: source range");
+assert(joined.copy(target, 2, 0, 10) === 2, "copy: clamped to target");
+joined.copy(joined, 1, 0, 3);
+assert(joined.toString('hex') === "0101020305", "copy: overlapping");
+
+// fill
+var filled = new Buffer(7);
+assert(filled.fill(0xab) === filled, "fill: returns this");
+assert(filled.toString('hex') === "ababababababab", "fill: byte value");
+filled.fill("xyz", 1, 6);
+assert(filled.toString('hex') === "ab78797a7879ab", "fill: string range");
+filled.fill(new Buffer([1, 2]));
+assert(filled.toString('hex') === "01020102010201", "fill: buffer pattern");
+
+// equals / compare
+assert(a.equals(new Buffer([1, 2, 3])), "equals: same contents");
+assert(!a.equals(b), "equals: different contents");
+assert(!a.equals(a.slice(0, 2)), "equals: prefix");
+assert(a.compare(new Buffer([1, 2, 3])) === 0, "compare: equal");
+assert(a.compare(b) === -1, "compare: before");
+assert(b.compare(a) === 1, "compare: after");
+assert(a.slice(0, 2).compare(a) === -1, "compare: shorter prefix first");
+assert(new Buffer([0xff]).compare(new Buffer([1])) === 1,
+       "compare: unsigned bytes");
+
+// indexOf
+var hay = new Buffer("hello, world, hello");
+assert(hay.indexOf("hello") === 0, "indexOf: string at start");
+assert(hay.indexOf("hello", 1) === 14, "indexOf: from offset");
+assert(hay.indexOf("world") === 7, "indexOf: string in middle");
+assert(hay.indexOf(0x2c) === 5, "indexOf: byte value");
+assert(hay.indexOf(new Buffer(", h")) === 12, "indexOf: buffer");
+assert(hay.indexOf("o", -3) === 18, "indexOf: negative offset");
+assert(hay.indexOf("hello!") === -1, "indexOf: not found");
+assert(hay.slice(7).indexOf("hello") === 7, "indexOf: within a slice");
 
 var buff = new Buffer(4);
 var writeValue = -0.232;
@@ -106,6 +106,23 @@ setTimeout(function() {
         console.timeEnd(Timer22);
         console.log("expected result: 1020ms\n");
 
+        console.log("timer: log a running timer");
+        console.time("Timer23");
+        console.timeLog("Timer23", "step", 1);
+        console.timeEnd("Timer23");
+        console.log("expected result: two lines near 0ms, " +
+                    "the first ending in 'step 1'\n");
+
+        console.log("timer: aggregate a timer over a loop");
+        console.timeAggregate("Timer24");
+        for (var k = 0; k < 100; k++) {
+            console.time("Timer24");
+            console.timeEnd("Timer24");
+        }
+        console.timeReport("Timer24");
+        console.timeAggregate("Timer24", false);
+        console.log("expected result: 100 calls and no other output\n");
+
         console.log("Testing completed");
     }, 1000);
 }, 3000);
@@ -88,7 +88,9 @@ assert(listenersName.length === 10,
 // test events name
 var eventsName;
 eventsName = eventEmitter.eventNames();
-assert((eventsName.length - 9) === 3, "event: get all events name");
+assert(eventsName.length === 3 && eventsName[0] === "event_noArg" &&
+       eventsName[1] === "event_moreArg" && eventsName[2] === "event_listener",
+       "event: get all events name");
 
 // test remove all listeners
 var oldAllListenersNum, newAllListenersNum;
@@ -97,6 +99,41 @@ eventEmitter.removeAllListeners("event_listener");
 newAllListenersNum = eventEmitter.listenerCount("event_listener");
 assert(oldAllListenersNum !== 0 && newAllListenersNum === 0,
        "event: remove all listeners on event");
+eventsName = eventEmitter.eventNames();
+assert(eventsName.length === 2 && eventsName[1] === "event_moreArg",
+       "event: removed event is dropped from event names");
+
+// emit the same event twice before either is serviced
+var twiceCount = 0, twiceTotal = 0;
+eventEmitter.on("event_twice", function(num) {
+    twiceCount++;
+    twiceTotal += num;
+});
+eventEmitter.emit("event_twice", 1);
+eventEmitter.emit("event_twice", 2);
+
+// once, prependListener and off
+var onceCount = 0;
+eventEmitter.once("event_once", function() {
+    onceCount++;
+});
+eventEmitter.emit("event_once");
+eventEmitter.emit("event_once");
+
+var callOrder = "";
+eventEmitter.on("event_order", function() { callOrder += "b"; });
+eventEmitter.prependListener("event_order", function() { callOrder += "a"; });
+eventEmitter.prependOnceListener("event_order", function() {
+    callOrder += "0";
+});
+eventEmitter.emit("event_order");
+eventEmitter.emit("event_order");
+
+function test_listener_off() {}
+eventEmitter.on("event_off", test_listener_off);
+eventEmitter.off("event_off", test_listener_off);
+assert(eventEmitter.listenerCount("event_off") === 0,
+       "event: remove listener with off");
 
 // event response time is about 10 ms
 var OldlistenerNum, NewlistenerNum;
@@ -111,6 +148,14 @@ setTimeout(function() {
     assert(EmiteventFlag === true && typeof EmiteventFlag === "boolean",
            "event: emit with event name");
 
+    assert(twiceCount === 2 && twiceTotal === 3,
+           "event: emit same event back to back");
+
+    assert(onceCount === 1 && eventEmitter.listenerCount("event_once") === 0,
+           "event: once listener called once and removed");
+
+    assert(callOrder === "0abab", "event: prepended listeners called first");
+
     // test remove one listener
     OldlistenerNum = eventEmitter.listenerCount("event_noArg");
     eventEmitter.removeListener("event_noArg", test_listener_noArg);
@@ -1,4 +1,5 @@
 var fs = require('fs');
+var testBuffer = require('test_buffer');
 
 var total = 0;
 var passed = 0;
@@ -210,6 +211,10 @@ fs.readSync(fd2, fd2_buf, 0, 3, 0);
 assert((fd2_buf.toString('ascii') == 'tf2'),
     "read from middle opened file (again): " + fd2_buf.toString('ascii'));
 
+expectThrow("can't read into a read-only buffer", function() {
+    fs.readSync(fd2, testBuffer.wrapConst(), 0, 3, 0);
+});
+
 fs.closeSync(fd2);
 
 fs.unlinkSync('tf1.txt');
@@ -91,6 +91,48 @@ pinA.write(false);
 bValue = pinB.read();
 assert(bValue, "activeLow: true");
 
+// test GPIO openPort, with IO7 and IO8 as bits of GPIO_0
+var maskA = 1 << pins.IO7;
+var maskB = 1 << pins.IO8;
+var portA = gpio.openPort({ pins: maskA });
+var portB = gpio.openPort({ pins: maskB, direction: "in" });
+
+portA.write(maskA, maskA);
+assert(portB.read() == maskB, "gpioport: write and read");
+
+portA.write(maskA, 0);
+assert(portB.read() == 0, "gpioport: write inactive and read");
+assert(portA.read() == 0, "gpioport: read output port");
+
+assert.throws(function () {
+    portA.write(maskB, maskB);
+}, "gpioport: write pins not in port");
+
+assert.throws(function () {
+    portB.write(maskB, maskB);
+}, "gpioport: write input port");
+
+portA.sequence([maskA, maskA, 100, maskA, 0, 0, maskA, maskA, 0]);
+assert(portB.read() == maskB, "gpioport: sequence");
+
+assert.throws(function () {
+    portA.sequence([maskA, 0]);
+}, "gpioport: sequence with partial step");
+
+assert.throws(function () {
+    portA.sequence([maskA, 0, 1000000]);
+}, "gpioport: sequence with long delay");
+
+var portLow = gpio.openPort({ pins: maskB, direction: "in",
+                              activeLow: maskB });
+portA.write(maskA, 0);
+assert(portLow.read() == maskB, "gpioport: activeLow");
+
+portA.close();
+assert.throws(function () {
+    portA.write(maskA, 0);
+}, "gpioport: write closed port");
+
 // test GPIO openAsync
 gpio.openAsync({ pin: pins.IO7 }).then(function (pin2) {
     assert(pin2 != null && typeof pin2 == "object",
@@ -20,6 +20,7 @@ console.log("Grove LCD is required...");
 
 var i2c = require("i2c");
 var assert = require("Assert.js");
+var testBuffer = require("test_buffer");
 
 // I2CBus bus and speed
 var speeds = [10, 100, 400, 1000, 34000];
@@ -76,6 +77,13 @@ var size = 8;
 readValue = i2cDevice.burstRead(GROVE_RGB_BACKLIGHT_ADDR, size, 0x00);
 assert(!!readValue && readValue.length === size, "I2C: burstRead()");
 
+// the register address would be stored in the first byte of the buffer
+var rom = testBuffer.wrapConst();
+assert.throws(function () {
+    i2cDevice.write(GROVE_RGB_BACKLIGHT_ADDR, rom, REGISTER_B);
+}, "I2C: write() with register into a read-only buffer");
+assert(rom.readUInt8(0) === 0xde, "I2C: read-only buffer unchanged");
+
 assert.throws(function () {
     i2c.open({ bus: 1, speed: 100 });
 }, "I2C: open invalid bus");
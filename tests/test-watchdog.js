@@ -0,0 +1,51 @@
+// Copyright (c) 2017, Intel Corporation.
+
+// Requires a build with WATCHDOG=on
+
+var assert = require("Assert.js");
+var watchdog = require("watchdog");
+var performance = require("performance");
+
+function busy(ms) {
+    var start = performance.now();
+    while (performance.now() - start < ms) {}
+}
+
+assert.throws(function() {
+    watchdog.setBudget(-1);
+}, "watchdog: reject negative budget");
+
+watchdog.setBudget(20);
+assert(watchdog.getStalls().length === 0, "watchdog: no stalls at start");
+
+var stalls = 0;
+watchdog.on("stall", function(info) {
+    stalls++;
+    assert(info.source === "timer", "watchdog: stall source is timer");
+    assert(info.name === "timeout", "watchdog: stall name is timeout");
+    assert(info.duration >= 20, "watchdog: stall duration over budget");
+});
+
+setTimeout(function() {
+    // within budget
+    busy(1);
+}, 10);
+
+setTimeout(function() {
+    busy(50);
+}, 50);
+
+setTimeout(function() {
+    assert(stalls === 1, "watchdog: one stall event emitted");
+    var list = watchdog.getStalls();
+    assert(list.length === 1, "watchdog: one stall recorded");
+    assert(list[0].duration >= 20, "watchdog: recorded duration");
+
+    watchdog.setBudget(0);
+    busy(30);
+    setTimeout(function() {
+        assert(watchdog.getStalls().length === 1,
+               "watchdog: budget of 0 disables recording");
+        assert.result();
+    }, 10);
+}, 200);